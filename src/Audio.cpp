@@ -21,6 +21,7 @@ char audioI2SVers[] = "\
 #include "mp3_decoder/mp3_decoder.h"
 #include "opus_decoder/opus_decoder.h"
 #include "psram_unique_ptr.hpp"
+#include "spectrum/spectrum.h"
 #include "vorbis_decoder/vorbis_decoder.h"
 #include "wav_decoder/wav_decoder.h"
 
@@ -33,6 +34,7 @@ constexpr size_t m_frameSizeOPUS = 2048;
 constexpr size_t m_frameSizeVORBIS = UINT16_MAX; // OGG length is normally 4080 bytes, but can be reach 64KB in the metadata block
 constexpr size_t m_outbuffSize = 4608 * 2;
 constexpr size_t m_samplesBuff48KSize = m_outbuffSize * 8; // 131072KB  SRmin: 6KHz -> SRmax: 48K
+constexpr size_t m_limiterBuffSize = 960;                    // frames, 5ms look-ahead at 192KHz
 
 constexpr size_t AUDIO_STACK_SIZE = 3300;
 
@@ -199,7 +201,7 @@ Audio::Audio(uint8_t i2sPort) {
     i2s_new_channel(&m_i2s_chan_cfg, &m_i2s_tx_handle, NULL);
 
     memset(&m_i2s_std_cfg, 0, sizeof(i2s_std_config_t));
-    m_i2s_std_cfg.slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_STEREO); // Set to enable bit shift in Philips mode
+    m_i2s_std_cfg.slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(AUDIO_I2S_DATA_BIT_WIDTH, I2S_SLOT_MODE_STEREO); // Set to enable bit shift in Philips mode
     m_i2s_std_cfg.gpio_cfg.bclk = I2S_GPIO_UNUSED;                                                                // BCLK, Assignment in setPinout()
     m_i2s_std_cfg.gpio_cfg.din = I2S_GPIO_UNUSED;                                                                 // not used
     m_i2s_std_cfg.gpio_cfg.dout = I2S_GPIO_UNUSED;                                                                // DOUT, Assignment in setPinout()
@@ -337,7 +339,17 @@ void Audio::setDefaults() {
     m_playlistFormat = FORMAT_NONE;
     m_dataMode = AUDIO_NONE;
     m_streamTitle.assign("");
+    m_rpGn.reset(); // ReplayGain tags are valid for one stream only
+    m_cLdn.reset();
+    m_lmtr.reset(); // flush the delay line
+    computeLimit();
     m_resumeFilePos = -1;
+    m_seekSample = -1;
+    m_skipSamples = 0;
+    m_mp3Toc.reset();
+    mp3_stopIndexScan();
+    m_mp3Idx.reset();
+    m_m4aIdx.reset();
     m_audioCurrentTime = 0; // Reset playtimer
     m_audioFileDuration = 0;
     m_audioDataStart = 0;
@@ -362,6 +374,7 @@ void Audio::setDefaults() {
     m_lastGranulePosition = 0;
     m_validSamples = 0;
     m_vuLeft = m_vuRight = 0; // #835
+    m_cVUl.reset();
     std::fill(std::begin(m_inputHistory), std::end(m_inputHistory), 0);
     if (m_f_reset_m3u8Codec) { m_m3u8Codec = CODEC_AAC; } // reset to default
     m_f_reset_m3u8Codec = true;
@@ -949,6 +962,7 @@ bool Audio::connecttoFS(fs::FS& fs, const char* path, int32_t fileStartTime) {
     }
     info(*this, evt_info, "Reading file: \"%s\"", c_path.get());
     m_audiofile = fs.open(c_path.get());
+    m_fileSystem = &fs;
     m_dataMode = AUDIO_LOCALFILE;
     m_audioFileSize = m_audiofile.size();
     m_f_running = true;
@@ -1429,8 +1443,8 @@ int Audio::read_WAV_Header(uint8_t* data, size_t len) {
         info(*this, evt_info, "DataBlockSize: %u", dbs);
         info(*this, evt_info, "BitsPerSample: %u", bps);
 
-        if ((bps != 8) && (bps != 16)) {
-            info(*this, evt_info, "BitsPerSample is %u,  must be 8 or 16", bps);
+        if ((bps != 8) && (bps != 16) && (bps != 24)) {
+            info(*this, evt_info, "BitsPerSample is %u,  must be 8, 16 or 24", bps);
             stopSong();
             return -1;
         }
@@ -1482,7 +1496,7 @@ int Audio::read_WAV_Header(uint8_t* data, size_t len) {
         }
 
         m_audioFileDuration = m_audioDataSize / (getSampleRate() * getChannels());
-        if (getBitsPerSample() == 16) m_audioFileDuration /= 2;
+        m_audioFileDuration /= getBitsPerSample() / 8;
         info(*this, evt_info, "Duration (s): %u", m_audioFileDuration);
         info(*this, evt_bitrate, "%i", m_nominal_bitrate);
         info(*this, evt_info, "Bitrate (b/s): %lu", m_nominal_bitrate);
@@ -1579,6 +1593,7 @@ int Audio::read_FLAC_Header(uint8_t* data, size_t len) {
     if (m_controlCounter == FLAC_SINFO) { /* Stream info block */
         size_t l = bigEndian(data, 3);
         vTaskDelay(2);
+        m_rflh.minBlockSize = bigEndian(data + 3, 2);
         m_rflh.maxBlockSize = bigEndian(data + 5, 2);
         info(*this, evt_info, "FLAC maxBlockSize: %u", m_rflh.maxBlockSize);
         vTaskDelay(2);
@@ -1599,14 +1614,14 @@ int Audio::read_FLAC_Header(uint8_t* data, size_t len) {
         m_rflh.sampleRate = nextval >> 4;
         info(*this, evt_info, "FLAC sampleRate (Hz): %lu", (long unsigned int)m_rflh.sampleRate);
         vTaskDelay(2);
-        m_rflh.numChannels = ((nextval & 0x06) >> 1) + 1;
+        m_rflh.numChannels = ((nextval & 0x0E) >> 1) + 1;
         info(*this, evt_info, "FLAC numChannels: %u", m_rflh.numChannels);
         vTaskDelay(2);
         uint8_t bps = (nextval & 0x01) << 4;
         bps += (*(data + 16) >> 4) + 1;
         m_rflh.bitsPerSample = bps;
-        if ((bps != 8) && (bps != 16)) {
-            AUDIO_LOG_ERROR("bits per sample must be 8 or 16, is %i", bps);
+        if ((bps != 8) && (bps != 16) && (bps != 20) && (bps != 24)) { // more than 16: decode32() or truncated to 16 bit
+            AUDIO_LOG_ERROR("bits per sample must be 8, 16, 20 or 24, is %i", bps);
             stopSong();
             return -1;
         }
@@ -1642,8 +1657,36 @@ int Audio::read_FLAC_Header(uint8_t* data, size_t len) {
     // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
     if (m_controlCounter == FLAC_SEEK) { /* SEEKTABLE */
         size_t l = bigEndian(data, 3);
-        m_controlCounter = FLAC_MBH;
-        m_rflh.retvalue = l + 3;
+        m_rflh.seekPoints = l / 18; // seek points: sample number (8), offset (8), frame samples (2)
+        if (l % 18) {
+            AUDIO_LOG_WARN("FLAC SEEKTABLE length %u is not a multiple of 18, skipped", l);
+            m_rflh.seekPoints = 0;
+        }
+        m_rflh.seekIdx = 0;
+        m_rflh.seekStep = m_rflh.seekPoints / 512 + 1; // keep at most 512 points
+        m_rflh.seekTable.clear();
+        m_controlCounter = m_rflh.seekPoints ? FLAC_SEEKPOINTS : FLAC_MBH;
+        m_rflh.retvalue = m_rflh.seekPoints ? 3 : l + 3;
+        m_rflh.headerSize += m_rflh.retvalue;
+        return 0;
+    }
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    if (m_controlCounter == FLAC_SEEKPOINTS) { /* SEEKTABLE points, as many as the buffer holds */
+        uint32_t n = std::min<uint32_t>(m_rflh.seekPoints, len / 18);
+        if (!n) return 0; // wait for more data
+        for (uint32_t i = 0; i < n; i++, m_rflh.seekIdx++) {
+            if (m_rflh.seekIdx % m_rflh.seekStep) continue;
+            uint64_t sample = ((uint64_t)bigEndian(data + i * 18, 4) << 32) | bigEndian(data + 4 + i * 18, 4);
+            uint64_t offset = ((uint64_t)bigEndian(data + 8 + i * 18, 4) << 32) | bigEndian(data + 12 + i * 18, 4);
+            if (sample == UINT64_MAX) continue; // placeholder points are at the end
+            m_rflh.seekTable.push_back({sample, offset});
+        }
+        m_rflh.seekPoints -= n;
+        if (!m_rflh.seekPoints) {
+            if (m_rflh.seekTable.size()) info(*this, evt_info, "FLAC seek points: %u", m_rflh.seekTable.size());
+            m_controlCounter = FLAC_MBH;
+        }
+        m_rflh.retvalue = n * 18;
         m_rflh.headerSize += m_rflh.retvalue;
         return 0;
     }
@@ -1690,6 +1733,13 @@ int Audio::read_FLAC_Header(uint8_t* data, size_t len) {
                     lyricsBuffer.clone_from(commentString);
                 else
                     info(*this, evt_id3data, "%s", commentString.get());
+                if (strncasecmp(commentString.get(), "REPLAYGAIN_", 11) == 0 || strncasecmp(commentString.get(), "R128_", 5) == 0) {
+                    int eq = commentString.index_of("=");
+                    if (eq > 0) {
+                        commentString[eq] = '\0'; // key '\0' value
+                        setReplayGainTag(commentString.get(), commentString.get() + eq + 1);
+                    }
+                }
             }
             data += commentLength;
             idx += commentLength;
@@ -1985,6 +2035,23 @@ int Audio::read_ID3_Header(uint8_t* data, size_t len) {
                 tmp.copy_from(m_ID3Hdr.iBuff.get() + idx);
             } // UTF-8 copy directly because no conversion is necessary
         }
+        if (startsWith(m_ID3Hdr.tag, "TXXX") && tmp.valid()) { // description '\0' value, e.g. REPLAYGAIN_TRACK_GAIN -6.48 dB
+            ps_ptr<char> value;
+            const char*  d = m_ID3Hdr.iBuff.get();
+            size_t       descLen = 0;
+            if (textEncodingByte == 0 || textEncodingByte == 3) descLen = strnlen(d, textDataLength) + 1; // incl. '\0'
+            else {
+                while (descLen + 1 < textDataLength && (d[descLen] || d[descLen + 1])) descLen += 2; // UTF-16, BOM included
+                descLen += 2;                                                                        // '\0\0'
+            }
+            if (descLen < textDataLength) {
+                const uint8_t* v = (const uint8_t*)m_ID3Hdr.iBuff.get() + descLen;
+                if (textEncodingByte == 0) value.copy_from_iso8859_1(v);
+                else if (textEncodingByte == 3) value.copy_from((const char*)v);
+                else value.copy_from_utf16(v, isBigEndian);
+                if (value.valid()) setReplayGainTag(tmp.c_get(), value.c_get());
+            }
+        }
         showID3Tag(m_ID3Hdr.tag, tmp.c_get());
         m_ID3Hdr.remainingHeaderBytes -= fs;
         return fs;
@@ -2213,15 +2280,52 @@ int Audio::read_ID3_Header(uint8_t* data, size_t len) {
             if (mp3_xing > 0) xingPos = mp3_xing;
             if (mp3_info > 0) xingPos = mp3_info;
 
-            if (xingPos > 0 && layerIndex == 1) { // layer III only
-                uint32_t frames = bigEndian(data + xingPos + 8, 4);
+            m_mp3Toc.reset();
+            uint32_t frames = 0;
+            uint32_t bytes = 0;
+            if (xingPos > 0 && layerIndex == 1 && xingPos + 8 + 8 + 100 <= len) { // layer III only
+                uint8_t* x = data + xingPos + 4;
+                uint32_t flags = bigEndian(x, 4); // 1: frames, 2: bytes, 4: TOC, 8: quality
+                x += 4;
+                if (flags & 1) { frames = bigEndian(x, 4); x += 4; }
+                if (flags & 2) { bytes = bigEndian(x, 4); x += 4; }
+                if (!bytes) bytes = m_audioDataSize;
+                if ((flags & 4) && frames) { // 100 entries, entry i: offset at i percent of the time in 1/256 of bytes
+                    for (int i = 0; i < 100; i++) m_mp3Toc.points.emplace_back((uint64_t)frames * i / 100, (uint64_t)bytes * x[i] / 256);
+                }
+            }
+            else if (layerIndex == 1 && 36 + 26 <= len && specialIndexOf(data + 36, "VBRI", 4) == 0) { // Fraunhofer, always 32 bytes behind the header
+                uint8_t* v = data + 36;
+                bytes = bigEndian(v + 10, 4);
+                frames = bigEndian(v + 14, 4);
+                uint16_t entries = bigEndian(v + 18, 2);
+                uint16_t scale = bigEndian(v + 20, 2);
+                uint16_t entrySize = bigEndian(v + 22, 2);
+                uint16_t framesPerEntry = bigEndian(v + 24, 2);
+                if (entrySize >= 1 && entrySize <= 4 && framesPerEntry && 36 + 26 + entries * entrySize <= len) {
+                    uint32_t offset = 0; // entry i: size of the i-th block of framesPerEntry frames
+                    m_mp3Toc.points.emplace_back(0, 0);
+                    for (int i = 0; i < entries; i++) {
+                        offset += bigEndian(v + 26 + i * entrySize, entrySize) * scale;
+                        if ((uint32_t)(i + 1) * framesPerEntry >= frames) break;
+                        m_mp3Toc.points.emplace_back((i + 1) * framesPerEntry, offset);
+                    }
+                }
+            }
+            if (m_mp3Toc.points.size()) {
+                m_mp3Toc.points.emplace_back(frames, bytes);
+                m_mp3Toc.frames = frames;
+                m_mp3Toc.sampleRate = samplerate;
+                m_mp3Toc.samplesPerFrame = spf;
+                AUDIO_LOG_DEBUG("mp3 TOC with %i points", m_mp3Toc.points.size());
+            }
+            if (frames && samplerate && (uint64_t)frames * spf >= (uint32_t)samplerate) {
                 AUDIO_LOG_DEBUG("frames %i", frames);
-                uint32_t bytes = bigEndian(data + xingPos + 12, 4);
                 AUDIO_LOG_DEBUG("bytes %i", bytes);
-                uint32_t duration = frames * spf / samplerate;
+                uint32_t duration = (uint64_t)frames * spf / samplerate;
                 info(*this, evt_info, "Duration (s): %u", duration);
                 m_audioFileDuration = duration;
-                uint32_t bitrate = bytes * 8 / duration;
+                uint32_t bitrate = (uint64_t)bytes * 8 / duration;
                 info(*this, evt_info, "Bitrate (b/s): %u", bitrate);
                 m_nominal_bitrate = bitrate;
                 info(*this, evt_bitrate, "%i", m_nominal_bitrate);
@@ -2236,6 +2340,7 @@ int Audio::read_ID3_Header(uint8_t* data, size_t len) {
             m_ID3Hdr.numID3Header = 0;
             m_ID3Hdr.totalId3Size = 0;
             m_ID3Hdr.iBuff.reset();
+            if (m_codec == CODEC_MP3 && m_dataMode == AUDIO_LOCALFILE && m_f_mp3IndexScan) mp3_startIndexScan();
             return 0;
         }
     }
@@ -2362,6 +2467,7 @@ int Audio::read_M4A_Header(uint8_t* data, size_t len) {
         if (atom_name.equals("trak")) {
             AUDIO_LOG_DEBUG("atom %s @ %i, size: %i, ends @ %i", atom_name.c_get(), m_m4aHdr.headerSize, atom_size.to_uint32(16), m_m4aHdr.headerSize + atom_size.to_uint32(16));
             m_m4aHdr.sizeof_trak = atom_size.to_uint32(16) - 8;
+            m_m4aHdr.soundTrak = false;
             m_m4aHdr.retvalue += 8;
             m_m4aHdr.headerSize += 8;
             m_controlCounter = M4A_TRAK;
@@ -2521,7 +2627,29 @@ int Audio::read_M4A_Header(uint8_t* data, size_t len) {
             return 0;
         }
 
-        if (atom_name.equals("stsz")) {
+        if (atom_name.equals("stts") || atom_name.equals("stsc") || atom_name.equals("stco") || atom_name.equals("co64")) { // sample tables, see m4a_buildIndex()
+            AUDIO_LOG_DEBUG("atom %s @ %i, size: %i, ends @ %i", atom_name.c_get(), m_m4aHdr.headerSize, atom_size.to_uint32(16), m_m4aHdr.headerSize + atom_size.to_uint32(16));
+            if (m_m4aHdr.soundTrak) {
+                uint32_t num_entries = bigEndian(data + 12, 4); // behind version and flags
+                uint32_t table_pos = m_m4aHdr.headerSize + 16;
+                if (atom_name.equals("stts")) {
+                    m_m4aHdr.stts_num_entries = num_entries;
+                    m_m4aHdr.stts_table_pos = table_pos;
+                } else if (atom_name.equals("stsc")) {
+                    m_m4aHdr.stsc_num_entries = num_entries;
+                    m_m4aHdr.stsc_table_pos = table_pos;
+                } else {
+                    m_m4aHdr.stco_num_entries = num_entries;
+                    m_m4aHdr.stco_table_pos = table_pos;
+                    m_m4aHdr.co64 = atom_name.equals("co64");
+                }
+            }
+            m_m4aHdr.retvalue += atom_size.to_uint32(16);
+            m_m4aHdr.headerSize += atom_size.to_uint32(16);
+            return 0;
+        }
+
+        if (atom_name.equals("stsz") && m_m4aHdr.soundTrak) {
             AUDIO_LOG_DEBUG("atom %s @ %i, size: %i, ends @ %i", atom_name.c_get(), m_m4aHdr.headerSize, atom_size.to_uint32(16), m_m4aHdr.headerSize + atom_size.to_uint32(16));
             uint8_t header_size = 8;
             m_m4aHdr.sizeof_stsz = atom_size.to_uint32(16) - 8 - header_size;
@@ -2551,6 +2679,8 @@ int Audio::read_M4A_Header(uint8_t* data, size_t len) {
         if (atom_name.equals("mp4a")) {
             AUDIO_LOG_DEBUG("atom %s @ %i, size: %i, ends @ %i", atom_name.c_get(), m_m4aHdr.headerSize, atom_size.to_uint32(16), m_m4aHdr.headerSize + atom_size.to_uint32(16));
             m_m4aHdr.sizeof_mp4a = atom_size.to_uint32(16) - 8;
+            m_m4aHdr.soundTrak = true;
+            m_m4aHdr.sound_timescale = m_m4aHdr.timescale; // mdhd comes before minf
             m_m4aHdr.retvalue += 8;
             m_m4aHdr.headerSize += 8;
             m_controlCounter = M4A_MP4A;
@@ -2856,8 +2986,7 @@ int Audio::read_M4A_Header(uint8_t* data, size_t len) {
         (void)version;
         uint32_t flags = bigEndian(data + 1, 3);
         (void)flags;
-        uint32_t sample_size = bigEndian(data + 4, 4);
-        (void)sample_size;
+        m_m4aHdr.stsz_sample_size = bigEndian(data + 4, 4);
         m_m4aHdr.stsz_num_entries = bigEndian(data + 8, 4);
         m_m4aHdr.stsz_table_pos = m_m4aHdr.headerSize + 12;
         m_m4aHdr.retvalue += m_m4aHdr.sizeof_stsz + 8;
@@ -2900,6 +3029,7 @@ int Audio::read_M4A_Header(uint8_t* data, size_t len) {
         }
         m_stsz_numEntries = m_m4aHdr.stsz_num_entries;
         m_stsz_position = m_m4aHdr.stsz_table_pos;
+        if (m_dataMode == AUDIO_LOCALFILE) m4a_buildIndex(); // web files: on the first seek
         info(*this, evt_info, "Audio-Data-Start: %u", m_audioDataStart);
         info(*this, evt_info, "Audio-Length: %i", m_audioDataSize);
         if (m_audioFileDuration) {
@@ -2974,6 +3104,7 @@ uint32_t Audio::stopSong() {
         if (maxWait > 100) break;
     } // in case of error wait max 100ms
     uint32_t currTime = getAudioCurrentTime();
+    mp3_stopIndexScan();
     if (m_f_running) {
         m_f_running = false;
         if (m_client->connected()) {
@@ -3006,8 +3137,8 @@ bool Audio::pauseResume() {
         m_f_running = !m_f_running;
         retVal = true;
         if (!m_f_running) {
-            memset(m_outBuff.get(), 0, m_outbuffSize * sizeof(int16_t));               // Clear OutputBuffer
-            memset(m_samplesBuff48K.get(), 0, m_samplesBuff48KSize * sizeof(int16_t)); // Clear SamplesBuffer
+            memset(m_outBuff.get(), 0, m_outbuffSize * sizeof(audio_pcm_t));               // Clear OutputBuffer
+            memset(m_samplesBuff48K.get(), 0, m_samplesBuff48KSize * sizeof(audio_pcm_t)); // Clear SamplesBuffer
             m_validSamples = 0;
         }
     }
@@ -3015,7 +3146,7 @@ bool Audio::pauseResume() {
     return retVal;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-size_t Audio::resampleTo48kStereo(const int16_t* input, size_t inputSamples) {
+size_t Audio::resampleTo48kStereo(const audio_pcm_t* input, size_t inputSamples) {
 
     float ratio = static_cast<float>(m_sampleRate) / 48000.0f;
     float cursor = m_resampleCursor;
@@ -3024,38 +3155,40 @@ size_t Audio::resampleTo48kStereo(const int16_t* input, size_t inputSamples) {
     size_t extendedSamples = inputSamples + 3;
 
     // Temporärer Buffer: History + aktueller Input
-    std::vector<int16_t> extendedInput(extendedSamples * 2);
+    std::vector<audio_pcm_t> extendedInput(extendedSamples * 2);
 
     // Historie an den Anfang kopieren (6 Werte = 3 Stereo-Samples)
-    memcpy(&extendedInput[0], m_inputHistory, 6 * sizeof(int16_t));
+    memcpy(&extendedInput[0], m_inputHistory, 6 * sizeof(audio_pcm_t));
 
     // Aktuelles Input danach einfügen
-    memcpy(&extendedInput[6], input, inputSamples * 2 * sizeof(int16_t));
+    memcpy(&extendedInput[6], input, inputSamples * 2 * sizeof(audio_pcm_t));
 
     size_t outputIndex = 0;
 
-    auto clipToInt16 = [this](float value) -> int16_t {
-        if (value > 32767.0f) {
+    auto clipToPCM = [this](float value) -> audio_pcm_t {
+        constexpr float pcmMax = (float)std::numeric_limits<audio_pcm_t>::max(); // 32767 or 2^31 (float rounding)
+        constexpr float pcmMin = (float)std::numeric_limits<audio_pcm_t>::min();
+        if (value >= pcmMax) {
             AUDIO_LOG_INFO("overflow +");
-            return 32767;
+            return std::numeric_limits<audio_pcm_t>::max();
         }
-        if (value < -32768.0f) {
+        if (value < pcmMin) {
             AUDIO_LOG_ERROR("overflow -");
-            return -32768;
+            return std::numeric_limits<audio_pcm_t>::min();
         }
-        return static_cast<int16_t>(value);
+        return static_cast<audio_pcm_t>(value);
     };
 
     for (size_t inIdx = 1; inIdx < extendedSamples - 2; ++inIdx) {
-        int32_t xm1_l = clipToInt16(extendedInput[(inIdx - 1) * 2]);
-        int32_t x0_l = clipToInt16(extendedInput[(inIdx + 0) * 2]);
-        int32_t x1_l = clipToInt16(extendedInput[(inIdx + 1) * 2]);
-        int32_t x2_l = clipToInt16(extendedInput[(inIdx + 2) * 2]);
+        float xm1_l = extendedInput[(inIdx - 1) * 2];
+        float x0_l = extendedInput[(inIdx + 0) * 2];
+        float x1_l = extendedInput[(inIdx + 1) * 2];
+        float x2_l = extendedInput[(inIdx + 2) * 2];
 
-        int32_t xm1_r = clipToInt16(extendedInput[(inIdx - 1) * 2 + 1]);
-        int32_t x0_r = clipToInt16(extendedInput[(inIdx + 0) * 2 + 1]);
-        int32_t x1_r = clipToInt16(extendedInput[(inIdx + 1) * 2 + 1]);
-        int32_t x2_r = clipToInt16(extendedInput[(inIdx + 2) * 2 + 1]);
+        float xm1_r = extendedInput[(inIdx - 1) * 2 + 1];
+        float x0_r = extendedInput[(inIdx + 0) * 2 + 1];
+        float x1_r = extendedInput[(inIdx + 1) * 2 + 1];
+        float x2_r = extendedInput[(inIdx + 2) * 2 + 1];
 
         while (cursor < 1.0f) {
             float t = cursor;
@@ -3065,11 +3198,11 @@ size_t Audio::resampleTo48kStereo(const int16_t* input, size_t inputSamples) {
                 return 0.5f * ((2.0f * x0) + (-xm1 + x1) * t + (2.0f * xm1 - 5.0f * x0 + 4.0f * x1 - x2) * t * t + (-xm1 + 3.0f * x0 - 3.0f * x1 + x2) * t * t * t);
             };
 
-            int16_t outLeft = static_cast<int16_t>(catmullRom(t, xm1_l, x0_l, x1_l, x2_l));
-            int16_t outRight = static_cast<int16_t>(catmullRom(t, xm1_r, x0_r, x1_r, x2_r));
+            float outLeft = catmullRom(t, xm1_l, x0_l, x1_l, x2_l);
+            float outRight = catmullRom(t, xm1_r, x0_r, x1_r, x2_r);
 
-            m_samplesBuff48K[outputIndex * 2] = clipToInt16(outLeft);
-            m_samplesBuff48K[outputIndex * 2 + 1] = clipToInt16(outRight);
+            m_samplesBuff48K[outputIndex * 2] = clipToPCM(outLeft);
+            m_samplesBuff48K[outputIndex * 2 + 1] = clipToPCM(outRight);
 
             ++outputIndex;
             cursor += ratio;
@@ -3097,7 +3230,7 @@ void IRAM_ATTR Audio::playChunk() {
     m_plCh.sample[0] = 0;
     m_plCh.sample[1] = 0;
     m_plCh.s2 = 0;
-    m_plCh.sampleSize = 4; // 2 bytes per sample (int16_t) * 2 channels
+    m_plCh.sampleSize = 2 * sizeof(audio_pcm_t); // bytes per sample (int16_t or int32_t) * 2 channels
     m_plCh.err = ESP_OK;
     m_plCh.i = 0;
 
@@ -3105,7 +3238,7 @@ void IRAM_ATTR Audio::playChunk() {
 
     if (getChannels() == 1) {
         for (int i = m_validSamples - 1; i >= 0; --i) {
-            int16_t sample = m_outBuff[i];
+            audio_pcm_t sample = m_outBuff[i];
             m_outBuff[2 * i] = sample;
             m_outBuff[2 * i + 1] = sample;
         }
@@ -3114,9 +3247,11 @@ void IRAM_ATTR Audio::playChunk() {
 
     m_plCh.validSamples = m_validSamples;
 
+    computeVUlevel(m_outBuff.get(), m_validSamples);
+    if (m_f_autoGain) computeLoudness(m_outBuff.get(), m_validSamples);
+
     while (m_plCh.validSamples) {
         *m_plCh.sample = m_outBuff.get() + m_plCh.i;
-        computeVUlevel(*m_plCh.sample);
 
         //---------- Filterchain, can commented out if not used-------------
         {
@@ -3131,14 +3266,16 @@ void IRAM_ATTR Audio::playChunk() {
         }
         //------------------------------------------------------------------
         if (m_f_forceMono && m_channels == 2) {
-            int32_t xy = ((*m_plCh.sample)[RIGHTCHANNEL] + (*m_plCh.sample)[LEFTCHANNEL]) / 2;
-            (*m_plCh.sample)[RIGHTCHANNEL] = (int16_t)xy;
-            (*m_plCh.sample)[LEFTCHANNEL] = (int16_t)xy;
+            int64_t xy = ((int64_t)(*m_plCh.sample)[RIGHTCHANNEL] + (*m_plCh.sample)[LEFTCHANNEL]) / 2;
+            (*m_plCh.sample)[RIGHTCHANNEL] = (audio_pcm_t)xy;
+            (*m_plCh.sample)[LEFTCHANNEL] = (audio_pcm_t)xy;
         }
-        Gain(*m_plCh.sample);
+        if (m_f_limiter) Limiter(*m_plCh.sample);
+        else Gain(*m_plCh.sample);
         m_plCh.i += 2;
         m_plCh.validSamples -= 1;
     }
+    if (m_spectrum) m_spectrum->feed(m_outBuff.get(), m_validSamples, m_sampleRate);
     //------------------------------------------------------------------------------------------
 #ifdef SR_48K
     if (m_plCh.count == 0) {
@@ -3156,13 +3293,24 @@ void IRAM_ATTR Audio::playChunk() {
 #endif
 
     //------------------------------------------------------------------------------------------------------
+#ifdef AUDIO_PCM_32BIT
+    if (audio_process_i2s32) {
+        // processing the audio samples from external before forwarding them to i2s
+        bool continueI2S = false;
+    #ifdef SR_48K
+        audio_process_i2s32(m_samplesBuff48K.get(), m_validSamples, &continueI2S); // 48KHz stereo 32bps
+    #else
+        audio_process_i2s32(m_outBuff.get(), m_validSamples, &continueI2S); // stereo 32bps
+    #endif
+#else
     if (audio_process_i2s) {
         // processing the audio samples from external before forwarding them to i2s
         bool continueI2S = false;
-#ifdef SR_48K
+    #ifdef SR_48K
         audio_process_i2s(m_samplesBuff48K.get(), m_validSamples, &continueI2S); // 48KHz stereo 16bps
-#else
+    #else
         audio_process_i2s(m_outBuff.get(), m_validSamples, &continueI2S); // 48KHz stereo 16bps
+    #endif
 #endif
         if (!continueI2S) {
             m_validSamples = 0;
@@ -3180,7 +3328,7 @@ i2swrite:
 #endif
     if (!(m_plCh.err == ESP_OK || m_plCh.err == ESP_ERR_TIMEOUT)) goto exit;
     m_validSamples -= m_plCh.i2s_bytesConsumed / m_plCh.sampleSize;
-    m_plCh.count += m_plCh.i2s_bytesConsumed / 2;
+    m_plCh.count += m_plCh.i2s_bytesConsumed / sizeof(audio_pcm_t);
     if (m_validSamples <= 0) {
         m_validSamples = 0;
         m_plCh.count = 0;
@@ -5200,8 +5348,8 @@ void Audio::setDecoderItems() {
         info(*this, evt_info, "Bitrate (b/s): %lu", m_nominal_bitrate);
     }
 
-    if (getBitsPerSample() != 8 && getBitsPerSample() != 16) {
-        AUDIO_LOG_ERROR("Bits per sample must be 8 or 16, found %i", getBitsPerSample());
+    if (getBitsPerSample() != 8 && getBitsPerSample() != 16 && getBitsPerSample() != 20 && getBitsPerSample() != 24) {
+        AUDIO_LOG_ERROR("Bits per sample must be 8, 16, 20 or 24, found %i", getBitsPerSample());
         stopSong();
     }
 
@@ -5236,6 +5384,10 @@ uint32_t Audio::decodeError(int8_t res, uint8_t* data, int32_t bytesDecoded) {
         m_decoder->init();
         return 0;
     }
+    if (m_codec == CODEC_MP3 && bytesDecoded == 0) { // invalid frame header, resync without clear(), the decoder conceals the lost frames
+        int32_t next = m_decoder->findSyncWord(data + 1, m_sbyt.bytesLeft - 1);
+        if (next >= 0) return next + 1;
+    }
     m_f_playing = false;             // seek for new syncword
     if (bytesDecoded == 0) return 1; // skip one byte and seek for the next sync word
     return bytesDecoded;
@@ -5292,12 +5444,20 @@ int Audio::sendBytes(uint8_t* data, size_t len) {
     // m_f_playing is true at this pos
 
     m_sbyt.bytesLeft = len;
+    if (m_codec == CODEC_MP3) mp3_indexFrame(data, len);
 
     if (m_codec == CODEC_NONE && m_playlistFormat == FORMAT_M3U8) return 0; // can happen when the m3u8 playlist is loaded
     if (!m_f_decode_ready) return 0;                                        // find sync first
 
     //-----------------------------------------------------------------
+#ifdef AUDIO_PCM_32BIT
+    if (m_decoder->hasPCM32Output())
+        res = m_decoder->decode32(data, &m_sbyt.bytesLeft, m_outBuff.get());
+    else
+        res = m_decoder->decode(data, &m_sbyt.bytesLeft, m_outBuff16.get()); // widened after setDecoderItems()
+#else
     res = m_decoder->decode(data, &m_sbyt.bytesLeft, m_outBuff.get());
+#endif
     bytesDecoded = len - m_sbyt.bytesLeft;
     //-----------------------------------------------------------------
 
@@ -5320,7 +5480,10 @@ int Audio::sendBytes(uint8_t* data, size_t len) {
 
     switch (m_codec) {
         case CODEC_WAV: m_validSamples = m_decoder->getOutputSamples(); break;
-        case CODEC_MP3: m_validSamples = m_decoder->getOutputSamples(); break;
+        case CODEC_MP3:
+            m_validSamples = m_decoder->getOutputSamples();
+            if (!m_validSamples && m_skipSamples) m_skipSamples -= std::min<uint32_t>(m_skipSamples, m_mp3Idx.samplesPerFrame); // frame went into the bit reservoir
+            break;
         case CODEC_AAC:
             m_validSamples = m_decoder->getOutputSamples() / getChannels();
             if (!m_sbyt.isPS && m_decoder->val1()) { // only change 0 -> 1
@@ -5381,9 +5544,22 @@ int Audio::sendBytes(uint8_t* data, size_t len) {
         m_sbyt.f_setDecodeParamsOnce = false;
         setDecoderItems();
     }
+#ifdef AUDIO_PCM_32BIT
+    if (!m_decoder->hasPCM32Output()) { // int16_t -> left justified int32_t
+        const int16_t* src = m_outBuff16.get();
+        int32_t*       dst = m_outBuff.get();
+        for (int32_t i = 0; i < m_validSamples * getChannels(); i++) { dst[i] = (int32_t)src[i] << 16; }
+    }
+#endif
+    if (m_skipSamples) { // sample accurate seek, the samples before the target are discarded
+        uint32_t n = std::min<uint32_t>(m_skipSamples, m_validSamples);
+        m_skipSamples -= n;
+        m_validSamples -= n;
+        if (m_validSamples) memmove(m_outBuff.get(), m_outBuff.get() + n * getChannels(), m_validSamples * getChannels() * sizeof(audio_pcm_t));
+    }
     samples_out = m_validSamples;
     if (m_channels == 2) samples_out /= 2;
-    if (m_bitsPerSample == 16) samples_out *= 2;
+    if (m_bitsPerSample >= 16) samples_out *= 2;
 exit:
     m_curSample = 0;
     if (m_validSamples) {
@@ -5486,8 +5662,11 @@ bool Audio::setPinout(uint8_t BCLK, uint8_t LRC, uint8_t DOUT, int8_t MCLK) {
 
     m_f_psramFound = psramInit();
 
-    m_outBuff.alloc(m_outbuffSize, "m_outBuff");
-    m_samplesBuff48K.alloc(m_samplesBuff48KSize * sizeof(int16_t));
+    m_outBuff.alloc_array(m_outbuffSize, "m_outBuff");
+    m_samplesBuff48K.alloc_array(m_samplesBuff48KSize, "m_samplesBuff48K");
+#ifdef AUDIO_PCM_32BIT
+    m_outBuff16.alloc_array(m_outbuffSize, "m_outBuff16");
+#endif
 
     esp_err_t result = ESP_OK;
 
@@ -5573,6 +5752,24 @@ bool Audio::setAudioPlayTime(uint16_t sec) {
     if (!m_f_running) return false;                                                    // guard
 
     if (sec > getAudioFileDuration()) sec = getAudioFileDuration();
+    if (m_codec == CODEC_MP3 && (m_mp3Idx.frames || m_mp3Toc.points.size()) && getSampleRate()) { // frame index or VBR TOC, see newInBuffStart()
+        m_seekSample = (uint64_t)sec * getSampleRate();
+        m_resumeFilePos = m_audioDataStart;
+        m_cat.sum_samples = m_seekSample;
+        return true;
+    }
+    if (m_codec == CODEC_M4A && m_stsz_position && (m_m4aIdx.delta.size() || !m_m4aIdx.built) && getSampleRate()) { // sample table index, see newInBuffStart()
+        m_seekSample = (uint64_t)sec * getSampleRate();
+        m_resumeFilePos = m_audioDataStart;
+        m_cat.sum_samples = m_seekSample;
+        return true;
+    }
+    if (m_codec == CODEC_FLAC && m_rflh.totalSamplesInStream && m_rflh.sampleRate) { // the frame is searched in newInBuffStart()
+        m_seekSample = (uint64_t)sec * m_rflh.sampleRate;
+        m_resumeFilePos = m_audioDataStart;
+        m_cat.sum_samples = m_seekSample;
+        return true;
+    }
     uint32_t filepos = m_audioDataStart + (getBitRate() * sec / 8);
     m_resumeFilePos = filepos;
     m_cat.sum_samples = (float)m_cat.tota_samples * ((float)(m_resumeFilePos - m_audioDataStart) / m_audioDataSize);
@@ -5594,6 +5791,9 @@ bool Audio::setTimeOffset(int sec) { // fast forward or rewind the current posit
         stopSong();
         return true;
     }
+    if (m_codec == CODEC_FLAC && m_rflh.totalSamplesInStream) return setAudioPlayTime(newTime); // sample accurate
+    if (m_codec == CODEC_MP3 && (m_mp3Idx.frames || m_mp3Toc.points.size())) return setAudioPlayTime(newTime); // index or TOC
+    if (m_codec == CODEC_M4A && m_stsz_position && (m_m4aIdx.delta.size() || !m_m4aIdx.built)) return setAudioPlayTime(newTime); // sample table index
 
     uint32_t oneSec = getBitRate() / 8; // bytes decoded in one sec
     int32_t  offset = oneSec * sec;     // bytes to be wind/rewind
@@ -5745,7 +5945,7 @@ uint32_t Audio::getSampleRate() {
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 bool Audio::setBitsPerSample(int bits) {
-    if ((bits != 16) && (bits != 8)) return false;
+    if ((bits != 16) && (bits != 8) && (bits != 20) && (bits != 24)) return false; // 20: FLAC
     m_bitsPerSample = bits;
     return true;
 }
@@ -5806,80 +6006,173 @@ void Audio::setI2SCommFMT_LSB(bool commFMT) {
     i2s_channel_disable(m_i2s_tx_handle);
     if (commFMT) {
         info(*this, evt_info, "commFMT = LSBJ (Least Significant Bit Justified)");
-        m_i2s_std_cfg.slot_cfg = I2S_STD_MSB_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_STEREO);
+        m_i2s_std_cfg.slot_cfg = I2S_STD_MSB_SLOT_DEFAULT_CONFIG(AUDIO_I2S_DATA_BIT_WIDTH, I2S_SLOT_MODE_STEREO);
     } else {
         info(*this, evt_info, "commFMT = Philips");
-        m_i2s_std_cfg.slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_STEREO);
+        m_i2s_std_cfg.slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(AUDIO_I2S_DATA_BIT_WIDTH, I2S_SLOT_MODE_STEREO);
     }
     i2s_channel_reconfig_std_slot(m_i2s_tx_handle, &m_i2s_std_cfg.slot_cfg);
     i2s_channel_enable(m_i2s_tx_handle);
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-void Audio::computeVUlevel(int16_t sample[2]) {
+void Audio::computeVUlevel(const audio_pcm_t* samples, int32_t frames) {
+    // block based level meter, once per chunk: sample peak and rms per channel, attack / release and peak hold,
+    // the result is published as a snapshot (seqlock), getLevel() and getVUlevel() never touch the audio task
 
-    auto avg = [&](uint8_t* sampArr) { // lambda, inner function, compute the average of 8 samples
-        uint16_t av = 0;
-        for (int i = 0; i < 8; i++) { av += sampArr[i]; }
-        return av >> 3;
-    };
+    if (frames <= 0 || !m_sampleRate) return;
 
-    auto largest = [&](uint8_t* sampArr) { // lambda, inner function, compute the largest of 8 samples
-        uint16_t maxValue = 0;
-        for (int i = 0; i < 8; i++) {
-            if (maxValue < sampArr[i]) maxValue = sampArr[i];
-        }
-        return maxValue;
-    };
+    constexpr float scale = 1.0f / ((float)std::numeric_limits<audio_pcm_t>::max() + 1);
+    const float     dt = (float)frames / m_sampleRate; // block duration in seconds
+    const float     att = (m_cVUl.attack > 0) ? 1.0f - expf(-dt / m_cVUl.attack) : 1.0f;
+    const float     rel = (m_cVUl.release > 0) ? 1.0f - expf(-dt / m_cVUl.release) : 1.0f;
 
-    if (m_cVUl.cnt0 == 64) {
-        m_cVUl.cnt0 = 0;
-        m_cVUl.cnt1++;
-    }
-    if (m_cVUl.cnt1 == 8) {
-        m_cVUl.cnt1 = 0;
-        m_cVUl.cnt2++;
-    }
-    if (m_cVUl.cnt2 == 8) {
-        m_cVUl.cnt2 = 0;
-        m_cVUl.cnt3++;
-    }
-    if (m_cVUl.cnt3 == 8) {
-        m_cVUl.cnt3 = 0;
-        m_cVUl.cnt4++;
-        m_cVUl.f_vu = true;
+    float peak[2] = {0, 0};
+    float sum[2] = {0, 0};
+    for (int32_t i = 0; i < frames; i++) { // the only per sample work
+        float l = samples[2 * i + LEFTCHANNEL];
+        float r = samples[2 * i + RIGHTCHANNEL];
+        if (fabsf(l) > peak[LEFTCHANNEL]) peak[LEFTCHANNEL] = fabsf(l);
+        if (fabsf(r) > peak[RIGHTCHANNEL]) peak[RIGHTCHANNEL] = fabsf(r);
+        sum[LEFTCHANNEL] += l * l;
+        sum[RIGHTCHANNEL] += r * r;
     }
-    if (m_cVUl.cnt4 == 8) { m_cVUl.cnt4 = 0; }
 
-    if (!m_cVUl.cnt0) { // store every 64th sample in the array[0]
-        m_cVUl.sampleArray[LEFTCHANNEL][0][m_cVUl.cnt1] = abs(sample[LEFTCHANNEL] >> 7);
-        m_cVUl.sampleArray[RIGHTCHANNEL][0][m_cVUl.cnt1] = abs(sample[RIGHTCHANNEL] >> 7);
-    }
-    if (!m_cVUl.cnt1) { // store argest from 64 * 8 samples in the array[1]
-        m_cVUl.sampleArray[LEFTCHANNEL][1][m_cVUl.cnt2] = largest(m_cVUl.sampleArray[LEFTCHANNEL][0]);
-        m_cVUl.sampleArray[RIGHTCHANNEL][1][m_cVUl.cnt2] = largest(m_cVUl.sampleArray[RIGHTCHANNEL][0]);
-    }
-    if (!m_cVUl.cnt2) { // store avg from 64 * 8 * 8 samples in the array[2]
-        m_cVUl.sampleArray[LEFTCHANNEL][2][m_cVUl.cnt3] = largest(m_cVUl.sampleArray[LEFTCHANNEL][1]);
-        m_cVUl.sampleArray[RIGHTCHANNEL][2][m_cVUl.cnt3] = largest(m_cVUl.sampleArray[RIGHTCHANNEL][1]);
-    }
-    if (!m_cVUl.cnt3) { // store avg from 64 * 8 * 8 * 8 samples in the array[3]
-        m_cVUl.sampleArray[LEFTCHANNEL][3][m_cVUl.cnt4] = avg(m_cVUl.sampleArray[LEFTCHANNEL][2]);
-        m_cVUl.sampleArray[RIGHTCHANNEL][3][m_cVUl.cnt4] = avg(m_cVUl.sampleArray[RIGHTCHANNEL][2]);
-    }
-    if (m_cVUl.f_vu) {
-        m_cVUl.f_vu = false;
-        m_vuLeft = avg(m_cVUl.sampleArray[LEFTCHANNEL][3]);
-        m_vuRight = avg(m_cVUl.sampleArray[RIGHTCHANNEL][3]);
+    auto toDB = [](float v) { return (v > 0.00001f) ? 20 * log10f(v) : -100.0f; };
+
+    m_levelSeq.store(m_levelSeq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); // odd: writing
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int ch = 0; ch < 2; ch++) {
+        float p = peak[ch] * scale;
+        float ms = sum[ch] * scale * scale / frames;
+        m_cVUl.peak[ch] += (p - m_cVUl.peak[ch]) * ((p > m_cVUl.peak[ch]) ? att : rel);
+        m_cVUl.ms[ch] += (ms - m_cVUl.ms[ch]) * ((ms > m_cVUl.ms[ch]) ? att : rel);
+        m_cVUl.holdTime[ch] += dt;
+        if (p >= m_cVUl.hold[ch] || m_cVUl.holdTime[ch] > m_cVUl.peakHold) {
+            m_cVUl.hold[ch] = p;
+            m_cVUl.holdTime[ch] = 0;
+        }
+
+        m_level.peak[ch] = m_cVUl.peak[ch];
+        m_level.rms[ch] = sqrtf(m_cVUl.ms[ch]);
+        m_level.peakHold[ch] = m_cVUl.hold[ch];
+        m_level.peak_dB[ch] = toDB(m_level.peak[ch]);
+        m_level.rms_dB[ch] = toDB(m_level.rms[ch]);
+        m_level.peakHold_dB[ch] = toDB(m_level.peakHold[ch]);
     }
-    m_cVUl.cnt1++;
+
+    m_levelSeq.store(m_levelSeq.load(std::memory_order_relaxed) + 1, std::memory_order_release); // even: valid
+
+    m_vuLeft = std::min<int>(m_cVUl.peak[LEFTCHANNEL] * 128, 127); // getVUlevel()
+    m_vuRight = std::min<int>(m_cVUl.peak[RIGHTCHANNEL] * 128, 127);
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 uint16_t Audio::getVUlevel() {
-    // avg 0 ... 127
+    // 0 ... 127 per channel
     if (!m_f_running) return 0;
     return (m_vuLeft << 8) + m_vuRight;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+Audio::level_t Audio::getLevel() {
+    // lock free, the audio task is never blocked, a copy made while it was writing is discarded and repeated
+    level_t  lvl;
+    uint8_t  tries = 0;
+    uint32_t seq1, seq2;
+    if (!m_f_running) return lvl;
+    do {
+        if (++tries > 3) vTaskDelay(1); // the audio task is preempted while writing, let it finish
+        seq1 = m_levelSeq.load(std::memory_order_acquire);
+        if (seq1 & 1) continue;
+        lvl = m_level;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        seq2 = m_levelSeq.load(std::memory_order_relaxed);
+        if (seq1 == seq2) return lvl;
+    } while (true);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::setLevelMeter(uint16_t attack_ms, uint16_t release_ms, uint16_t peakHold_ms) {
+    // attack and release are time constants (63%), 0 is immediate
+    m_cVUl.attack = attack_ms / 1000.0f;
+    m_cVUl.release = release_ms / 1000.0f;
+    m_cVUl.peakHold = peakHold_ms / 1000.0f;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool Audio::setSpectrum(uint16_t fftSize, uint8_t bands, uint8_t maxCpuPercent) {
+    // spectrum analyzer on the output stream, the FFT runs in its own low priority task on the other core
+    // maxCpuPercent limits the FFT task, if it needs more the update rate drops
+    bool ret = true;
+    xSemaphoreTake(mutex_audioTask, 0.3 * configTICK_RATE_HZ);
+    m_spectrum.reset();
+    if (fftSize) {
+        m_spectrum = std::make_unique<Spectrum>();
+        ret = m_spectrum->begin(fftSize, bands, maxCpuPercent, m_audioTaskCoreId ? 0 : 1);
+        if (!ret) m_spectrum.reset();
+    }
+    xSemaphoreGive(mutex_audioTask);
+    return ret;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+uint8_t Audio::getSpectrum(float* bands_dB, uint8_t maxBands) {
+    // dBFS per band, low to high frequency, a full scale sine is 0dB
+    if (!m_spectrum) return 0;
+    return m_spectrum->getBands(bands_dB, maxBands);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+float Audio::getSpectrumCpuLoad() {
+    if (!m_spectrum) return 0;
+    return m_spectrum->getCpuLoad();
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+Audio::decoderStats_t Audio::getDecoderStats() {
+    if (!m_decoder) return {};
+    return m_decoder->getStats();
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::setFlacCrcCheck(bool enable) {
+    // frames with a wrong header CRC-8 or frame CRC-16 are dropped and counted (getDecoderStats), the decoder searches the next
+    // valid frame header. The flag is read when the decoder is initialized, i.e. it applies to the next stream
+    m_f_flacCrcCheck = enable;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::setMp3IndexScan(bool enable) {
+    // a low priority task walks over the frame headers of a local MP3 file (second file handle) while it is played, then
+    // seeking is sample accurate and the duration exact. Without it, only the frames played so far are indexed
+    m_f_mp3IndexScan = enable;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::setMp3LowPower(bool enable) {
+    // talk stations, battery devices: only the lower 16 subbands go through IMDCT and synthesis, the decoder computes every
+    // other output sample and interpolates the rest, samplerate and timing stay the same. Takes effect with the next frame
+    m_f_mp3LowPower = enable;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::setAacSbrLowPower(uint8_t mode) {
+    // SBR with a real valued filterbank and a simplified HF generation and adjustment, less load, some aliasing in the high band.
+    // 2 (auto): switches to low power while the decode time of a frame comes close to its play time (e.g. several decoders or a
+    // busy core) and back when the load has stayed low for a few seconds. Parametric Stereo needs the complex filterbank and stays
+    // in high quality. Builds with SBR_LOW_POWER (real valued qmf_t) always decode in low power
+    m_aacSbrLowPower = std::min<uint8_t>(mode, 2);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::setDownmixDefaults() {
+    // sources with 3 ... 8 channels (5.1 AAC from DVB or HLS, multichannel FLAC and Vorbis) are mixed to stereo by the decoder,
+    // before its PCM output pass. The matrix is copied when the decoder is initialized, changes apply to the next stream
+    m_downmix.setDefaults();
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool Audio::setDownmixCoefficient(uint8_t pos, float left, float right) {
+    // e.g. setDownmixCoefficient(Downmix::DMX_C, 0.5, 0.5) for a quieter centre. If L or R could clip, all gains are scaled down
+    if (!m_downmix.setCoefficient(pos, left, right)) {
+        AUDIO_LOG_WARN("downmix coefficient not valid, pos %i", pos);
+        return false;
+    }
+    return true;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::setDownmixLfe(float gain) {
+    m_downmix.setLfe(gain);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void Audio::setTone(int8_t gainLowPass, int8_t gainBandPass, int8_t gainHighPass) {
     // see https://www.earlevel.com/main/2013/10/13/biquad-calculator-v2/
     // values can be between -40 ... +6 (dB)
@@ -5967,18 +6260,260 @@ void Audio::computeLimit() {    // is calculated when the volume or balance chan
             break;
     }
 
-    m_limit_left = l * v;
-    m_limit_right = r * v;
+    // loudness normalization: Opus output gain + ReplayGain / R128 tag or auto gain
+    float db = m_rpGn.outputGain;
+    float peak = 0;
+    if (m_replayGainMode == 2 && m_rpGn.f_albumGain) {
+        db += m_rpGn.albumGain + m_replayGainPreamp;
+        peak = m_rpGn.albumPeak;
+    } else if (m_replayGainMode && m_rpGn.f_trackGain) {
+        db += m_rpGn.trackGain + m_replayGainPreamp;
+        peak = m_rpGn.trackPeak;
+    } else if (m_replayGainMode && m_rpGn.f_albumGain) {
+        db += m_rpGn.albumGain + m_replayGainPreamp;
+        peak = m_rpGn.albumPeak;
+    } else if (m_f_autoGain) {
+        db += m_rpGn.autoGain;
+    }
+    double g = pow(10, db / 20.0);
+    if (m_f_clipPrevention && peak > 0 && g * peak > 1) g = 1 / peak;
+
+    if (m_f_limiter) { // gain > 1 is fine, Limiter() keeps the peaks below full scale
+        m_limit_left = l * v * g;
+        m_limit_right = r * v * g;
+    } else { // Gain() does not saturate
+        m_limit_left = std::min(l * v * g, 1.0);
+        m_limit_right = std::min(r * v * g, 1.0);
+    }
 
     // AUDIO_LOG_INFO("m_limit_left %f,  m_limit_right %f ",m_limit_left, m_limit_right);
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-void Audio::Gain(int16_t* sample) {
+void Audio::setReplayGain(uint8_t mode, int8_t preamp, bool clipPrevention) {
+    // mode 0: off, 1: track gain, 2: album gain (falls back to the other one if missing)
+    // preamp -15 ... +15 dB, added to the tag value
+    // sources: ID3 TXXX, Vorbis comment (FLAC, Vorbis), Opus R128_TRACK_GAIN / R128_ALBUM_GAIN
+
+    if (mode > 2) mode = 2;
+    if (preamp < -15) preamp = -15;
+    if (preamp > 15) preamp = 15;
+    m_replayGainMode = mode;
+    m_replayGainPreamp = preamp;
+    m_f_clipPrevention = clipPrevention;
+
+    computeLimit();
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::setAutoGain(bool enable, int8_t targetLUFS) {
+    // slow automatic gain for streams without ReplayGain tag, driven by the EBU R128 short term loudness (3s)
+    if (targetLUFS < -30) targetLUFS = -30;
+    if (targetLUFS > -10) targetLUFS = -10;
+    m_f_autoGain = enable;
+    m_targetLUFS = targetLUFS;
+    m_rpGn.autoGain = 0;
+    m_cLdn.reset();
+
+    computeLimit();
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+float Audio::getLoudness() {
+    return m_cLdn.loudness;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::setReplayGainTag(const char* key, const char* value) { // from ID3 TXXX, vorbis comments, OpusHead
+    if (!key || !value) return;
+
+    float val = atof(value); // e.g. "-6.48 dB", "0.988553", "-1536" (R128 Q7.8, relative to -23 LUFS)
+
+    if (!strcasecmp(key, "REPLAYGAIN_TRACK_GAIN")) {
+        m_rpGn.trackGain = val;
+        m_rpGn.f_trackGain = true;
+    } else if (!strcasecmp(key, "REPLAYGAIN_ALBUM_GAIN")) {
+        m_rpGn.albumGain = val;
+        m_rpGn.f_albumGain = true;
+    } else if (!strcasecmp(key, "REPLAYGAIN_TRACK_PEAK")) {
+        m_rpGn.trackPeak = val;
+    } else if (!strcasecmp(key, "REPLAYGAIN_ALBUM_PEAK")) {
+        m_rpGn.albumPeak = val;
+    } else if (!strcasecmp(key, "R128_TRACK_GAIN")) {
+        m_rpGn.trackGain = val / 256 + 5; // -23 LUFS -> -18 LUFS
+        m_rpGn.f_trackGain = true;
+    } else if (!strcasecmp(key, "R128_ALBUM_GAIN")) {
+        m_rpGn.albumGain = val / 256 + 5;
+        m_rpGn.f_albumGain = true;
+    } else if (!strcasecmp(key, "OPUS_OUTPUT_GAIN")) {
+        m_rpGn.outputGain = val / 256;
+        if (!m_rpGn.outputGain) return;
+    } else {
+        return;
+    }
+    info(*this, evt_info, "%s: %s", key, value);
+    computeLimit();
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::computeLoudness(const audio_pcm_t* samples, int32_t frames) {
+    // EBU R128 short term loudness (ITU-R BS.1770 K-weighting, 3s window of 100ms blocks), drives the auto gain
+    // the whole chunk is filtered in one pass, the gain is updated once per block
+
+    constexpr float scale = 1.0f / ((float)std::numeric_limits<audio_pcm_t>::max() + 1);
+    const uint8_t   nch = (getChannels() == 1) ? 1 : 2; // mono is already duplicated, count it once
+
+    if (m_cLdn.sampleRate != m_sampleRate) { // K-weighting for any samplerate, see BS.1770 and libebur128
+        m_cLdn.reset();
+        m_cLdn.sampleRate = m_sampleRate;
+        m_cLdn.blockLen = m_sampleRate / 10;
+
+        float K = tanf((float)PI * 1681.974450955533f / m_sampleRate);
+        float Vh = powf(10, 3.999843853973347f / 20);
+        float Vb = powf(Vh, 0.4996667741545416f);
+        float Q = 0.7071752369554196f;
+        float a0 = 1 + K / Q + K * K;
+        m_cLdn.shelf[0] = (Vh + Vb * K / Q + K * K) / a0;
+        m_cLdn.shelf[1] = 2 * (K * K - Vh) / a0;
+        m_cLdn.shelf[2] = (Vh - Vb * K / Q + K * K) / a0;
+        m_cLdn.shelf[3] = 2 * (K * K - 1) / a0;
+        m_cLdn.shelf[4] = (1 - K / Q + K * K) / a0;
+
+        K = tanf((float)PI * 38.13547087602444f / m_sampleRate);
+        Q = 0.5003270373238773f;
+        a0 = 1 + K / Q + K * K;
+        m_cLdn.hp[0] = 2 * (K * K - 1) / a0;
+        m_cLdn.hp[1] = (1 - K / Q + K * K) / a0;
+    }
+    if (!m_cLdn.blockLen) return;
+
+    const float* sh = m_cLdn.shelf;
+    const float* hp = m_cLdn.hp;
+
+    for (int32_t i = 0; i < frames; i++) {
+        for (uint8_t ch = 0; ch < nch; ch++) { // transposed direct form II
+            float* z = m_cLdn.z[ch];
+            float  x = samples[i * 2 + ch] * scale;
+            float  y = sh[0] * x + z[0];
+            z[0] = sh[1] * x - sh[3] * y + z[1];
+            z[1] = sh[2] * x - sh[4] * y;
+            float w = y + z[2];
+            z[2] = -2 * y - hp[0] * w + z[3];
+            z[3] = y - hp[1] * w;
+            m_cLdn.blockSum += w * w;
+        }
+        if (++m_cLdn.blockCnt < m_cLdn.blockLen) continue;
+
+        // ---- 100ms block complete ----
+        m_cLdn.blocks[m_cLdn.blockIdx] = m_cLdn.blockSum / m_cLdn.blockLen;
+        m_cLdn.blockIdx = (m_cLdn.blockIdx + 1) % 30;
+        if (m_cLdn.blocksFilled < 30) m_cLdn.blocksFilled++;
+        m_cLdn.blockSum = 0;
+        m_cLdn.blockCnt = 0;
+        if (m_cLdn.blocksFilled < 30) continue;
+
+        float ms = 0;
+        for (int j = 0; j < 30; j++) { ms += m_cLdn.blocks[j]; }
+        ms /= 30;
+        m_cLdn.loudness = (ms > 1e-7f) ? -0.691f + 10 * log10f(ms) : -70.0f;
+
+        if (m_cLdn.loudness < -50) continue; // gate, don't boost silence or fade-outs
+        float wanted = m_targetLUFS - m_cLdn.loudness;
+        if (wanted > 12) wanted = 12;
+        if (wanted < -12) wanted = -12;
+        float step = wanted - m_rpGn.autoGain; // slow, max 1dB/s
+        if (step > 0.1f) step = 0.1f;
+        if (step < -0.1f) step = -0.1f;
+        if (fabsf(step) < 0.01f) continue;
+        m_rpGn.autoGain += step;
+        computeLimit();
+    }
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::Gain(audio_pcm_t* sample) {
     /* important: these multiplications must all be signed ints, or the result will be invalid */
     sample[LEFTCHANNEL] *= m_limit_left;
     sample[RIGHTCHANNEL] *= m_limit_right;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::setLimiter(bool enable, uint8_t lookAhead_ms) {
+    // look-ahead peak limiter, replaces Gain() as the last stage of the filter chain
+    // the EQ (setTone) then works at full level: the filters keep their headroom (m_corr) and the limiter restores the level,
+    // also ReplayGain / auto gain can boost beyond 0dB
+    // costs the look-ahead time as additional latency
+
+    if (lookAhead_ms < 1) lookAhead_ms = 1;
+    if (lookAhead_ms > 5) lookAhead_ms = 5;
+
+    xSemaphoreTake(mutex_audioTask, 0.3 * configTICK_RATE_HZ);
+    if (enable && !m_limiterBuff.valid()) {
+        if (!m_limiterBuff.alloc_array(m_limiterBuffSize * 2, "m_limiterBuff")) {
+            AUDIO_LOG_ERROR("out of memory, limiter not enabled");
+            enable = false;
+        }
+    }
+    m_f_limiter = enable;
+    m_limiterLookAhead = lookAhead_ms;
+    m_lmtr.reset(); // new look-ahead on next sample
+    computeLimit();
+    xSemaphoreGive(mutex_audioTask);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::Limiter(audio_pcm_t* sample) {
+    // the samples are delayed by the look-ahead time, the gain ramps down linearly while a peak passes through the delay line,
+    // so it is fully reduced when the peak is played; it is held until all samples that needed it are out, then released (50ms)
+
+    constexpr float pcmMax = (float)std::numeric_limits<audio_pcm_t>::max();
+    constexpr float ceiling = 0.966f; // -0.3dBFS
+
+    if (m_lmtr.sampleRate != m_sampleRate) { // new samplerate or reset
+        m_lmtr.reset();
+        m_lmtr.sampleRate = m_sampleRate;
+        m_lmtr.len = std::clamp<uint32_t>(m_sampleRate * m_limiterLookAhead / 1000, 1, m_limiterBuffSize);
+        m_lmtr.release = 1.0f - expf(-1.0f / (0.05f * m_sampleRate));
+        memset(m_limiterBuff.get(), 0, m_limiterBuffSize * 2 * sizeof(float));
+    }
+
+    const float corr = std::max(m_corr, 1.0f); // EQ headroom back, playChunk takes it only when m_corr > 1
+    float       in[2];
+    in[LEFTCHANNEL] = sample[LEFTCHANNEL] * (float)(m_limit_left * corr);
+    in[RIGHTCHANNEL] = sample[RIGHTCHANNEL] * (float)(m_limit_right * corr);
+
+    float peak = std::max(fabsf(in[LEFTCHANNEL]), fabsf(in[RIGHTCHANNEL])) / pcmMax;
+    float need = (peak > ceiling) ? ceiling / peak : 1.0f;
+
+    if (need < m_lmtr.target) { // new peak, it will be played after 'len' samples
+        float step = (m_lmtr.env - need) / m_lmtr.len;
+        if (step > m_lmtr.step) m_lmtr.step = step;
+        m_lmtr.target = need;
+        m_lmtr.pending = 1.0f;
+        m_lmtr.holdCnt = m_lmtr.len + 1;
+    } else {
+        if (need < m_lmtr.pending) m_lmtr.pending = need;
+        if (m_lmtr.holdCnt) m_lmtr.holdCnt--;
+        if (!m_lmtr.holdCnt) { // peak is out, hold the lowest gain of the samples still in the delay line
+            m_lmtr.target = m_lmtr.pending;
+            m_lmtr.pending = 1.0f;
+            m_lmtr.holdCnt = m_lmtr.len + 1;
+        }
+    }
+
+    if (m_lmtr.env > m_lmtr.target) { // attack
+        m_lmtr.env -= m_lmtr.step;
+        if (m_lmtr.env <= m_lmtr.target || m_lmtr.step == 0) {
+            m_lmtr.env = m_lmtr.target;
+            m_lmtr.step = 0;
+        }
+    } else { // release
+        m_lmtr.env += (m_lmtr.target - m_lmtr.env) * m_lmtr.release;
+    }
+
+    float* d = m_limiterBuff.get() + 2 * m_lmtr.idx;
+    for (int ch = 0; ch < 2; ch++) {
+        float out = d[ch] * m_lmtr.env;
+        d[ch] = in[ch];
+        if (out >= pcmMax) sample[ch] = std::numeric_limits<audio_pcm_t>::max(); // only rounding errors can get here
+        else if (out < -pcmMax) sample[ch] = std::numeric_limits<audio_pcm_t>::min();
+        else sample[ch] = (audio_pcm_t)out;
+    }
+    if (++m_lmtr.idx >= m_lmtr.len) m_lmtr.idx = 0;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 uint32_t Audio::inBufferFilled() {
     // current audio input buffer fillsize in bytes
     return InBuff.bufferFilled();
@@ -6108,7 +6643,7 @@ void Audio::IIR_calculateCoefficients(int8_t G0, int8_t G1, int8_t G2) { // Infi
     //                                                  m_filter[2].b1, m_filter[2].b2);
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-void Audio::IIR_filterChain0(int16_t iir_in[2], bool clear) { // Infinite Impulse Response (IIR) filters
+void Audio::IIR_filterChain0(audio_pcm_t iir_in[2], bool clear) { // Infinite Impulse Response (IIR) filters
 
     uint8_t z1 = 0, z2 = 1;
     enum : uint8_t { in = 0, out = 1 };
@@ -6131,7 +6666,7 @@ void Audio::IIR_filterChain0(int16_t iir_in[2], bool clear) { // Infinite Impuls
     m_filterBuff[0][z1][in][LEFTCHANNEL] = m_ifCh.inSample0[LEFTCHANNEL];
     m_filterBuff[0][z2][out][LEFTCHANNEL] = m_filterBuff[0][z1][out][LEFTCHANNEL];
     m_filterBuff[0][z1][out][LEFTCHANNEL] = m_ifCh.outSample0[LEFTCHANNEL];
-    m_ifCh.iir_out0[LEFTCHANNEL] = (int16_t)m_ifCh.outSample0[LEFTCHANNEL];
+    m_ifCh.iir_out0[LEFTCHANNEL] = (audio_pcm_t)m_ifCh.outSample0[LEFTCHANNEL];
 
     m_ifCh.outSample0[RIGHTCHANNEL] = m_filter[0].a0 * m_ifCh.inSample0[RIGHTCHANNEL] + m_filter[0].a1 * m_filterBuff[0][z1][in][RIGHTCHANNEL] +
                                       m_filter[0].a2 * m_filterBuff[0][z2][in][RIGHTCHANNEL] - m_filter[0].b1 * m_filterBuff[0][z1][out][RIGHTCHANNEL] -
@@ -6141,14 +6676,14 @@ void Audio::IIR_filterChain0(int16_t iir_in[2], bool clear) { // Infinite Impuls
     m_filterBuff[0][z1][in][RIGHTCHANNEL] = m_ifCh.inSample0[RIGHTCHANNEL];
     m_filterBuff[0][z2][out][RIGHTCHANNEL] = m_filterBuff[0][z1][out][RIGHTCHANNEL];
     m_filterBuff[0][z1][out][RIGHTCHANNEL] = m_ifCh.outSample0[RIGHTCHANNEL];
-    m_ifCh.iir_out0[RIGHTCHANNEL] = (int16_t)m_ifCh.outSample0[RIGHTCHANNEL];
+    m_ifCh.iir_out0[RIGHTCHANNEL] = (audio_pcm_t)m_ifCh.outSample0[RIGHTCHANNEL];
 
     iir_in[LEFTCHANNEL] = m_ifCh.iir_out0[LEFTCHANNEL];
     iir_in[RIGHTCHANNEL] = m_ifCh.iir_out0[RIGHTCHANNEL];
     return;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-void Audio::IIR_filterChain1(int16_t iir_in[2], bool clear) { // Infinite Impulse Response (IIR) filters
+void Audio::IIR_filterChain1(audio_pcm_t iir_in[2], bool clear) { // Infinite Impulse Response (IIR) filters
 
     uint8_t z1 = 0, z2 = 1;
     enum : uint8_t { in = 0, out = 1 };
@@ -6171,7 +6706,7 @@ void Audio::IIR_filterChain1(int16_t iir_in[2], bool clear) { // Infinite Impuls
     m_filterBuff[1][z1][in][LEFTCHANNEL] = m_ifCh.inSample1[LEFTCHANNEL];
     m_filterBuff[1][z2][out][LEFTCHANNEL] = m_filterBuff[1][z1][out][LEFTCHANNEL];
     m_filterBuff[1][z1][out][LEFTCHANNEL] = m_ifCh.outSample1[LEFTCHANNEL];
-    m_ifCh.iir_out1[LEFTCHANNEL] = (int16_t)m_ifCh.outSample1[LEFTCHANNEL];
+    m_ifCh.iir_out1[LEFTCHANNEL] = (audio_pcm_t)m_ifCh.outSample1[LEFTCHANNEL];
 
     m_ifCh.outSample1[RIGHTCHANNEL] = m_filter[1].a0 * m_ifCh.inSample1[RIGHTCHANNEL] + m_filter[1].a1 * m_filterBuff[1][z1][in][RIGHTCHANNEL] +
                                       m_filter[1].a2 * m_filterBuff[1][z2][in][RIGHTCHANNEL] - m_filter[1].b1 * m_filterBuff[1][z1][out][RIGHTCHANNEL] -
@@ -6181,14 +6716,14 @@ void Audio::IIR_filterChain1(int16_t iir_in[2], bool clear) { // Infinite Impuls
     m_filterBuff[1][z1][in][RIGHTCHANNEL] = m_ifCh.inSample1[RIGHTCHANNEL];
     m_filterBuff[1][z2][out][RIGHTCHANNEL] = m_filterBuff[1][z1][out][RIGHTCHANNEL];
     m_filterBuff[1][z1][out][RIGHTCHANNEL] = m_ifCh.outSample1[RIGHTCHANNEL];
-    m_ifCh.iir_out1[RIGHTCHANNEL] = (int16_t)m_ifCh.outSample1[RIGHTCHANNEL];
+    m_ifCh.iir_out1[RIGHTCHANNEL] = (audio_pcm_t)m_ifCh.outSample1[RIGHTCHANNEL];
 
     iir_in[LEFTCHANNEL] = m_ifCh.iir_out1[LEFTCHANNEL];
     iir_in[RIGHTCHANNEL] = m_ifCh.iir_out1[RIGHTCHANNEL];
     return;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-void Audio::IIR_filterChain2(int16_t iir_in[2], bool clear) { // Infinite Impulse Response (IIR) filters
+void Audio::IIR_filterChain2(audio_pcm_t iir_in[2], bool clear) { // Infinite Impulse Response (IIR) filters
 
     uint8_t z1 = 0, z2 = 1;
     enum : uint8_t { in = 0, out = 1 };
@@ -6211,7 +6746,7 @@ void Audio::IIR_filterChain2(int16_t iir_in[2], bool clear) { // Infinite Impuls
     m_filterBuff[2][z1][in][LEFTCHANNEL] = m_ifCh.inSample2[LEFTCHANNEL];
     m_filterBuff[2][z2][out][LEFTCHANNEL] = m_filterBuff[2][z1][out][LEFTCHANNEL];
     m_filterBuff[2][z1][out][LEFTCHANNEL] = m_ifCh.outSample2[LEFTCHANNEL];
-    m_ifCh.iir_out2[LEFTCHANNEL] = (int16_t)m_ifCh.outSample2[LEFTCHANNEL];
+    m_ifCh.iir_out2[LEFTCHANNEL] = (audio_pcm_t)m_ifCh.outSample2[LEFTCHANNEL];
 
     m_ifCh.outSample2[RIGHTCHANNEL] = m_filter[2].a0 * m_ifCh.inSample2[RIGHTCHANNEL] + m_filter[2].a1 * m_filterBuff[2][z1][in][RIGHTCHANNEL] +
                                       m_filter[2].a2 * m_filterBuff[2][z2][in][RIGHTCHANNEL] - m_filter[2].b1 * m_filterBuff[2][z1][out][RIGHTCHANNEL] -
@@ -6221,7 +6756,7 @@ void Audio::IIR_filterChain2(int16_t iir_in[2], bool clear) { // Infinite Impuls
     m_filterBuff[2][z1][in][RIGHTCHANNEL] = m_ifCh.inSample2[RIGHTCHANNEL];
     m_filterBuff[2][z2][out][RIGHTCHANNEL] = m_filterBuff[2][z1][out][RIGHTCHANNEL];
     m_filterBuff[2][z1][out][RIGHTCHANNEL] = m_ifCh.outSample2[RIGHTCHANNEL];
-    m_ifCh.iir_out2[RIGHTCHANNEL] = (int16_t)m_ifCh.outSample2[RIGHTCHANNEL];
+    m_ifCh.iir_out2[RIGHTCHANNEL] = (audio_pcm_t)m_ifCh.outSample2[RIGHTCHANNEL];
 
     iir_in[LEFTCHANNEL] = m_ifCh.iir_out2[LEFTCHANNEL];
     iir_in[RIGHTCHANNEL] = m_ifCh.iir_out2[RIGHTCHANNEL];
@@ -6696,8 +7231,44 @@ int32_t Audio::newInBuffStart(int32_t m_resumeFilePos) {
         /* process before */
         if (m_controlCounter == 100) {
             if (m_codec == CODEC_M4A) {
-                m_resumeFilePos += m4a_correctResumeFilePos();
-                if (m_resumeFilePos == -1) goto exit;
+                uint64_t pointSample = 0;
+                int32_t  pos = (m_seekSample >= 0) ? m4a_idxFilePos(m_seekSample, &pointSample) : -1;
+                if (pos >= 0) { // sample table index, sample accurate
+                    m_resumeFilePos = pos;
+                    m_skipSamples = m_seekSample - pointSample;
+                } else {
+                    if (m_seekSample >= 0 && getSampleRate()) m_resumeFilePos = m_audioDataStart + (uint64_t)getBitRate() * m_seekSample / getSampleRate() / 8;
+                    m_skipSamples = 0;
+                    m_resumeFilePos += m4a_correctResumeFilePos();
+                    if (m_resumeFilePos == -1) goto exit;
+                }
+                m_seekSample = -1;
+            }
+            if (m_codec == CODEC_FLAC && m_seekSample >= 0) {
+                uint64_t frameSample = 0;
+                int32_t  pos = flac_seekFrame(m_seekSample, &frameSample);
+                if (pos >= 0) {
+                    m_resumeFilePos = pos;
+                    m_skipSamples = m_seekSample - frameSample;
+                } else { // estimate, byte exact only
+                    m_resumeFilePos = m_audioDataStart + (uint64_t)m_audioDataSize * m_seekSample / m_rflh.totalSamplesInStream;
+                    m_skipSamples = 0;
+                }
+                m_seekSample = -1;
+            }
+            if (m_codec == CODEC_MP3 && m_seekSample >= 0) {
+                uint64_t pointSample = 0;
+                int32_t  pos = mp3_idxFilePos(m_seekSample, &pointSample);
+                if (pos >= 0) { // frame index, sample accurate
+                    m_resumeFilePos = pos;
+                    m_skipSamples = m_seekSample - pointSample;
+                } else {
+                    pos = mp3_tocFilePos(m_seekSample);
+                    if (pos < 0 && getSampleRate()) pos = m_audioDataStart + (uint64_t)getBitRate() * m_seekSample / getSampleRate() / 8;
+                    m_resumeFilePos = pos;
+                    m_skipSamples = 0;
+                }
+                m_seekSample = -1;
             }
         }
 
@@ -6716,12 +7287,13 @@ int32_t Audio::newInBuffStart(int32_t m_resumeFilePos) {
                 if (InBuff.bufferFilled() < 0xFFFF) return -1;
             } // ogg frame <= 64kB
             if (m_codec == CODEC_WAV) {
-                while ((m_resumeFilePos % 4) != 0) {
+                uint8_t blockAlign = (getBitsPerSample() == 24) ? 3 * getChannels() : 4;
+                while (((m_resumeFilePos - m_audioDataStart) % blockAlign) != 0) {
                     m_resumeFilePos++;
                     offset++;
                     if (m_resumeFilePos >= m_audioFileSize) goto exit;
                 }
-            } // must divisible by four
+            } // must divisible by four (24 bit: by the frame size)
             if (m_codec == CODEC_MP3) {
                 offset = mp3_correctResumeFilePos();
                 if (offset == -1) goto exit;
@@ -6797,6 +7369,20 @@ uint32_t Audio::m4a_correctResumeFilePos() {
 
     if (!m_stsz_position) return m_audioDataStart; // guard
 
+    if (!m_m4aIdx.built) m4a_buildIndex();
+    const auto& x = m_m4aIdx;
+    if (x.delta.size()) { // first checkpoint at or behind m_resumeFilePos, binary search over the index
+        uint32_t lo = 0, hi = x.delta.size();
+        while (lo < hi) {
+            uint32_t mid = (lo + hi) / 2;
+            if (x.filePos(mid) < (uint32_t)m_resumeFilePos) lo = mid + 1;
+            else hi = mid;
+        }
+        if (lo == x.delta.size()) return -1; // not found
+        return x.filePos(lo) - m_resumeFilePos;
+    }
+    if (m_m4aHdr.stsz_sample_size) return -1; // no stsz table
+
     typedef union {
         uint8_t  u8[4];
         uint32_t u32;
@@ -6877,52 +7463,357 @@ uint32_t Audio::ogg_correctResumeFilePos() {
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————-
 int32_t Audio::flac_correctResumeFilePos() {
-
-    auto find_sync_word = [&](uint8_t* pos, uint32_t av) -> int {
-        int steps = 0;
-        while (av--) {
-            char c = pos[steps];
-            steps++;
-            if (c == 0xFF) { // First byte of sync word found
-                char nextByte = pos[steps];
-                steps++;
-                if (nextByte == 0xF8) { // Check for the second part of sync word
-                    return steps - 2;   // Sync word found, return the number of steps
-                }
-            }
-        }
-        return -1; // Return -1 if sync word is not found
-    };
+    // the next frame header that passes the CRC-8 check, a 0xFFF8 inside the audio data is not a frame start
 
     uint8_t* readPtr = InBuff.getReadPtr();
     size_t   av = InBuff.getMaxAvailableBytes();
-    int32_t  steps = 0;
 
     if (av < InBuff.getMaxBlockSize()) return -1; // guard
 
-    steps = find_sync_word(readPtr, av);
-    if (steps == -1) return -1;
-    return steps; // Return the number of steps to the sync word
+    for (int32_t i = 0; i + 1 < (int32_t)av; i++) {
+        if (readPtr[i] != 0xFF || (readPtr[i + 1] & 0xFE) != 0xF8) continue;
+        if (FlacDecoder::frameHeaderSample(readPtr + i, av - i, m_rflh.minBlockSize == m_rflh.maxBlockSize ? m_rflh.maxBlockSize : 0, m_rflh.maxBlockSize) >= 0) return i;
+    }
+    return -1; // no frame header found
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————-
+int32_t Audio::flac_seekFrame(uint64_t targetSample, uint64_t* frameSample) {
+    // returns the file position of the last frame starting at or before targetSample, -1 if not found
+    // the SEEKTABLE narrows the range, a bisection on the sample numbers in the frame headers does the rest
+
+    uint32_t lo = m_audioDataStart;
+    uint32_t hi = m_audioDataStart + m_audioDataSize;
+    uint64_t loSample = 0;
+    for (auto& sp : m_rflh.seekTable) {
+        if (sp.first > targetSample) {
+            hi = std::min<uint64_t>(hi, m_audioDataStart + sp.second);
+            break;
+        }
+        lo = m_audioDataStart + sp.second;
+        loSample = sp.first;
+    }
+
+    uint32_t        probeLen = m_rflh.maxFrameSize ? m_rflh.maxFrameSize + 32 : InBuff.getMaxBlockSize(); // contains a frame header in any case
+    ps_ptr<uint8_t> probe;
+    if (!probe.alloc(probeLen, "probe")) return -1;
+
+    auto probeFrame = [&](uint32_t pos, uint32_t* framePos, uint64_t* sample) -> bool { // first valid frame header at or after pos
+        uint32_t len = std::min<uint32_t>(probeLen, m_audioDataStart + m_audioDataSize - pos);
+        if (audioFileSeek(pos, len) != (int32_t)pos) return false;
+        int32_t n = audioFileRead(probe.get(), len);
+        for (int32_t i = 0; i + 1 < n; i++) {
+            if (probe[i] != 0xFF || (probe[i + 1] & 0xFE) != 0xF8) continue;
+            int64_t s = FlacDecoder::frameHeaderSample(probe.get() + i, n - i, m_rflh.minBlockSize == m_rflh.maxBlockSize ? m_rflh.maxBlockSize : 0, m_rflh.maxBlockSize);
+            if (s < 0 || s >= m_rflh.totalSamplesInStream) continue;
+            *framePos = pos + i;
+            *sample = s;
+            return true;
+        }
+        return false;
+    };
+
+    uint32_t fPos = 0;
+    uint64_t fSample = 0;
+    if (lo > m_audioDataStart) { // verify the seek point
+        if (!probeFrame(lo, &fPos, &fSample) || fPos != lo || fSample != loSample) {
+            AUDIO_LOG_WARN("FLAC seek point at %lu is not a frame start", lo);
+            lo = m_audioDataStart;
+            hi = m_audioDataStart + m_audioDataSize;
+            loSample = 0;
+        }
+    }
+    while (hi - lo > 2 * probeLen) { // bisection
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (!probeFrame(mid, &fPos, &fSample) || fPos >= hi) {
+            hi = mid;
+            continue;
+        }
+        if (fSample <= targetSample) {
+            lo = fPos;
+            loSample = fSample;
+        } else {
+            hi = mid;
+        }
+    }
+    AUDIO_LOG_DEBUG("FLAC seek to sample %llu, frame at %lu starts with sample %llu", targetSample, lo, loSample);
+    *frameSample = loSample;
+    return lo;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————-
 int32_t Audio::mp3_correctResumeFilePos() {
+    // offset of the first frame behind the seek position, the scanner is locked on the stream parameters
 
-    int32_t  steps = 0;
-    int32_t  sumSteps = 0;
     uint8_t* pos = InBuff.getReadPtr();
     size_t   av = InBuff.getMaxAvailableBytes();
 
     if (av < InBuff.getMaxBlockSize()) return -1; // guard
 
-    while (true) {
-        steps = m_decoder->findSyncWord(pos, av);
-        if (steps == 0) break;
-        if (steps == -1) return -1;
-        pos += steps;
-        sumSteps += steps;
+    return m_decoder->findSyncWord(pos, av); // -1: not found
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int32_t Audio::mp3_tocFilePos(uint64_t sample) {
+    // sample -> file position from the Xing or VBRI table, linear between two points, -1: no table
+    const auto& p = m_mp3Toc.points;
+    if (p.size() < 2 || !m_mp3Toc.samplesPerFrame) return -1;
+    uint64_t frame = sample / m_mp3Toc.samplesPerFrame;
+    if (frame >= m_mp3Toc.frames) frame = m_mp3Toc.frames;
+
+    auto hi = std::upper_bound(p.begin(), p.end(), frame, [](uint64_t f, const std::pair<uint32_t, uint32_t>& e) { return f < e.first; });
+    if (hi == p.begin()) return m_audioDataStart;
+    auto     lo = hi - 1;
+    uint64_t offset = lo->second;
+    if (hi != p.end() && hi->first > lo->first && hi->second > lo->second) offset += (uint64_t)(hi->second - lo->second) * (frame - lo->first) / (hi->first - lo->first);
+    return m_audioDataStart + offset;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int32_t Audio::mp3_idxFilePos(uint64_t sample, uint64_t* pointSample) {
+    // file position of the index point before sample, -1: not indexed so far. The frames up to sample are decoded and discarded
+    const auto& x = m_mp3Idx;
+    if (!x.frames || !x.samplesPerFrame) return -1;
+    uint64_t frame = sample / x.samplesPerFrame;
+    if (frame >= x.frames) {
+        if (!x.complete) return -1;
+        frame = x.frames - 1;
+    }
+    uint32_t k = std::min<uint32_t>(frame / x.step, x.delta.size());
+    if (k && frame - (uint64_t)k * x.step < 2) k--; // at least two frames ahead, they fill the bit reservoir
+    *pointSample = (uint64_t)k * x.step * x.samplesPerFrame;
+    return m_audioDataStart + x.offset(k);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool Audio::m4a_buildIndex() {
+    // checkpoint every step samples: file position from stsz, stsc and stco/co64, decoding time from stts
+    // the tables are read once in blocks, the index holds ~2 bytes per checkpoint (~0.75 s at 44.1kHz)
+    auto&       x = m_m4aIdx;
+    const auto& h = m_m4aHdr;
+    x.reset();
+    x.built = true;
+    if (!h.stsz_num_entries || !h.stts_num_entries || !h.stsc_num_entries || !h.stco_num_entries || !h.sound_timescale) return false;
+    if (m_dataMode != AUDIO_LOCALFILE && !m_f_acceptRanges) return false;
+
+    uint32_t        filePos = m_audioFilePosition;
+    ps_ptr<uint8_t> buf;
+    if (!buf.alloc(1536, "m4aIdx")) return false;
+
+    auto readTable = [&](uint32_t pos, uint32_t entries, uint8_t entrySize, auto&& fn) -> bool { // fn(entry) for every entry
+        uint32_t len = entries * entrySize;
+        if (audioFileSeek(pos, len) != (int32_t)pos) return false;
+        uint32_t blockEntries = 1536 / entrySize;
+        while (entries) {
+            uint32_t n = std::min(entries, blockEntries);
+            if (audioFileRead(buf.get(), n * entrySize) != (int32_t)(n * entrySize)) return false;
+            for (uint32_t i = 0; i < n; i++) fn(buf.get() + i * entrySize);
+            entries -= n;
+        }
+        return true;
+    };
+
+    std::vector<std::pair<uint32_t, uint32_t>> stsc; // first chunk, samples per chunk
+    std::vector<std::pair<uint32_t, uint32_t>> tmp;  // checkpoint: chunk, offset within the chunk
+    bool ok = readTable(h.stts_table_pos, h.stts_num_entries, 8, [&](const uint8_t* e) { x.stts.push_back({bigEndian(e, 4), bigEndian(e + 4, 4)}); });
+    ok = ok && readTable(h.stsc_table_pos, h.stsc_num_entries, 12, [&](const uint8_t* e) { stsc.push_back({bigEndian(e, 4), bigEndian(e + 4, 4)}); });
+
+    if (ok) { // walk through the samples chunk by chunk
+        uint32_t chunk = 1, left = 0, offset = 0, sample = 0, j = 0;
+        auto     addSample = [&](uint32_t size) {
+            if (!left) { // next chunk
+                while (j + 1 < stsc.size() && stsc[j + 1].first <= chunk) j++;
+                left = std::max<uint32_t>(stsc[j].second, 1);
+            }
+            if (sample % x.step == 0) tmp.push_back({chunk, offset});
+            sample++;
+            offset += size;
+            if (--left == 0) {
+                chunk++;
+                offset = 0;
+            }
+        };
+        tmp.reserve(h.stsz_num_entries / x.step + 1);
+        if (h.stsz_sample_size) {
+            for (uint32_t i = 0; i < h.stsz_num_entries; i++) addSample(h.stsz_sample_size);
+        } else {
+            ok = readTable(h.stsz_table_pos, h.stsz_num_entries, 4, [&](const uint8_t* e) { addSample(bigEndian(e, 4)); });
+        }
     }
-    // AUDIO_LOG_INFO("found sync word at %i  sync1 = 0x%02X, sync2 = 0x%02X", readPtr - pos, *readPtr, *(readPtr + 1));
-    return sumSteps; // return the position of the first byte of the frame
+    if (ok) { // chunk offsets -> file positions
+        uint32_t chunk = 0, t = 0;
+        x.delta.reserve(tmp.size());
+        ok = readTable(h.stco_table_pos, h.stco_num_entries, h.co64 ? 8 : 4, [&](const uint8_t* e) {
+            chunk++;
+            uint32_t chunkPos = h.co64 ? bigEndian(e + 4, 4) : bigEndian(e, 4); // > 4GB is not supported anyway
+            while (t < tmp.size() && tmp[t].first == chunk) x.addPoint(chunkPos + tmp[t++].second);
+        });
+        ok = ok && x.delta.size() == tmp.size();
+    }
+    if (m_dataMode == AUDIO_LOCALFILE) audioFileSeek(filePos); // web: the caller requests a new range anyway
+
+    if (!ok) {
+        AUDIO_LOG_WARN("m4a sample table index could not be built");
+        x.reset();
+        x.built = true;
+        return false;
+    }
+    x.samples = h.stsz_num_entries;
+    x.timescale = h.sound_timescale;
+    AUDIO_LOG_DEBUG("m4a sample table index, %lu samples, %u checkpoints, %u bases", x.samples, x.delta.size(), x.base.size());
+    return true;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int32_t Audio::m4a_idxFilePos(uint64_t sample, uint64_t* pointSample) {
+    // file position of the checkpoint before sample (PCM), -1: no index. The frames up to sample are decoded and discarded
+    if (!m_m4aIdx.built) m4a_buildIndex();
+    const auto& x = m_m4aIdx;
+    uint32_t    rate = getSampleRate();
+    if (x.delta.empty() || !rate) return -1;
+
+    uint64_t t = sample * x.timescale / rate; // media time -> AAC frame
+    uint32_t s = 0;
+    for (auto& r : x.stts) {
+        uint64_t d = (uint64_t)r.first * r.second;
+        if (t < d) {
+            s += t / r.second;
+            break;
+        }
+        t -= d;
+        s += r.first;
+    }
+    if (s >= x.samples) s = x.samples - 1;
+    uint32_t k = std::min<uint32_t>(s / x.step, x.delta.size() - 1);
+    if (k && s == k * x.step) k--; // at least one frame ahead, it overlaps with the old decoder state
+
+    uint64_t pt = 0; // decoding time of the checkpoint
+    uint32_t n = k * x.step;
+    for (auto& r : x.stts) {
+        if (!n) break;
+        uint32_t c = std::min(n, r.first);
+        pt += (uint64_t)c * r.second;
+        n -= c;
+    }
+    *pointSample = pt * rate / x.timescale;
+    return x.filePos(k);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::mp3_indexFrame(const uint8_t* data, size_t len) {
+    // audio task, records the frames while they are played, as long as they follow the indexed ones without a gap
+    if (m_mp3Idx.complete || len < 4) return;
+    if ((m_dataMode != AUDIO_LOCALFILE) && (m_streamType != ST_WEBFILE)) return;
+    int64_t pos = (int64_t)m_audioFilePosition - InBuff.bufferFilled() - m_audioDataStart;
+    if (pos != m_mp3Idx.bytes) return; // after a seek ahead
+
+    uint32_t sampleRate = 0;
+    uint16_t spf = 0;
+    int32_t  n = MP3Decoder::frameLength(data, &sampleRate, &spf);
+    if (n <= 0) return;
+    if (!m_mp3Idx.frames) {
+        m_mp3Idx.sampleRate = sampleRate;
+        m_mp3Idx.samplesPerFrame = spf;
+    }
+    m_mp3Idx.addFrame(n);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::mp3_indexComplete() {
+    // exact duration, from now on the current time follows the decoded samples
+    if (!m_mp3Idx.sampleRate) return;
+    uint64_t samples = (uint64_t)m_mp3Idx.frames * m_mp3Idx.samplesPerFrame;
+    m_audioFileDuration = samples / m_mp3Idx.sampleRate;
+    m_cat.tota_samples = samples;
+    if (m_audioFileDuration) {
+        m_nominal_bitrate = (uint64_t)m_mp3Idx.bytes * 8 / m_audioFileDuration;
+        m_cat.nominalBitRate = m_nominal_bitrate;
+    }
+    AUDIO_LOG_DEBUG("mp3 frame index complete, %lu frames, duration %lu s", m_mp3Idx.frames, m_audioFileDuration);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::mp3_startIndexScan() {
+    mp3_stopIndexScan();
+    if (!m_fileSystem || !m_audiofile) return;
+    m_f_mp3ScanStop = false;
+    m_mp3ScanDone = xSemaphoreCreateBinary();
+    if (!m_mp3ScanDone) return;
+    // priority 1, below the audio task (2)
+    if (xTaskCreatePinnedToCore(&Audio::mp3_scanTaskWrapper, "MP3Index", 4096, this, 1, &m_mp3ScanTask, m_audioTaskCoreId) != pdPASS) {
+        AUDIO_LOG_WARN("mp3 index task could not be created");
+        m_mp3ScanTask = nullptr;
+        vSemaphoreDelete(m_mp3ScanDone);
+        m_mp3ScanDone = nullptr;
+    }
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::mp3_stopIndexScan() {
+    if (!m_mp3ScanTask) return;
+    m_f_mp3ScanStop = true;
+    xSemaphoreTake(m_mp3ScanDone, portMAX_DELAY); // the task finishes the current block, or has ended already
+    vSemaphoreDelete(m_mp3ScanDone);
+    m_mp3ScanDone = nullptr;
+    m_mp3ScanTask = nullptr;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::mp3_scanTaskWrapper(void* param) {
+    Audio* runner = static_cast<Audio*>(param);
+    runner->mp3_scanTask();
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::mp3_scanTask() {
+    // header only walk over the audio data, the index is published when it reaches the end
+    constexpr int32_t  blockSize = 4096;
+    audiolib::mp3Idx_t idx;
+    ps_ptr<uint8_t>    buf;
+    File               file = m_fileSystem->open(m_audiofile.path());
+    const uint32_t     end = m_audioDataSize;
+    uint32_t           blockStart = 0; // offset of buf[0]
+    int32_t            filled = 0;
+
+    if (!file || !buf.alloc(blockSize, "mp3Index")) goto exit;
+
+    while (!m_f_mp3ScanStop) {
+        int32_t i = idx.bytes - blockStart;
+        if (i + 4 > filled) { // next block, from the next frame header on
+            if (idx.bytes + 4 > end || !file.seek(m_audioDataStart + idx.bytes)) {
+                idx.complete = true;
+                break;
+            }
+            blockStart = idx.bytes;
+            filled = file.read(buf.get(), std::min<uint32_t>(blockSize, end - idx.bytes));
+            if (filled < 4) {
+                idx.complete = true;
+                break;
+            }
+            vTaskDelay(1);
+            continue;
+        }
+        uint32_t sampleRate = 0;
+        uint16_t spf = 0;
+        int32_t  n = MP3Decoder::frameLength(buf.get() + i, &sampleRate, &spf);
+        if (n == 0) break; // free format, not indexed
+        if (n < 0) {       // junk between the frames or the tags at the end, resync within this block
+            int32_t j = i + 1;
+            while (j + 4 <= filled && MP3Decoder::frameLength(buf.get() + j, nullptr, nullptr) <= 0) j++;
+            if (j + 4 > filled) { // no further frame
+                if (end - idx.bytes < blockSize) idx.complete = true;
+                break;
+            }
+            idx.bytes += j - i;
+            continue;
+        }
+        if (!idx.frames) {
+            idx.sampleRate = sampleRate;
+            idx.samplesPerFrame = spf;
+        }
+        idx.addFrame(n);
+    }
+
+    if (idx.complete && !m_f_mp3ScanStop && idx.frames) {
+        if (xSemaphoreTake(mutex_audioTask, 0.3 * configTICK_RATE_HZ) == pdTRUE) {
+            m_mp3Idx = std::move(idx);
+            mp3_indexComplete();
+            xSemaphoreGive(mutex_audioTask);
+        }
+    }
+exit:
+    if (file) file.close();
+    buf.reset();
+    xSemaphoreGive(m_mp3ScanDone); // mp3_stopIndexScan() cleans up
+    vTaskDelete(nullptr);
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————-
 uint8_t Audio::determineOggCodec() {
@@ -7077,7 +7968,7 @@ int32_t Audio::min3(int32_t a, int32_t b, int32_t c) {
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 //  some other functions
-uint64_t Audio::bigEndian(uint8_t* base, uint8_t numBytes, uint8_t shiftLeft) {
+uint64_t Audio::bigEndian(const uint8_t* base, uint8_t numBytes, uint8_t shiftLeft) {
     uint64_t result = 0; // Use uint64_t for greater caching
     if (numBytes < 1 || numBytes > 8) return 0;
     for (int i = 0; i < numBytes; i++) {
@@ -7209,6 +8100,14 @@ void Audio::setAudioTaskCore(uint8_t coreID) { // Recommendation:If the ARDUINO
     xSemaphoreGive(mutex_audioTask);
     startAudioTask();
 }
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Audio::setDualCoreDecoding(bool enable) {
+    // stereo FLAC: channel 0 is restored (LPC) on the other core while channel 1 is parsed
+    // stereo MP3: IMDCT and synthesis of channel 1 run on the other core, one join per granule
+    // the worker tasks have the priority of the audio task, so they compete with whatever runs there (Wi-Fi, the loop)
+    if (portNUM_PROCESSORS < 2) enable = false;
+    m_f_dualCoreDecoding = enable;
+}
 
 void Audio::startAudioTask() {
     if (m_f_audioTaskIsRunning) {
@@ -4,10 +4,12 @@
  */
 
 // #define SR_48K
+// #define AUDIO_PCM_32BIT // 32 bit samples from decoder to I2S, FLAC and WAV with up to 24 bits are played without truncation
 
 #pragma once
 #pragma GCC optimize("Ofast")
 #include "audiolib_structs.hpp"
+#include "downmix/downmix.h"
 #include "esp_arduino_version.h"
 #include "psram_unique_ptr.hpp"
 #include <Arduino.h>
@@ -26,6 +28,7 @@
 #include <esp32-hal-log.h>
 #include <functional>
 #include <libb64/cencode.h>
+#include <limits>
 #include <locale>
 #include <memory>
 #include <vector>
@@ -34,9 +37,17 @@
     #define I2S_GPIO_UNUSED -1 // = I2S_PIN_NO_CHANGE in IDF < 5
 #endif
 
-extern __attribute__((weak)) void audio_process_i2s(int16_t* outBuff, int32_t validSamples, bool* continueI2S); // record audiodata or send via BT
+#ifdef AUDIO_PCM_32BIT
+    #define AUDIO_I2S_DATA_BIT_WIDTH I2S_DATA_BIT_WIDTH_32BIT
+#else
+    #define AUDIO_I2S_DATA_BIT_WIDTH I2S_DATA_BIT_WIDTH_16BIT
+#endif
+
+extern __attribute__((weak)) void audio_process_i2s(int16_t* outBuff, int32_t validSamples, bool* continueI2S);   // record audiodata or send via BT
+extern __attribute__((weak)) void audio_process_i2s32(int32_t* outBuff, int32_t validSamples, bool* continueI2S); // same, used if AUDIO_PCM_32BIT is defined
 extern char                       audioI2SVers[];
 class Decoder; // prototype
+class Spectrum;
 
 // Audio event type descriptions
 static constexpr std::array<const char*, 13> eventStr = {"info",    "id3data",  "eof",      "station_name", "icy_description", "streamtitle", "bitrate",
@@ -129,6 +140,21 @@ class Audio {
     } msg_t;
     inline static std::function<void(msg_t i)> audio_info_callback;
     // -------------------------------------------------------------------
+    typedef struct _level { // used in getLevel(), linear 0 ... 1 (full scale) and dBFS, index: LEFTCHANNEL, RIGHTCHANNEL
+        float peak[2] = {0, 0};         // sample peak with attack / release
+        float rms[2] = {0, 0};          // rms with attack / release
+        float peakHold[2] = {0, 0};     // highest peak, held for peakHold_ms
+        float peak_dB[2] = {-100, -100}; // -100 is silence
+        float rms_dB[2] = {-100, -100};
+        float peakHold_dB[2] = {-100, -100};
+    } level_t;
+    typedef struct _decoderStats { // used in getDecoderStats(), counts since the start of the stream
+        uint32_t decodedFrames = 0;
+        uint32_t corruptFrames = 0;   // CRC error or invalid bitstream, the frame is dropped or concealed
+        uint32_t resyncs = 0;         // sync lost, the decoder searched for the next frame
+        uint32_t concealedFrames = 0; // corrupt frames replaced by the faded last good one (MP3)
+    } decoderStats_t;
+    // -------------------------------------------------------------------
 
     bool openai_speech(const String& api_key, const String& model, const String& input, const String& instructions, const String& voice, const String& response_format, const String& speed);
     audiolib::hwoe_t dismantle_host(const char* host);
@@ -159,12 +185,29 @@ class Audio {
     uint32_t         getAudioCurrentTime();
     uint32_t         getAudioFilePosition();
     bool             setAudioFilePosition(uint32_t pos);
-    uint16_t         getVUlevel();
+    uint16_t         getVUlevel();                                                                          // 0 ... 127 per channel, (left << 8) + right
+    level_t          getLevel();                                                                            // peak, rms, dBFS, can be read from any task
+    void             setLevelMeter(uint16_t attack_ms = 10, uint16_t release_ms = 300, uint16_t peakHold_ms = 1500); // ballistics
+    bool             setSpectrum(uint16_t fftSize, uint8_t bands = 16, uint8_t maxCpuPercent = 10);                // 256, 512, 1024 points, 0: off
+    uint8_t          getSpectrum(float* bands_dB, uint8_t maxBands);                                       // log spaced bands, returns the number of bands
+    float            getSpectrumCpuLoad();                                                                 // percent of one core
+    decoderStats_t   getDecoderStats();
+    void             setFlacCrcCheck(bool enable);                                                         // CRC-8/16 per frame, from the next stream on
+    void             setMp3IndexScan(bool enable);                                                         // local MP3 files: frame index ahead of playback, exact seek and duration
+    void             setMp3LowPower(bool enable);                                                          // MP3: synthesis of the lower 16 subbands only, less CPU, bandwidth fs/4
+    void             setAacSbrLowPower(uint8_t mode);                                                      // HE-AAC: real valued SBR, 0: off, 1: on, 2: auto (decode load)
+    void             setDownmixDefaults();                                                                 // multichannel AAC, FLAC, Vorbis -> stereo after ITU-R BS.775
+    bool             setDownmixCoefficient(uint8_t pos, float left, float right);                          // Downmix::DMX_L ... DMX_CB, linear gain in L and R
+    void             setDownmixLfe(float gain);                                                            // LFE in L and R, 0: dropped (default)
     uint32_t         inBufferFilled();            // returns the number of stored bytes in the inputbuffer
     uint32_t         inBufferFree();              // returns the number of free bytes in the inputbuffer
     uint32_t         getInBufferSize();           // returns the size of the inputbuffer in bytes
     bool             setInBufferSize(size_t mbs); // sets the size of the inputbuffer in bytes
     void             setTone(int8_t gainLowPass, int8_t gainBandPass, int8_t gainHighPass);
+    void             setReplayGain(uint8_t mode, int8_t preamp = 0, bool clipPrevention = true); // mode 0: off, 1: track, 2: album
+    void             setAutoGain(bool enable, int8_t targetLUFS = -18); // EBU R128 short term meter, if no ReplayGain tag is found
+    float            getLoudness();                                     // short term loudness in LUFS (auto gain enabled)
+    void             setLimiter(bool enable, uint8_t lookAhead_ms = 2);  // look-ahead peak limiter as final stage, 1 ... 5 ms
     void             setI2SCommFMT_LSB(bool commFMT);
     int              getCodec() { return m_codec; }
     const char*      getCodecname() { return codecname[m_codec]; }
@@ -173,6 +216,8 @@ class Audio {
     // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 
   private:
+    friend class Decoder; // setReplayGainTag(), dualCoreDecoding(), flacCrcCheck(), mp3LowPower(), aacSbrLowPower(), downmix()
+
     // ------- PRIVATE MEMBERS ----------------------------------------
     std::unique_ptr<Decoder> createDecoder(const std::string& type);
     void                     destroy_decoder();
@@ -216,11 +261,14 @@ class Audio {
     bool                     setSampleRate(uint32_t hz);
     bool                     setBitsPerSample(int bits);
     bool                     setChannels(int channels);
-    size_t                   resampleTo48kStereo(const int16_t* input, size_t inputFrames);
+    size_t                   resampleTo48kStereo(const audio_pcm_t* input, size_t inputFrames);
     void                     playChunk();
-    void                     computeVUlevel(int16_t sample[2]);
+    void                     computeVUlevel(const audio_pcm_t* samples, int32_t frames);
     void                     computeLimit();
-    void                     Gain(int16_t* sample);
+    void                     computeLoudness(const audio_pcm_t* samples, int32_t frames);
+    void                     setReplayGainTag(const char* key, const char* value);
+    void                     Gain(audio_pcm_t* sample);
+    void                     Limiter(audio_pcm_t* sample);
     void                     showstreamtitle(char* ml);
     bool                     parseContentType(char* ct);
     bool                     parseHttpResponseHeader();
@@ -229,9 +277,9 @@ class Audio {
     esp_err_t                I2Sstart();
     esp_err_t                I2Sstop();
     void                     zeroI2Sbuff();
-    void                     IIR_filterChain0(int16_t iir_in[2], bool clear = false);
-    void                     IIR_filterChain1(int16_t iir_in[2], bool clear = false);
-    void                     IIR_filterChain2(int16_t iir_in[2], bool clear = false);
+    void                     IIR_filterChain0(audio_pcm_t iir_in[2], bool clear = false);
+    void                     IIR_filterChain1(audio_pcm_t iir_in[2], bool clear = false);
+    void                     IIR_filterChain2(audio_pcm_t iir_in[2], bool clear = false);
     uint32_t                 streamavail() { return m_client ? m_client->available() : 0; }
     void                     IIR_calculateCoefficients(int8_t G1, int8_t G2, int8_t G3);
     bool                     ts_parsePacket(uint8_t* packet, uint8_t* packetStart, uint8_t* packetLength);
@@ -240,6 +288,7 @@ class Audio {
     //+++ create a T A S K  for playAudioData(), output via I2S +++
   public:
     void     setAudioTaskCore(uint8_t coreID);
+    void     setDualCoreDecoding(bool enable); // FLAC, MP3: a worker task on the other core takes over a part of the decoding
     uint32_t getHighWatermark();
 
   private:
@@ -258,7 +307,18 @@ class Audio {
     uint32_t     m4a_correctResumeFilePos();
     uint32_t     ogg_correctResumeFilePos();
     int32_t      flac_correctResumeFilePos();
+    int32_t      flac_seekFrame(uint64_t targetSample, uint64_t* frameSample);
     int32_t      mp3_correctResumeFilePos();
+    int32_t      mp3_tocFilePos(uint64_t sample);
+    int32_t      mp3_idxFilePos(uint64_t sample, uint64_t* pointSample);
+    bool         m4a_buildIndex();
+    int32_t      m4a_idxFilePos(uint64_t sample, uint64_t* pointSample);
+    void         mp3_indexFrame(const uint8_t* data, size_t len);
+    void         mp3_indexComplete();
+    void         mp3_startIndexScan();
+    void         mp3_stopIndexScan();
+    static void  mp3_scanTaskWrapper(void* param);
+    void         mp3_scanTask();
     uint8_t      determineOggCodec();
     void         strlower(char* str);
     void         trim(char* str);
@@ -272,7 +332,7 @@ class Audio {
     int          specialIndexOfLast(uint8_t* base, const char* str, int baselen);
     int          find_utf16_null_terminator(const uint8_t* buf, int start, int max);
     int32_t      min3(int32_t a, int32_t b, int32_t c);
-    uint64_t     bigEndian(uint8_t* base, uint8_t numBytes, uint8_t shiftLeft = 8);
+    uint64_t     bigEndian(const uint8_t* base, uint8_t numBytes, uint8_t shiftLeft = 8);
     bool         b64encode(const char* source, uint16_t sourceLength, char* dest);
     void         vector_clear_and_shrink(std::vector<ps_ptr<char>>& vec);
     void         deque_clear_and_shrink(std::deque<ps_ptr<char>>& deq);
@@ -288,7 +348,7 @@ class Audio {
     const char* plsFmtStr[5] = {"NONE", "M3U", "PLS", "ASX", "M3U8"};                                // playlist format string
     enum : int { AUDIO_NONE, HTTP_RESPONSE_HEADER, HTTP_RANGE_HEADER, AUDIO_DATA, AUDIO_LOCALFILE, AUDIO_PLAYLISTINIT, AUDIO_PLAYLISTHEADER, AUDIO_PLAYLISTDATA };
     const char* dataModeStr[8] = {"AUDIO_NONE", "HTTP_RESPONSE_HEADER", "HTTP_RANGE_HEADER", "AUDIO_DATA", "AUDIO_LOCALFILE", "AUDIO_PLAYLISTINIT", "AUDIO_PLAYLISTHEADER", "AUDIO_PLAYLISTDATA"};
-    enum : int { FLAC_BEGIN = 0, FLAC_MAGIC = 1, FLAC_MBH = 2, FLAC_SINFO = 3, FLAC_PADDING = 4, FLAC_APP = 5, FLAC_SEEK = 6, FLAC_VORBIS = 7, FLAC_CUESHEET = 8, FLAC_PICTURE = 9, FLAC_OKAY = 100 };
+    enum : int { FLAC_BEGIN = 0, FLAC_MAGIC = 1, FLAC_MBH = 2, FLAC_SINFO = 3, FLAC_PADDING = 4, FLAC_APP = 5, FLAC_SEEK = 6, FLAC_VORBIS = 7, FLAC_CUESHEET = 8, FLAC_PICTURE = 9, FLAC_SEEKPOINTS = 10, FLAC_OKAY = 100 };
     enum : int {
         M4A_BEGIN = 0,
         M4A_FTYP = 1,
@@ -333,6 +393,7 @@ class Audio {
     } pid_array;
 
     File                m_audiofile;
+    fs::FS*             m_fileSystem = nullptr; // of m_audiofile, the index scan opens the file a second time
     NetworkClient       client;
     NetworkClientSecure clientsecure;
     NetworkClient*      m_client = nullptr;
@@ -340,6 +401,9 @@ class Audio {
     SemaphoreHandle_t mutex_playAudioData;
     SemaphoreHandle_t mutex_audioTask;
     TaskHandle_t      m_audioTaskHandle = nullptr;
+    TaskHandle_t      m_mp3ScanTask = nullptr;
+    SemaphoreHandle_t m_mp3ScanDone = nullptr; // given by the index task when it ends
+    std::atomic<bool> m_f_mp3ScanStop{false};
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
@@ -362,8 +426,13 @@ class Audio {
     static const uint8_t m_tsHeaderSize = 4;
 
     std::unique_ptr<Decoder> m_decoder = {};
-    ps_ptr<int16_t>          m_outBuff;        // Interleaved L/R
-    ps_ptr<int16_t>          m_samplesBuff48K; // Interleaved L/R
+    std::unique_ptr<Spectrum> m_spectrum;      // setSpectrum()
+    ps_ptr<audio_pcm_t>      m_outBuff;        // Interleaved L/R
+    ps_ptr<audio_pcm_t>      m_samplesBuff48K; // Interleaved L/R
+#ifdef AUDIO_PCM_32BIT
+    ps_ptr<int16_t>          m_outBuff16;      // output of the 16 bit decoders, widened into m_outBuff
+#endif
+    ps_ptr<float>            m_limiterBuff;    // Limiter() delay line, interleaved L/R
     ps_ptr<char>             m_ibuff;          // used in log_info()
     ps_ptr<char>             m_lastHost;       // Store the last URL to a webstream
     ps_ptr<char>             m_currentHost;    // can be changed by redirection or playlist
@@ -386,7 +455,7 @@ class Audio {
     int8_t         m_balance = 0;           // -16 (mute left) ... +16 (mute right)
     uint16_t       m_vol = 21;              // volume
     uint16_t       m_vol_steps = 21;        // default
-    int16_t        m_inputHistory[6] = {0}; // used in resampleTo48kStereo()
+    audio_pcm_t    m_inputHistory[6] = {0}; // used in resampleTo48kStereo()
     uint16_t       m_opus_mode = 0;         // celt_only, silk_only or hybrid
     double         m_limit_left = 0;        // limiter 0 ... 1, left channel
     double         m_limit_right = 0;       // limiter 0 ... 1, right channel
@@ -406,6 +475,12 @@ class Audio {
     uint8_t  m_vuLeft = 0;  // average value of samples, left channel
     uint8_t  m_vuRight = 0; // average value of samples, right channel
     uint8_t  m_audioTaskCoreId = 0;
+    bool     m_f_dualCoreDecoding = false; // setDualCoreDecoding()
+    bool     m_f_flacCrcCheck = true;      // setFlacCrcCheck()
+    bool     m_f_mp3IndexScan = false;     // setMp3IndexScan()
+    bool     m_f_mp3LowPower = false;      // setMp3LowPower()
+    uint8_t  m_aacSbrLowPower = 0;         // setAacSbrLowPower()
+    Downmix  m_downmix;                    // setDownmixCoefficient()
     uint8_t  m_M4A_objectType = 0; // set in read_M4A_Header
     uint8_t  m_M4A_chConfig = 0;   // set in read_M4A_Header
     uint16_t m_M4A_sampleRate = 0; // set in read_M4A_Header
@@ -421,6 +496,8 @@ class Audio {
     uint32_t m_bytesNotConsumed = 0;     // pictures or something else that comes with the stream
     uint64_t m_lastGranulePosition = 0;  // necessary to calculate the duration in OPUS and VORBIS
     int32_t  m_resumeFilePos = -1;       // the return value from stopSong(), (-1) is idle
+    int64_t  m_seekSample = -1;          // sample accurate seek pending (FLAC, MP3), target sample
+    uint32_t m_skipSamples = 0;          // samples to discard after a sample accurate seek
     int32_t  m_fileStartTime = -1;       // may be set in connecttoFS()
     uint16_t m_m3u8_targetDuration = 10; //
     uint32_t m_stsz_numEntries = 0;      // num of entries inside stsz atom (uint32_t)
@@ -477,6 +554,13 @@ class Audio {
     int8_t   m_gain0 = 0; // cut or boost filters (EQ)
     int8_t   m_gain1 = 0;
     int8_t   m_gain2 = 0;
+    uint8_t  m_replayGainMode = 0;      // 0: off, 1: track gain, 2: album gain
+    int8_t   m_replayGainPreamp = 0;    // dB, added to the ReplayGain / R128 tag value
+    bool     m_f_clipPrevention = true; // limit the ReplayGain by the peak tag
+    bool     m_f_autoGain = false;      // R128 short term meter drives the gain of untagged streams
+    int8_t   m_targetLUFS = -18;        // auto gain target loudness
+    bool     m_f_limiter = false;       // look-ahead limiter instead of Gain(), allows EQ boost and gain > 1
+    uint8_t  m_limiterLookAhead = 2;    // ms
 
     pid_array m_pidsOfPMT;
     int16_t   m_pidOfAAC;
@@ -493,6 +577,9 @@ class Audio {
     audiolib::prlf_t    m_prlf;
     audiolib::cat_t     m_cat;
     audiolib::cVUl_t    m_cVUl;
+    audiolib::rpGn_t    m_rpGn;
+    audiolib::cLdn_t    m_cLdn;
+    audiolib::lmtr_t    m_lmtr;
     audiolib::ifCh_t    m_ifCh;
     audiolib::tspp_t    m_tspp;
     audiolib::pwst_t    m_pwst;
@@ -504,11 +591,17 @@ class Audio {
     audiolib::pwsts_t   m_pwsst;
     audiolib::rwh_t     m_rwh;
     audiolib::rflh_t    m_rflh;
+    audiolib::mp3Toc_t  m_mp3Toc;
+    audiolib::mp3Idx_t  m_mp3Idx;
+    audiolib::m4aIdx_t  m_m4aIdx;
     audiolib::phreh_t   m_phreh;
     audiolib::phrah_t   m_phrah;
     audiolib::sdet_t    m_sdet;
     audiolib::fnsy_t    m_fnsy;
 
+    level_t               m_level;       // snapshot, written by computeVUlevel() only
+    std::atomic<uint32_t> m_levelSeq{0}; // seqlock, odd while m_level is written
+
     // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
   public:
     // 🎯 overload for char*-Pointer (maybe nullptr)
@@ -665,7 +758,7 @@ class Audio {
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 class Decoder {
   public:
-    virtual ~Decoder() = default;
+    virtual ~Decoder() { workerStop(); }
     virtual bool                  init() = 0;
     virtual void                  clear() = 0;
     virtual void                  reset() = 0;
@@ -679,6 +772,8 @@ class Decoder {
     virtual uint32_t              getAudioFileDuration() = 0;
     virtual uint32_t              getOutputSamples() = 0;
     virtual int32_t               decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf) = 0;
+    virtual bool                  hasPCM32Output() { return false; } // true: decode32() delivers left justified 32 bit samples
+    virtual int32_t               decode32(uint8_t*, int32_t*, int32_t*) { return -100; }
     virtual void                  setRawBlockParams(uint8_t param1, uint32_t param2, uint8_t param3, uint32_t param4, uint32_t param5) = 0;
     virtual const char*           getStreamTitle();
     virtual const char*           whoIsIt();
@@ -687,10 +782,59 @@ class Decoder {
     virtual const char*           arg2() = 0; // decoder specific
     virtual int32_t               val1() = 0; // decoder specific
     virtual int32_t               val2() = 0; // decoder specific
+    virtual Audio::decoderStats_t getStats() { return {}; }
 
   protected:
     Decoder(Audio& audioRef) : audio(audioRef) {}
     Audio& audio; // protected reference, usable by all subclasses
+    void   setReplayGainTag(const char* key, const char* value) { audio.setReplayGainTag(key, value); } // REPLAYGAIN_*, R128_* comments
+    bool   dualCoreDecoding() { return audio.m_f_dualCoreDecoding; }                                      // setDualCoreDecoding()
+    uint8_t workerCore() { return audio.m_audioTaskCoreId ? 0 : 1; }                                      // the core without the audio task
+    bool   flacCrcCheck() { return audio.m_f_flacCrcCheck; }                                              // setFlacCrcCheck()
+    bool   mp3LowPower() { return audio.m_f_mp3LowPower; }                                                // setMp3LowPower()
+    uint8_t aacSbrLowPower() { return audio.m_aacSbrLowPower; }                                           // setAacSbrLowPower()
+    Downmix downmix() { return audio.m_downmix; }                                                         // setDownmixCoefficient(), a copy per stream
+
+    // dual core mode: a task on workerCore() with the priority of the audio task runs the job once per workerRun(),
+    // workerJoin() waits for it. FLAC restores channel 0 while channel 1 is parsed, MP3 synthesizes channel 1 of a granule
+    bool workerStart(const char* name, std::function<void()> job) { // true: the worker is running
+        if (m_workerHandle) return true;
+        m_workerDone = xSemaphoreCreateBinary();
+        if (!m_workerDone) return false;
+        m_workerJob = std::move(job);
+        if (xTaskCreatePinnedToCore(&Decoder::workerTask, name, 2048, this, 2, &m_workerHandle, workerCore()) != pdPASS) {
+            log_e("%s could not be created, single core decoding", name);
+            m_workerHandle = nullptr;
+            vSemaphoreDelete(m_workerDone);
+            m_workerDone = nullptr;
+            return false;
+        }
+        return true;
+    }
+    void workerRun() { xTaskNotifyGive(m_workerHandle); }
+    void workerJoin() { xSemaphoreTake(m_workerDone, portMAX_DELAY); }
+    void workerStop() { // the worker is idle, the decoder joins before decode() returns
+        if (m_workerHandle) {
+            vTaskDelete(m_workerHandle);
+            m_workerHandle = nullptr;
+        }
+        if (m_workerDone) {
+            vSemaphoreDelete(m_workerDone);
+            m_workerDone = nullptr;
+        }
+    }
+
   private:
     Decoder() = delete; // Deactivate default constructor explicitly (optional but good against abuse)
+    TaskHandle_t          m_workerHandle = nullptr;
+    SemaphoreHandle_t     m_workerDone = nullptr;
+    std::function<void()> m_workerJob;
+    static void           workerTask(void* param) {
+        Decoder* d = static_cast<Decoder*>(param);
+        while (true) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            d->m_workerJob();
+            xSemaphoreGive(d->m_workerDone);
+        }
+    }
 };
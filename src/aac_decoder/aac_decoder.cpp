@@ -21,10 +21,14 @@ AACDecoder::AACDecoder(Audio& audioRef) : Decoder(audioRef), audio(audioRef), m_
 bool AACDecoder::init() {
     m_hAac = m_neaacdec->NeAACDecOpen();
     m_conf = m_neaacdec->NeAACDecGetCurrentConfiguration(m_hAac);
+    m_neaacdec->NeAACDecSetDownmix(downmix());
 
     if (m_hAac) m_f_decoderIsInit = true;
     m_f_firstCall = false;
     m_f_setRaWBlockParams = false;
+    m_decodeLoad = 0;
+    m_sbrLowLoadFrames = 0;
+    m_f_sbrFallback = false;
     return m_f_decoderIsInit;
 }
 void AACDecoder::clear() {
@@ -36,6 +40,7 @@ void AACDecoder::reset() {
     m_hAac = NULL;
     m_f_decoderIsInit = false;
     m_f_firstCall = false;
+    m_sync.reset();
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 bool AACDecoder::isValid() {
@@ -43,39 +48,21 @@ bool AACDecoder::isValid() {
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 int32_t AACDecoder::findSyncWord(uint8_t* buf, int32_t nBytes) {
-    const int MIN_ADTS_HEADER_SIZE = 7;
-    auto      validate = [](const uint8_t* buf) -> bool { // check the ADTS header for validity
-        // Layer (bits 14-15) must be 00
-        if ((buf[1] & 0x06) != 0x00) { return false; }
-
-        // Sampling Frequency Index (Bits 18-21) cannot be invalid
-        uint8_t sampling_frequency_index = (buf[2] & 0x3C) >> 2;
-        if (sampling_frequency_index > 12) { return false; }
-
-        // Frame length (bits 30-42) must be at least the header size
-        int frame_length = ((buf[3] & 0x03) << 11) | (buf[4] << 3) | ((buf[5] & 0xE0) >> 5);
-        if (frame_length < MIN_ADTS_HEADER_SIZE) { return false; }
-
-        return true;
-    };
-
-    /* find byte-aligned syncword (12 bits = 0xFFF) */
-    for (int i = 0; i < nBytes - 1; i++) {
-        if ((buf[i + 0] & SYNCWORDH) == SYNCWORDH && (buf[i + 1] & SYNCWORDL) == SYNCWORDL) {
-            int frame_length = ((buf[i + 3] & 0x03) << 11) | (buf[i + 4] << 3) | ((buf[i + 5] & 0xE0) >> 5);
-            if (i + frame_length + MIN_ADTS_HEADER_SIZE > nBytes) {
-                return -1; // Puffergrenze überschritten, kein gültiger Header
-            }
-            /* find a second byte-aligned syncword (12 bits = 0xFFF) */
-            if ((buf[i + frame_length + 0] & SYNCWORDH) == SYNCWORDH && (buf[i + frame_length + 1] & SYNCWORDL) == SYNCWORDL) { return validate(&buf[i]) ? i : -1; }
-        }
-    }
-
-    return -1;
+    // ADTS, three frames in a row with the same profile, samplerate and channel configuration
+    return m_sync.find(buf, nBytes);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int32_t AACDecoder::syncHeader(const uint8_t* hdr, uint32_t* fixed) {
+    if (hdr[0] != 0xFF || (hdr[1] & 0xF6) != 0xF0) return -1; // syncword, layer 0
+    if (((hdr[2] & 0x3C) >> 2) > 12) return -1;             // sampling frequency index
+    int32_t len = ((hdr[3] & 0x03) << 11) | (hdr[4] << 3) | ((hdr[5] & 0xE0) >> 5);
+    if (len < ((hdr[1] & 0x01) ? 7 : 9)) return -1; // at least the header, 9 bytes with crc
+    *fixed = (hdr[1] << 16) | ((hdr[2] & 0xFD) << 8) | (hdr[3] & 0xC0); // id, crc, profile, samplerate, channel config
+    return len;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 uint8_t AACDecoder::getChannels() {
-    return m_aacChannels;
+    return std::min<uint8_t>(m_aacChannels, 2); // more are mixed down
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 uint32_t AACDecoder::getSampleRate() {
@@ -116,13 +103,33 @@ const char* AACDecoder::getErrorMessage(int8_t err) {
     return m_neaacdec->NeAACDecGetErrorMessage(abs(err));
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-int32_t AACDecoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf) {
+int32_t AACDecoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf) { // 16 bit output
+    return decodeAAC(inbuf, bytesLeft, outbuf, FAAD_FMT_16BIT, 2048 * 2 * sizeof(int16_t));
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool AACDecoder::hasPCM32Output() {
+#ifdef AUDIO_PCM_32BIT
+    return true;
+#else
+    return false;
+#endif
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int32_t AACDecoder::decode32(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf) { // 32 bit output, left justified, rounded and clipped once
+    return decodeAAC(inbuf, bytesLeft, outbuf, FAAD_FMT_32BIT, 2048 * 2 * sizeof(int32_t));
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int32_t AACDecoder::decodeAAC(uint8_t* inbuf, int32_t* bytesLeft, void* outbuf, uint8_t format, uint32_t outbufSize) {
+    // faad writes the final layout: interleaved stereo, mono as L = R (upMatrix), 3 ... 8 channels mixed down (downMatrix),
+    // 16 or 32 bit. No conversion pass behind
     uint8_t* ob = (uint8_t*)outbuf;
     if (m_f_firstCall == false) {
+        m_conf->outputFormat = format;
+        m_conf->upMatrix = 1;
+        m_conf->downMatrix = 1;
         if (m_f_setRaWBlockParams) { // set raw AAC values, e.g. for M4A config.
             m_f_setRaWBlockParams = false;
             m_conf->defSampleRate = m_aacSamplerate;
-            m_conf->outputFormat = FAAD_FMT_16BIT;
             m_conf->useOldADTSFormat = 1;
             m_conf->defObjectType = 2;
             int8_t ret = m_neaacdec->NeAACDecSetConfiguration(m_hAac, m_conf);
@@ -140,9 +147,35 @@ int32_t AACDecoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf)
         m_f_firstCall = true;
     }
 
-    m_neaacdec->NeAACDecDecode2(m_hAac, &m_frameInfo, inbuf, *bytesLeft, (void**)&ob, 2048 * 2 * sizeof(int16_t));
+#ifndef SBR_LOW_POWER // real valued qmf_t builds have no complex SBR to switch to
+    uint8_t lpMode = aacSbrLowPower(); // 0: off, 1: on, 2: auto
+    m_conf->sbrLowPower = (lpMode == 1 || (lpMode == 2 && m_f_sbrFallback)) ? 1 : 0; // takes effect with this frame
+    int64_t t0 = esp_timer_get_time();
+#endif
+    m_neaacdec->NeAACDecDecode2(m_hAac, &m_frameInfo, inbuf, *bytesLeft, (void**)&ob, outbufSize);
+#ifndef SBR_LOW_POWER
+    if (lpMode == 2 && m_frameInfo.sbr && !m_frameInfo.isPS && m_frameInfo.samples && m_frameInfo.channels && m_frameInfo.samplerate) {
+        // wall clock time, other tasks and decoders on this core count as load too
+        uint32_t frameUs = (uint64_t)m_frameInfo.samples / m_frameInfo.channels * 1000000 / m_frameInfo.samplerate;
+        uint32_t load = (esp_timer_get_time() - t0) * 100 / frameUs;
+        m_decodeLoad = (m_decodeLoad * 7 + std::min<uint32_t>(load, 400)) / 8;
+        if (!m_f_sbrFallback && m_decodeLoad > 80) {
+            m_f_sbrFallback = true;
+            m_sbrLowLoadFrames = 0;
+            AAC_LOG_INFO("decode load %i%%, switching to low power SBR", m_decodeLoad);
+        } else if (m_f_sbrFallback) { // hysteresis: back only with enough headroom for the complex path
+            m_sbrLowLoadFrames = (m_decodeLoad < 45) ? m_sbrLowLoadFrames + 1 : 0;
+            if (m_sbrLowLoadFrames * frameUs > 5000000) { // 5s in a row, no toggling on short load peaks
+                m_f_sbrFallback = false;
+                m_decodeLoad = 60; // the complex path starts from an estimate, not from the low power load
+                AAC_LOG_INFO("decode load low again, switching back to high quality SBR");
+            }
+        }
+    }
+#endif
     *bytesLeft -= m_frameInfo.bytesconsumed;
     m_validSamples = m_frameInfo.samples;
+    if (m_frameInfo.channels && !m_frameInfo.error) m_aacChannels = m_frameInfo.channels; // mono is 2 (upMatrix)
     int8_t err = 0 - m_frameInfo.error;
     m_compressionRatio = (float)m_frameInfo.samples * 2 / m_frameInfo.bytesconsumed;
     if (err < 0) {
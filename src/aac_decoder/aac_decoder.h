@@ -8,6 +8,7 @@
 #pragma once
 
 #include "../Audio.h"
+#include "../sync_scanner/sync_scanner.h"
 #include "libfaad/neaacdec.h"
 
 #pragma GCC diagnostic warning "-Wunused-function"
@@ -38,18 +39,22 @@ class AACDecoder : public Decoder {
     const char*           getStreamTitle() override;
     const char*           whoIsIt() override;
     int32_t               decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf) override;
+    bool                  hasPCM32Output() override;
+    int32_t               decode32(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf) override;
     void                  setRawBlockParams(uint8_t channels, uint32_t sampleRate, uint8_t BPS, uint32_t tsis, uint32_t AuDaLength) override;
     std::vector<uint32_t> getMetadataBlockPicture() override;
     const char*           arg1() override;
     const char*           arg2() override;
     virtual int32_t       val1() override; // Paramertric Stereo
     virtual int32_t       val2() override; // SBR
+    static int32_t        syncHeader(const uint8_t* hdr, uint32_t* fixed); // SyncScanner
 
   private:
     Audio&       audio;
     ps_ptr<char> m_arg1;
     void         createAudioSpecificConfig(uint8_t* config, uint8_t audioObjectType, uint8_t samplingFrequencyIndex, uint8_t channelConfiguration);
     const char*  getErrorMessage(int8_t err);
+    int32_t      decodeAAC(uint8_t* inbuf, int32_t* bytesLeft, void* outbuf, uint8_t format, uint32_t outbufSize);
 
     NeAACDecHandle                m_hAac;
     NeAACDecFrameInfo             m_frameInfo;
@@ -58,12 +63,16 @@ class AACDecoder : public Decoder {
     const uint8_t                 SYNCWORDL = 0xf0;
     bool                          m_f_decoderIsInit = false;
     bool                          m_f_firstCall = false;
+    SyncScanner                   m_sync{syncHeader, 7, 0xF0};
     bool                          m_f_setRaWBlockParams = false;
     uint32_t                      m_aacSamplerate = 0;
     uint8_t                       m_aacChannels = 0;
     uint8_t                       m_aacProfile = 0;
     uint16_t                      m_validSamples = 0;
     float                         m_compressionRatio = 1;
+    uint16_t                      m_decodeLoad = 0;        // percent of the frame duration, smoothed
+    uint16_t                      m_sbrLowLoadFrames = 0;  // frames in a row with a low load, for the way back to high quality
+    bool                          m_f_sbrFallback = false; // low power SBR while the load is close to real time
     std::unique_ptr<NeaacDecoder> m_neaacdec;
 
     struct AudioSpecificConfig {
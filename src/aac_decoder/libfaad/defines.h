@@ -334,7 +334,7 @@ __unused static void ComplexMult(real_t* y1, real_t* y2, real_t x1, real_t x2, r
     #define QMF_RE(A) (A)
     #define QMF_IM(A)
 #else
-    #define qmf_t     complex_t
+    #define qmf_t     complex_t // runtime low power SBR (sbr_info::lowPower) uses the real part only
     #define QMF_RE(A) RE(A)
     #define QMF_IM(A) IM(A)
 #endif
@@ -136,6 +136,32 @@ int8_t NeaacDecoder::can_decode_ot(const uint8_t object_type) {
 }
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void* NeaacDecoder::faad_malloc(size_t size) {
+    // pool: one block of AAC_POOL_SIZE bytes per decoder, carved into blocks with a free list per block size. Open, Init, Close
+    // and the scratch buffers of every frame only move blocks between the lists, requests that do not fit go to the heap
+    // the pool lives in PSRAM, boards without it allocate every block on the heap as before
+    uint32_t len = (size + 15) & ~15u;
+    if (!m_poolInit) {
+        m_poolInit = true;
+        if (psramFound() && !m_pool.alloc(AAC_POOL_SIZE, "faadPool")) m_pool.reset();
+    }
+    if (m_pool.valid()) {
+        uint8_t c = 0;
+        while (c < AAC_POOL_CLASSES && m_poolSize[c] && m_poolSize[c] != len) c++;
+        if (c < AAC_POOL_CLASSES) {
+            if (m_poolFree[c]) { // reuse
+                uint8_t* p = (uint8_t*)m_poolFree[c];
+                m_poolFree[c] = *(void**)p;
+                return p;
+            }
+            if (m_poolUsed + 16 + len <= m_pool.size()) { // 16 bytes header: class, keeps the alignment
+                uint8_t* p = m_pool.get() + m_poolUsed + 16;
+                *(uint32_t*)(p - 16) = c;
+                m_poolSize[c] = len;
+                m_poolUsed += 16 + len;
+                return p;
+            }
+        }
+    }
     char* ps_str = NULL;
     if (psramFound()) {
         ps_str = (char*)ps_malloc(size);
@@ -146,19 +172,22 @@ void* NeaacDecoder::faad_malloc(size_t size) {
 }
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void* NeaacDecoder::faad_calloc(size_t len, size_t size) {
-    char* ps_str = NULL;
-    if (psramFound()) {
-        ps_str = (char*)ps_calloc(len, size);
-    } else {
-        ps_str = (char*)calloc(len, size);
-    }
+    void* ps_str = faad_malloc(len * size);
+    if (ps_str) memset(ps_str, 0, len * size);
     return ps_str;
 }
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 /* common free function */
 template <typename freeType> void NeaacDecoder::faad_free(freeType** b) {
     if (*b) {
-        free(*b);
+        uint8_t* p = (uint8_t*)*b;
+        if (m_pool.valid() && p > m_pool.get() && p < m_pool.get() + m_pool.size()) { // back to the free list of its size
+            uint32_t c = *(uint32_t*)(p - 16);
+            *(void**)p = m_poolFree[c];
+            m_poolFree[c] = p;
+        } else {
+            free(*b);
+        }
         *b = NULL;
     }
 }
@@ -392,6 +421,10 @@ NeAACDecHandle NeaacDecoder::NeAACDecOpen() {
     hDecoder->config.defObjectType = MAIN;
     hDecoder->config.defSampleRate = 44100; /* Default: 44.1kHz */
     hDecoder->config.downMatrix = 0;
+    hDecoder->config.upMatrix = 0;
+#ifdef SBR_LOW_POWER
+    hDecoder->config.sbrLowPower = 1;
+#endif
     hDecoder->adts_header_present = 0;
     hDecoder->adif_header_present = 0;
     hDecoder->latm_header_present = 0;
@@ -457,6 +490,10 @@ uint8_t NeaacDecoder::NeAACDecSetConfiguration(NeAACDecHandle hpDecoder, NeAACDe
         hDecoder->config.outputFormat = config->outputFormat;
         if (config->downMatrix > 1) return 0;
         hDecoder->config.downMatrix = config->downMatrix;
+        if (config->upMatrix > 1) return 0;
+        hDecoder->config.upMatrix = config->upMatrix;
+        if (config->sbrLowPower > 1) return 0;
+        hDecoder->config.sbrLowPower = config->sbrLowPower;
         /* OK */
         return 1;
     }
@@ -1043,22 +1080,36 @@ void* NeaacDecoder::aac_frame_decode(NeAACDecStruct* hDecoder, NeAACDecFrameInfo
         if (channels == 7) /* not a standard channelConfiguration */
             hDecoder->channelConfiguration = 0;
     }
-    if ((channels == 5 || channels == 6) && hDecoder->config.downMatrix) {
+    if (channels > 2 && hDecoder->config.downMatrix) {
         hDecoder->downMatrix = 1;
         output_channels = 2;
     } else {
         output_channels = channels;
     }
-#if (defined(PS_DEC) || defined(DRM_PS))
     hDecoder->upMatrix = 0;
+#if (defined(PS_DEC) || defined(DRM_PS))
     /* check if we have a mono file */
-    if (output_channels == 1) {
-        /* upMatrix to 2 channels for implicit signalling of PS */
-        hDecoder->upMatrix = 1;
-        output_channels = 2;
-    }
+    if (output_channels == 1) hDecoder->upMatrix = 1; /* upMatrix to 2 channels for implicit signalling of PS */
 #endif
+    if (output_channels == 1 && hDecoder->config.upMatrix) hDecoder->upMatrix = 1; /* mono as L = R, written in the output pass */
+    if (hDecoder->upMatrix) output_channels = 2;
     /* Make a channel configuration based on either a PCE or a channelConfiguration */
+    if (hDecoder->downMatrix) { /* speaker positions of the decoded channels for the matrix, hInfo reports the stereo result */
+        static const uint8_t dmxPos[LFE_CHANNEL + 1] = {Downmix::DMX_SILENT, Downmix::DMX_C,  Downmix::DMX_L,  Downmix::DMX_R,  Downmix::DMX_LS,
+                                                        Downmix::DMX_RS,     Downmix::DMX_LB, Downmix::DMX_RB, Downmix::DMX_CB, Downmix::DMX_LFE};
+        uint8_t pos[Downmix::DMX_MAX_CHANNELS];
+        uint8_t n = std::min<uint8_t>(channels, Downmix::DMX_MAX_CHANNELS); /* more are not mixed */
+        hDecoder->downMatrix = 0;
+        create_channel_config(hDecoder, hInfo);
+        hDecoder->downMatrix = 1;
+        for (i = 0; i < n; i++) {
+            uint8_t p = hInfo->channel_position[i];
+            pos[i] = (p <= LFE_CHANNEL) ? dmxPos[p] : Downmix::DMX_SILENT;
+            if (!hInfo->num_side_channels && p == BACK_CHANNEL_LEFT) pos[i] = Downmix::DMX_LS; /* 4.0 ... 5.1: the back pair are the surrounds */
+            if (!hInfo->num_side_channels && p == BACK_CHANNEL_RIGHT) pos[i] = Downmix::DMX_RS;
+        }
+        m_downmix.setLayout(n, pos);
+    }
     create_channel_config(hDecoder, hInfo);
     /* number of samples in this frame */
     hInfo->samples = frame_len * output_channels;
@@ -1132,7 +1183,19 @@ void* NeaacDecoder::aac_frame_decode(NeAACDecStruct* hDecoder, NeAACDecFrameInfo
         if (hDecoder->downSampledSBR) { hInfo->sbr = SBR_DOWNSAMPLED; }
     }
 #endif
-    sample_buffer = output_to_PCM(hDecoder, hDecoder->time_out, sample_buffer, output_channels, frame_len, hDecoder->config.outputFormat);
+    if (hDecoder->downMatrix) { /* 3 ... 8 channels -> L/R, block by block over the channel buffers, the PCM pass sees a stereo pair */
+        const real_t* in[Downmix::DMX_MAX_CHANNELS];
+        if (m_dmxBuff.size() < 2 * frame_len * sizeof(real_t) && !m_dmxBuff.alloc_array(2 * frame_len, "dmxBuff")) {
+            hInfo->error = 27;
+            goto error;
+        }
+        for (i = 0; i < m_downmix.getChannels(); i++) in[i] = hDecoder->time_out[hDecoder->internal_channel[i]];
+        real_t* mix[2] = {m_dmxBuff.get(), m_dmxBuff.get() + frame_len};
+        m_downmix.process(in, frame_len, mix[0], mix[1]);
+        sample_buffer = output_to_PCM(hDecoder, mix, sample_buffer, output_channels, frame_len, hDecoder->config.outputFormat);
+    } else {
+        sample_buffer = output_to_PCM(hDecoder, hDecoder->time_out, sample_buffer, output_channels, frame_len, hDecoder->config.outputFormat);
+    }
 #ifdef DRM
     // conceal_output(hDecoder, frame_len, output_channels, sample_buffer);
 #endif
@@ -2797,11 +2860,7 @@ uint8_t NeaacDecoder::is_noise(ic_stream* ics, uint8_t group, uint8_t sfb) {
 #ifndef FIXED_POINT
 real_t NeaacDecoder::get_sample(real_t** input, uint8_t channel, uint16_t sample, uint8_t down_matrix, uint8_t* internal_channel) {
     if (!down_matrix) return input[internal_channel[channel]][sample];
-    if (channel == 0) {
-        return DM_MUL * (input[internal_channel[1]][sample] + input[internal_channel[0]][sample] * RSQRT2 + input[internal_channel[3]][sample] * RSQRT2);
-    } else {
-        return DM_MUL * (input[internal_channel[2]][sample] + input[internal_channel[0]][sample] * RSQRT2 + input[internal_channel[4]][sample] * RSQRT2);
-    }
+    return input[channel][sample]; /* L and R, mixed by m_downmix */
 }
 #endif
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -2916,7 +2975,7 @@ void NeaacDecoder::to_PCM_32bit(NeAACDecStruct* hDecoder, real_t** input, uint8_
             for (i = 0; i < frame_len; i++) {
                 real_t inp = input[hDecoder->internal_channel[0]][i];
                 inp *= 65536.0f;
-                CLIP(inp, 2147483647.0f, -2147483648.0f);
+                CLIP(inp, 2147483520.0f, -2147483648.0f);
                 (*sample_buffer)[i] = (int32_t)lrintf(inp);
             }
             break;
@@ -2926,7 +2985,7 @@ void NeaacDecoder::to_PCM_32bit(NeAACDecStruct* hDecoder, real_t** input, uint8_
                 for (i = 0; i < frame_len; i++) {
                     real_t inp0 = input[ch][i];
                     inp0 *= 65536.0f;
-                    CLIP(inp0, 2147483647.0f, -2147483648.0f);
+                    CLIP(inp0, 2147483520.0f, -2147483648.0f);
                     (*sample_buffer)[(i * 2) + 0] = (int32_t)lrintf(inp0);
                     (*sample_buffer)[(i * 2) + 1] = (int32_t)lrintf(inp0);
                 }
@@ -2938,8 +2997,8 @@ void NeaacDecoder::to_PCM_32bit(NeAACDecStruct* hDecoder, real_t** input, uint8_
                     real_t inp1 = input[ch1][i];
                     inp0 *= 65536.0f;
                     inp1 *= 65536.0f;
-                    CLIP(inp0, 2147483647.0f, -2147483648.0f);
-                    CLIP(inp1, 2147483647.0f, -2147483648.0f);
+                    CLIP(inp0, 2147483520.0f, -2147483648.0f);
+                    CLIP(inp1, 2147483520.0f, -2147483648.0f);
                     (*sample_buffer)[(i * 2) + 0] = (int32_t)lrintf(inp0);
                     (*sample_buffer)[(i * 2) + 1] = (int32_t)lrintf(inp1);
                 }
@@ -2950,7 +3009,7 @@ void NeaacDecoder::to_PCM_32bit(NeAACDecStruct* hDecoder, real_t** input, uint8_
                 for (i = 0; i < frame_len; i++) {
                     real_t inp = get_sample(input, ch, i, hDecoder->downMatrix, hDecoder->internal_channel);
                     inp *= 65536.0f;
-                    CLIP(inp, 2147483647.0f, -2147483648.0f);
+                    CLIP(inp, 2147483520.0f, -2147483648.0f);
                     (*sample_buffer)[(i * channels) + ch] = (int32_t)lrintf(inp);
                 }
             }
@@ -3074,17 +3133,7 @@ void* NeaacDecoder::output_to_PCM(NeAACDecStruct* hDecoder, real_t** input, void
 real_t NeaacDecoder::get_sample(real_t** input, uint8_t channel, uint16_t sample, uint8_t down_matrix, uint8_t up_matrix, uint8_t* internal_channel) {
     if (up_matrix == 1) return input[internal_channel[0]][sample];
     if (!down_matrix) return input[internal_channel[channel]][sample];
-    if (channel == 0) {
-        real_t C = MUL_F(input[internal_channel[0]][sample], RSQRT2);
-        real_t L_S = MUL_F(input[internal_channel[3]][sample], RSQRT2);
-        real_t cum = input[internal_channel[1]][sample] + C + L_S;
-        return MUL_F(cum, DM_MUL);
-    } else {
-        real_t C = MUL_F(input[internal_channel[0]][sample], RSQRT2);
-        real_t R_S = MUL_F(input[internal_channel[4]][sample], RSQRT2);
-        real_t cum = input[internal_channel[2]][sample] + C + R_S;
-        return MUL_F(cum, DM_MUL);
-    }
+    return input[channel][sample]; /* L and R, mixed by m_downmix */
 }
 #endif
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -3129,13 +3178,9 @@ void* NeaacDecoder::output_to_PCM(NeAACDecStruct* hDecoder, real_t** input, void
             case FAAD_FMT_32BIT:
                 for (i = 0; i < frame_len; i++) {
                     int32_t tmp = get_sample(input, ch, i, hDecoder->downMatrix, hDecoder->upMatrix, hDecoder->internal_channel);
-                    if (tmp >= 0) {
-                        tmp += (1 << (16 - REAL_BITS - 1));
-                        tmp <<= (16 - REAL_BITS);
-                    } else {
-                        tmp += -(1 << (16 - REAL_BITS - 1));
-                        tmp <<= (16 - REAL_BITS);
-                    }
+                    if (tmp >= REAL_CONST(32767)) tmp = REAL_CONST(32767) + ((1 << REAL_BITS) - 1); // left justified, clipped
+                    if (tmp <= REAL_CONST(-32768)) tmp = REAL_CONST(-32768);
+                    tmp <<= (16 - REAL_BITS);
                     int_sample_buffer[(i * channels) + ch] = (int32_t)tmp;
                 }
                 break;
@@ -3813,7 +3858,7 @@ void NeaacDecoder::faad_imdct(uint16_t mdct_len, real_t* X_in, real_t* X_out) {
     #endif
 #endif
     // complex_t Z1[512];
-    complex_t* Z1 = (complex_t*)ps_malloc(512 * sizeof(complex_t));
+    complex_t* Z1 = (complex_t*)faad_malloc(512 * sizeof(complex_t));
     complex_t* sincos = mdct_select->sincos;
     uint16_t   N = mdct_select->N;
     uint16_t   N2 = N >> 1;
@@ -3897,7 +3942,7 @@ void NeaacDecoder::faad_mdct(uint16_t mdct_len, real_t* X_in, real_t* X_out) {
     uint16_t  k;
     complex_t x;
     // complex_t Z1[512];
-    complex_t* Z1 = (complex_t*)ps_malloc(512 * sizeof(complex_t));
+    complex_t* Z1 = (complex_t*)faad_malloc(512 * sizeof(complex_t));
     complex_t* sincos = mdct_select->sincos;
     uint16_t   N = mdct_select->N;
     uint16_t   N2 = N >> 1;
@@ -3943,7 +3988,7 @@ void NeaacDecoder::faad_mdct(uint16_t mdct_len, real_t* X_in, real_t* X_out) {
         X_out[N2 + n] = -IM(x);
         X_out[N - 1 - n] = RE(x);
     }
-    if (Z1) free(Z1);
+    if (Z1) faad_free(&Z1);
 }
 #endif
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -4322,8 +4367,8 @@ uint8_t NeaacDecoder::reordered_spectral_data(NeAACDecStruct* hDecoder, ic_strea
     uint16_t numberOfSegments, numberOfSets, numberOfCodewords;
     // codeword_t codeword[512];
     // bits_t     segment[512];
-    codeword_t* codeword = (codeword_t*)ps_malloc(sizeof(codeword_t) * 512);
-    bits_t*     segment = (bits_t*)ps_malloc(sizeof(bits_t) * 512);
+    codeword_t* codeword = (codeword_t*)faad_malloc(sizeof(codeword_t) * 512);
+    bits_t*     segment = (bits_t*)faad_malloc(sizeof(bits_t) * 512);
     uint16_t    sp_offset[8];
     uint16_t    g, i, sortloop, set, bitsread;
     /*uint16_t bitsleft, codewordsleft*/;
@@ -5262,7 +5307,6 @@ void NeaacDecoder::DST4_32(real_t* y, real_t* x) {
 #endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
 void NeaacDecoder::DCT2_16_unscaled(real_t* y, real_t* x) {
     real_t f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10;
     real_t f11, f12, f13, f14, f15, f16, f17, f18, f19, f20;
@@ -5388,11 +5432,9 @@ void NeaacDecoder::DCT2_16_unscaled(real_t* y, real_t* x) {
     y[7] = f109 - f108;
     y[9] = f110 - f109;
 }
-    #endif
 #endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
 void NeaacDecoder::DCT4_16(real_t* y, real_t* x) {
     real_t f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10;
     real_t f11, f12, f13, f14, f15, f16, f17, f18, f19, f20;
@@ -5570,11 +5612,9 @@ void NeaacDecoder::DCT4_16(real_t* y, real_t* x) {
     y[10] = MUL_F(FRAC_CONST(0.7071067811865474), f156);
     y[5] = MUL_F(FRAC_CONST(0.7071067811865474), f157);
 }
-    #endif
 #endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
 void NeaacDecoder::DCT3_32_unscaled(real_t* y, real_t* x) {
     real_t f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10;
     real_t f11, f12, f13, f14, f15, f16, f17, f18, f19, f20;
@@ -5910,11 +5950,9 @@ void NeaacDecoder::DCT3_32_unscaled(real_t* y, real_t* x) {
     y[16] = f97 - f244;
     y[15] = f97 + f244;
 }
-    #endif
 #endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
 void NeaacDecoder::DCT2_32_unscaled(real_t* y, real_t* x) {
     real_t f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10;
     real_t f11, f12, f13, f14, f15, f16, f17, f18, f19, f20;
@@ -6232,7 +6270,6 @@ void NeaacDecoder::DCT2_32_unscaled(real_t* y, real_t* x) {
     y[15] = f285 - f284;
     y[17] = f286 - f285;
 }
-    #endif // SBR_LOW_POWER
 #endif     // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
@@ -7177,11 +7214,15 @@ uint8_t NeaacDecoder::reconstruct_single_channel(NeAACDecStruct* hDecoder, ic_st
         /* check if any of the PS tools is used */
     #if (defined(PS_DEC) || defined(DRM_PS))
         if (hDecoder->ps_used[ele] == 0) {
+    #endif
+    #ifndef SBR_LOW_POWER
+            hDecoder->sbr[ele]->lowPower = hDecoder->config.sbrLowPower;
     #endif
             retval = sbrDecodeSingleFrame(hDecoder->sbr[ele], hDecoder->time_out[ch], hDecoder->postSeekResetFlag, hDecoder->downSampledSBR);
             hDecoder->isPS = 0;
     #if (defined(PS_DEC) || defined(DRM_PS))
         } else {
+            hDecoder->sbr[ele]->lowPower = 0; // PS needs the complex QMF
             retval = sbrDecodeSingleFramePS(hDecoder->sbr[ele], hDecoder->time_out[ch], hDecoder->time_out[ch + 1], hDecoder->postSeekResetFlag, hDecoder->downSampledSBR);
             hDecoder->isPS = 1;
         }
@@ -7354,6 +7395,9 @@ uint8_t NeaacDecoder::reconstruct_channel_pair(NeAACDecStruct* hDecoder, ic_stre
             hDecoder->sbr[ele]->maxAACLine = 8 * min(cpe->ics1.swb_offset[max(cpe->ics1.max_sfb - 1, 0)], cpe->ics1.swb_offset_max);
         else
             hDecoder->sbr[ele]->maxAACLine = min(cpe->ics1.swb_offset[max(cpe->ics1.max_sfb - 1, 0)], cpe->ics1.swb_offset_max);
+    #ifndef SBR_LOW_POWER
+        hDecoder->sbr[ele]->lowPower = hDecoder->config.sbrLowPower;
+    #endif
         retval = sbrDecodeCoupleFrame(hDecoder->sbr[ele], hDecoder->time_out[ch0], hDecoder->time_out[ch1], hDecoder->postSeekResetFlag, hDecoder->downSampledSBR);
         if (retval > 0) { goto exit; }
     } else if (((hDecoder->sbr_present_flag == 1) || (hDecoder->forceUpSampling == 1)) && !hDecoder->sbr_alloced[hDecoder->fr_ch_ele]) {
@@ -9899,8 +9943,8 @@ void NeaacDecoder::lt_prediction(ic_stream* ics, ltp_info* ltp, real_t* spec, in
             }
         }
     }
-    if (x_est) free(x_est);
-    if (X_est) free(X_est);
+    if (x_est) faad_free(&x_est);
+    if (X_est) faad_free(&X_est);
 }
 #endif // LPT_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -10858,8 +10902,8 @@ void NeaacDecoder::ps_decorrelate(ps_info* ps, qmf_t X_left[38][64], qmf_t X_rig
     /* update delay indices */
     ps->saved_delay = temp_delay;
     for (m = 0; m < NO_ALLPASS_LINKS; m++) ps->delay_buf_index_ser[m] = temp_delay_ser[m];
-    if (P) free(P);
-    if (G_TransientRatio) free(G_TransientRatio);
+    if (P) faad_free(&P);
+    if (G_TransientRatio) faad_free(&G_TransientRatio);
 }
 #endif //  PS_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -11568,6 +11612,9 @@ sbr_info* NeaacDecoder::sbrDecodeInit(uint16_t framelength, uint8_t id_aac, uint
     sbr->prevEnvIsShort[1] = -1;
     sbr->header_count = 0;
     sbr->Reset = 1;
+    #ifdef SBR_LOW_POWER
+    sbr->lowPower = 1; // real valued qmf_t, config.sbrLowPower is not used
+    #endif
     #ifdef DRM
     sbr->Is_DRM_SBR = IsDRM;
     #endif
@@ -11818,6 +11865,13 @@ uint8_t NeaacDecoder::sbr_process_channel(sbr_info* sbr, real_t* channel_buf, qm
                 M_band = sbr->M;
                 bsco_band = sbr->bsco;
             }
+            if (sbr->lowPower) { // the synthesis reads the real part only
+                for (k = 0; k < kx_band + bsco_band; k++) { QMF_RE(X[l][k]) = QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][k]); }
+                for (k = kx_band + bsco_band; k < min(kx_band + M_band, 63); k++) { QMF_RE(X[l][k]) = QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][k]); }
+                for (k = max(kx_band + bsco_band, kx_band + M_band); k < 64; k++) { QMF_RE(X[l][k]) = 0; }
+                QMF_RE(X[l][kx_band - 1 + bsco_band]) += QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][kx_band - 1 + bsco_band]);
+                continue;
+            }
     #ifndef SBR_LOW_POWER
             for (k = 0; k < kx_band + bsco_band; k++) {
                 QMF_RE(X[l][k]) = QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][k]);
@@ -11831,12 +11885,7 @@ uint8_t NeaacDecoder::sbr_process_channel(sbr_info* sbr, real_t* channel_buf, qm
                 QMF_RE(X[l][k]) = 0;
                 QMF_IM(X[l][k]) = 0;
             }
-    #else
-            for (k = 0; k < kx_band + bsco_band; k++) { QMF_RE(X[l][k]) = QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][k]); }
-            for (k = kx_band + bsco_band; k < min(kx_band + M_band, 63); k++) { QMF_RE(X[l][k]) = QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][k]); }
-            for (k = max(kx_band + bsco_band, kx_band + M_band); k < 64; k++) { QMF_RE(X[l][k]) = 0; }
-            QMF_RE(X[l][kx_band - 1 + bsco_band]) += QMF_RE(sbr->Xsbr[ch][l + sbr->tHFAdj][kx_band - 1 + bsco_band]);
-    #endif
+    #endif // SBR_LOW_POWER
         }
     }
     return ret;
@@ -13031,14 +13080,11 @@ void NeaacDecoder::calculate_gain(sbr_info* sbr, sbr_hfadj_info* adj, uint8_t ch
             G_boost = min(G_boost, QUANTISE2REAL(1.328771237) /* log2(1.584893192 ^ 2) */);
             for (m = ml1; m < ml2; m++) {
                         /* apply compensation to gain, noise floor sf's and sinusoid levels */
-            #ifndef SBR_LOW_POWER
-                adj->G_lim_boost[l][m] = QUANTISE2REAL(pow2((G_lim[m] + G_boost) / 2.0));
-            #else
-                /* sqrt() will be done after the aliasing reduction to save a
-                 * few multiplies
-                 */
-                adj->G_lim_boost[l][m] = QUANTISE2REAL(pow2(G_lim[m] + G_boost));
-            #endif
+                if (!sbr->lowPower) {
+                    adj->G_lim_boost[l][m] = QUANTISE2REAL(pow2((G_lim[m] + G_boost) / 2.0));
+                } else { // sqrt() will be done after the aliasing reduction to save a few multiplies
+                    adj->G_lim_boost[l][m] = QUANTISE2REAL(pow2(G_lim[m] + G_boost));
+                }
                 adj->Q_M_lim_boost[l][m] = QUANTISE2REAL(pow2((Q_M_lim[m] + 10 + G_boost) / 2.0));
                 if (S_M[m] != LOG2_MIN_INF) {
                     adj->S_M_boost[l][m] = QUANTISE2REAL(pow2((S_M[m] + 10 + G_boost) / 2.0));
@@ -13176,14 +13222,11 @@ void NeaacDecoder::calculate_gain(sbr_info* sbr, sbr_hfadj_info* adj, uint8_t ch
             G_boost = min(G_boost, (real_t)2.51188643 /* 1.584893192 ^ 2 */);
             for (m = ml1; m < ml2; m++) {
                         /* apply compensation to gain, noise floor sf's and sinusoid levels */
-            #ifndef SBR_LOW_POWER
-                adj->G_lim_boost[l][m] = sqrt(G_lim[m] * G_boost);
-            #else
-                /* sqrt() will be done after the aliasing reduction to save a
-                 * few multiplies
-                 */
-                adj->G_lim_boost[l][m] = G_lim[m] * G_boost;
-            #endif
+                if (!sbr->lowPower) {
+                    adj->G_lim_boost[l][m] = sqrt(G_lim[m] * G_boost);
+                } else { // sqrt() will be done after the aliasing reduction to save a few multiplies
+                    adj->G_lim_boost[l][m] = G_lim[m] * G_boost;
+                }
                 adj->Q_M_lim_boost[l][m] = sqrt(Q_M_lim[m] * G_boost);
                 if (S_M[m] != 0) {
                     adj->S_M_boost[l][m] = sqrt(S_M[m] * G_boost);
@@ -13199,7 +13242,6 @@ void NeaacDecoder::calculate_gain(sbr_info* sbr, sbr_hfadj_info* adj, uint8_t ch
 #endif         // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
 void NeaacDecoder::calc_gain_groups(sbr_info* sbr, sbr_hfadj_info* adj, real_t* deg, uint8_t ch) {
     uint8_t l, k, i;
     uint8_t grouping;
@@ -13240,11 +13282,9 @@ void NeaacDecoder::calc_gain_groups(sbr_info* sbr, sbr_hfadj_info* adj, real_t*
         sbr->N_G[l] = (uint8_t)(i >> 1);
     }
 }
-    #endif // SBR_LOW_POWER
 #endif     // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
 void NeaacDecoder::aliasing_reduction(sbr_info* sbr, sbr_hfadj_info* adj, real_t* deg, uint8_t ch) {
     uint8_t l, k, m;
     real_t  E_total, E_total_est, G_target, acc;
@@ -13257,21 +13297,21 @@ void NeaacDecoder::aliasing_reduction(sbr_info* sbr, sbr_hfadj_info* adj, real_t
                 /* E_total_est: integer */
                 /* E_total: integer */
                 E_total_est += sbr->E_curr[ch][m - sbr->kx][l];
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
                 E_total += MUL_Q2(sbr->E_curr[ch][m - sbr->kx][l], adj->G_lim_boost[l][m - sbr->kx]);
-        #else
+    #else
                 E_total += sbr->E_curr[ch][m - sbr->kx][l] * adj->G_lim_boost[l][m - sbr->kx];
-        #endif
+    #endif
             }
             /* G_target: fixed point */
             if ((E_total_est + _EPS) == 0) {
                 G_target = 0;
             } else {
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
                 G_target = (((int64_t)(E_total)) << Q2_BITS) / (E_total_est + _EPS);
-        #else
+    #else
                 G_target = E_total / (E_total_est + _EPS);
-        #endif
+    #endif
             }
             acc = 0;
             for (m = sbr->f_group[l][(k << 1)]; m < sbr->f_group[l][(k << 1) + 1]; m++) {
@@ -13284,60 +13324,56 @@ void NeaacDecoder::aliasing_reduction(sbr_info* sbr, sbr_hfadj_info* adj, real_t
                 }
                 adj->G_lim_boost[l][m - sbr->kx] = MUL_C(alpha, G_target) + MUL_C((COEF_CONST(1) - alpha), adj->G_lim_boost[l][m - sbr->kx]);
                     /* acc: integer */
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
                 acc += MUL_Q2(adj->G_lim_boost[l][m - sbr->kx], sbr->E_curr[ch][m - sbr->kx][l]);
-        #else
+    #else
                 acc += adj->G_lim_boost[l][m - sbr->kx] * sbr->E_curr[ch][m - sbr->kx][l];
-        #endif
+    #endif
             }
             /* acc: fixed point */
             if (acc + _EPS == 0) {
                 acc = 0;
             } else {
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
                 acc = (((int64_t)(E_total)) << Q2_BITS) / (acc + _EPS);
-        #else
+    #else
                 acc = E_total / (acc + _EPS);
-        #endif
+    #endif
             }
             for (m = sbr->f_group[l][(k << 1)]; m < sbr->f_group[l][(k << 1) + 1]; m++) {
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
                 adj->G_lim_boost[l][m - sbr->kx] = MUL_Q2(acc, adj->G_lim_boost[l][m - sbr->kx]);
-        #else
+    #else
                 adj->G_lim_boost[l][m - sbr->kx] = acc * adj->G_lim_boost[l][m - sbr->kx];
-        #endif
+    #endif
             }
         }
     }
     for (l = 0; l < sbr->L_E[ch]; l++) {
         for (k = 0; k < sbr->N_L[sbr->bs_limiter_bands]; k++) {
             for (m = sbr->f_table_lim[sbr->bs_limiter_bands][k]; m < sbr->f_table_lim[sbr->bs_limiter_bands][k + 1]; m++) {
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
                 adj->G_lim_boost[l][m] = sqrt(adj->G_lim_boost[l][m]);
-        #else
+    #else
                 adj->G_lim_boost[l][m] = sqrt(adj->G_lim_boost[l][m]);
-        #endif
+    #endif
             }
         }
     }
 }
-    #endif // SBR_LOW_POWER
 #endif     // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
 void NeaacDecoder::hf_assembly(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MAX_NTSRHFG][64], uint8_t ch) {
     real_t h_smooth[] = {FRAC_CONST(0.03183050093751), FRAC_CONST(0.11516383427084), FRAC_CONST(0.21816949906249), FRAC_CONST(0.30150283239582), FRAC_CONST(0.33333333333333)};
     int8_t phi_re[] = {1, 0, -1, 0};
-    (void)h_smooth;
     int8_t phi_im[] = {0, 1, 0, -1};
-    (void)phi_im;
     uint8_t  m, l, i, n;
     uint16_t fIndexNoise = 0;
     uint8_t  fIndexSine = 0;
     uint8_t  assembly_reset = 0;
     real_t   G_filt, Q_filt;
     uint8_t  h_SL;
-    (void)h_SL;
     if (sbr->Reset == 1) {
         assembly_reset = 1;
         fIndexNoise = 0;
@@ -13347,12 +13383,8 @@ void NeaacDecoder::hf_assembly(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MA
     fIndexSine = sbr->psi_is_prev[ch];
     for (l = 0; l < sbr->L_E[ch]; l++) {
         uint8_t no_noise = (l == sbr->l_A[ch] || l == sbr->prevEnvIsShort[ch]) ? 1 : 0;
-    #ifdef SBR_LOW_POWER
-        h_SL = 0;
-    #else
-        h_SL = (sbr->bs_smoothing_mode == 1) ? 0 : 4;
+        h_SL = (sbr->bs_smoothing_mode == 1 || sbr->lowPower) ? 0 : 4;
         h_SL = (no_noise ? 0 : h_SL);
-    #endif
         if (assembly_reset) {
             for (n = 0; n < 4; n++) {
                 memcpy(sbr->G_temp_prev[ch][n], adj->G_lim_boost[l], sbr->M * sizeof(real_t));
@@ -13363,10 +13395,8 @@ void NeaacDecoder::hf_assembly(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MA
             assembly_reset = 0;
         }
         for (i = sbr->t_E[ch][l]; i < sbr->t_E[ch][l + 1]; i++) {
-    #ifdef SBR_LOW_POWER
             uint8_t i_min1, i_plus1;
-            uint8_t sinusoids = 0;
-    #endif
+            uint8_t sinusoids = 0; // low power only
             /* load new values into ringbuffer */
             memcpy(sbr->G_temp_prev[ch][sbr->GQ_ringbuf_index[ch]], adj->G_lim_boost[l], sbr->M * sizeof(real_t));
             memcpy(sbr->Q_temp_prev[ch][sbr->GQ_ringbuf_index[ch]], adj->Q_M_lim_boost[l], sbr->M * sizeof(real_t));
@@ -13374,7 +13404,6 @@ void NeaacDecoder::hf_assembly(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MA
                 qmf_t psi;
                 G_filt = 0;
                 Q_filt = 0;
-    #ifndef SBR_LOW_POWER
                 if (h_SL != 0) {
                     uint8_t ri = sbr->GQ_ringbuf_index[ch];
                     for (n = 0; n <= 4; n++) {
@@ -13385,12 +13414,9 @@ void NeaacDecoder::hf_assembly(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MA
                         Q_filt += MUL_F(sbr->Q_temp_prev[ch][ri][m], curr_h_smooth);
                     }
                 } else {
-    #endif
                     G_filt = sbr->G_temp_prev[ch][sbr->GQ_ringbuf_index[ch]][m];
                     Q_filt = sbr->Q_temp_prev[ch][sbr->GQ_ringbuf_index[ch]][m];
-    #ifndef SBR_LOW_POWER
                 }
-    #endif
                 Q_filt = (adj->S_M_boost[l][m] != 0 || no_noise) ? 0 : Q_filt;
                 /* add noise to the output */
                 fIndexNoise = (fIndexNoise + 1) & 511;
@@ -13405,14 +13431,16 @@ void NeaacDecoder::hf_assembly(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MA
     #endif
                 if (sbr->bs_extension_id == 3 && sbr->bs_extension_data == 42) QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) = 16428320;
     #ifndef SBR_LOW_POWER
+                if (!sbr->lowPower) {
         #ifndef FIXED_POINT
-                QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) = G_filt * QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) + MUL_F(Q_filt, IM(V[fIndexNoise]));
+                    QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) = G_filt * QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) + MUL_F(Q_filt, IM(V[fIndexNoise]));
         #else
-                // QMF_IM(Xsbr[i + sbr->tHFAdj][m+sbr->kx]) = MUL_Q2(G_filt, QMF_IM(Xsbr[i + sbr->tHFAdj][m+sbr->kx]))
-                //     + MUL_F(Q_filt, IM(V[fIndexNoise]));
-                QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) = MUL_R(G_filt, QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx])) + MUL_F(Q_filt, IM(V[fIndexNoise]));
+                    // QMF_IM(Xsbr[i + sbr->tHFAdj][m+sbr->kx]) = MUL_Q2(G_filt, QMF_IM(Xsbr[i + sbr->tHFAdj][m+sbr->kx]))
+                    //     + MUL_F(Q_filt, IM(V[fIndexNoise]));
+                    QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) = MUL_R(G_filt, QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx])) + MUL_F(Q_filt, IM(V[fIndexNoise]));
         #endif
-    #endif
+                }
+    #endif // SBR_LOW_POWER
                 {
                     int8_t rev = (((m + sbr->kx) & 1) ? -1 : 1);
                     QMF_RE(psi) = adj->S_M_boost[l][m] * phi_re[fIndexSine];
@@ -13422,48 +13450,51 @@ void NeaacDecoder::hf_assembly(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MA
                     QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) += QMF_RE(psi);
     #endif
     #ifndef SBR_LOW_POWER
-                    QMF_IM(psi) = rev * adj->S_M_boost[l][m] * phi_im[fIndexSine];
+                    if (!sbr->lowPower) {
+                        QMF_IM(psi) = rev * adj->S_M_boost[l][m] * phi_im[fIndexSine];
         #ifdef FIXED_POINT
-                    QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) += (QMF_IM(psi) << REAL_BITS);
+                        QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) += (QMF_IM(psi) << REAL_BITS);
         #else
-                    QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) += QMF_IM(psi);
+                        QMF_IM(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) += QMF_IM(psi);
         #endif
+                    } else
+    #endif // SBR_LOW_POWER
+                    {
+                        i_min1 = (fIndexSine - 1) & 3;
+                        i_plus1 = (fIndexSine + 1) & 3;
+    #ifndef FIXED_POINT
+                        if ((m == 0) && (phi_re[i_plus1] != 0)) {
+                            QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx - 1]) += (rev * phi_re[i_plus1] * MUL_F(adj->S_M_boost[l][0], FRAC_CONST(0.00815)));
+                            if (sbr->M != 0) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_plus1] * MUL_F(adj->S_M_boost[l][1], FRAC_CONST(0.00815))); }
+                        }
+                        if ((m > 0) && (m < sbr->M - 1) && (sinusoids < 16) && (phi_re[i_min1] != 0)) {
+                            QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_min1] * MUL_F(adj->S_M_boost[l][m - 1], FRAC_CONST(0.00815)));
+                        }
+                        if ((m > 0) && (m < sbr->M - 1) && (sinusoids < 16) && (phi_re[i_plus1] != 0)) {
+                            QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_plus1] * MUL_F(adj->S_M_boost[l][m + 1], FRAC_CONST(0.00815)));
+                        }
+                        if ((m == sbr->M - 1) && (sinusoids < 16) && (phi_re[i_min1] != 0)) {
+                            if (m > 0) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_min1] * MUL_F(adj->S_M_boost[l][m - 1], FRAC_CONST(0.00815))); }
+                            if (m + sbr->kx < 64) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx + 1]) += (rev * phi_re[i_min1] * MUL_F(adj->S_M_boost[l][m], FRAC_CONST(0.00815))); }
+                        }
     #else
-                    i_min1 = (fIndexSine - 1) & 3;
-                    i_plus1 = (fIndexSine + 1) & 3;
-        #ifndef FIXED_POINT
-                    if ((m == 0) && (phi_re[i_plus1] != 0)) {
-                        QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx - 1]) += (rev * phi_re[i_plus1] * MUL_F(adj->S_M_boost[l][0], FRAC_CONST(0.00815)));
-                        if (sbr->M != 0) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_plus1] * MUL_F(adj->S_M_boost[l][1], FRAC_CONST(0.00815))); }
-                    }
-                    if ((m > 0) && (m < sbr->M - 1) && (sinusoids < 16) && (phi_re[i_min1] != 0)) {
-                        QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_min1] * MUL_F(adj->S_M_boost[l][m - 1], FRAC_CONST(0.00815)));
-                    }
-                    if ((m > 0) && (m < sbr->M - 1) && (sinusoids < 16) && (phi_re[i_plus1] != 0)) {
-                        QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_plus1] * MUL_F(adj->S_M_boost[l][m + 1], FRAC_CONST(0.00815)));
-                    }
-                    if ((m == sbr->M - 1) && (sinusoids < 16) && (phi_re[i_min1] != 0)) {
-                        if (m > 0) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_min1] * MUL_F(adj->S_M_boost[l][m - 1], FRAC_CONST(0.00815))); }
-                        if (m + sbr->kx < 64) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx + 1]) += (rev * phi_re[i_min1] * MUL_F(adj->S_M_boost[l][m], FRAC_CONST(0.00815))); }
-                    }
-        #else
-                    if ((m == 0) && (phi_re[i_plus1] != 0)) {
-                        QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx - 1]) += (rev * phi_re[i_plus1] * MUL_F((adj->S_M_boost[l][0] << REAL_BITS), FRAC_CONST(0.00815)));
-                        if (sbr->M != 0) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_plus1] * MUL_F((adj->S_M_boost[l][1] << REAL_BITS), FRAC_CONST(0.00815))); }
-                    }
-                    if ((m > 0) && (m < sbr->M - 1) && (sinusoids < 16) && (phi_re[i_min1] != 0)) {
-                        QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_min1] * MUL_F((adj->S_M_boost[l][m - 1] << REAL_BITS), FRAC_CONST(0.00815)));
-                    }
-                    if ((m > 0) && (m < sbr->M - 1) && (sinusoids < 16) && (phi_re[i_plus1] != 0)) {
-                        QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_plus1] * MUL_F((adj->S_M_boost[l][m + 1] << REAL_BITS), FRAC_CONST(0.00815)));
-                    }
-                    if ((m == sbr->M - 1) && (sinusoids < 16) && (phi_re[i_min1] != 0)) {
-                        if (m > 0) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_min1] * MUL_F((adj->S_M_boost[l][m - 1] << REAL_BITS), FRAC_CONST(0.00815))); }
-                        if (m + sbr->kx < 64) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx + 1]) += (rev * phi_re[i_min1] * MUL_F((adj->S_M_boost[l][m] << REAL_BITS), FRAC_CONST(0.00815))); }
-                    }
-        #endif
-                    if (adj->S_M_boost[l][m] != 0) sinusoids++;
+                        if ((m == 0) && (phi_re[i_plus1] != 0)) {
+                            QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx - 1]) += (rev * phi_re[i_plus1] * MUL_F((adj->S_M_boost[l][0] << REAL_BITS), FRAC_CONST(0.00815)));
+                            if (sbr->M != 0) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_plus1] * MUL_F((adj->S_M_boost[l][1] << REAL_BITS), FRAC_CONST(0.00815))); }
+                        }
+                        if ((m > 0) && (m < sbr->M - 1) && (sinusoids < 16) && (phi_re[i_min1] != 0)) {
+                            QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_min1] * MUL_F((adj->S_M_boost[l][m - 1] << REAL_BITS), FRAC_CONST(0.00815)));
+                        }
+                        if ((m > 0) && (m < sbr->M - 1) && (sinusoids < 16) && (phi_re[i_plus1] != 0)) {
+                            QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_plus1] * MUL_F((adj->S_M_boost[l][m + 1] << REAL_BITS), FRAC_CONST(0.00815)));
+                        }
+                        if ((m == sbr->M - 1) && (sinusoids < 16) && (phi_re[i_min1] != 0)) {
+                            if (m > 0) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx]) -= (rev * phi_re[i_min1] * MUL_F((adj->S_M_boost[l][m - 1] << REAL_BITS), FRAC_CONST(0.00815))); }
+                            if (m + sbr->kx < 64) { QMF_RE(Xsbr[i + sbr->tHFAdj][m + sbr->kx + 1]) += (rev * phi_re[i_min1] * MUL_F((adj->S_M_boost[l][m] << REAL_BITS), FRAC_CONST(0.00815))); }
+                        }
     #endif
+                        if (adj->S_M_boost[l][m] != 0) sinusoids++;
+                    }
                 }
             }
             fIndexSine = (fIndexSine + 1) & 3;
@@ -14207,14 +14238,14 @@ uint8_t NeaacDecoder::hf_adjustment(sbr_info* sbr, qmf_t Xsbr[MAX_NTSRHFG][64],
         goto exit;
     }
     calculate_gain(sbr, adj, ch);
-    #ifdef SBR_LOW_POWER
-    calc_gain_groups(sbr, adj, deg, ch);
-    aliasing_reduction(sbr, adj, deg, ch);
-    #endif
+    if (sbr->lowPower) {
+        calc_gain_groups(sbr, adj, deg, ch);
+        aliasing_reduction(sbr, adj, deg, ch);
+    }
     hf_assembly(sbr, adj, Xsbr, ch);
     ret = 0;
 exit:
-    if (adj) free(adj);
+    if (adj) faad_free(&adj);
     return ret;
 }
 #endif // SBR_DEC
@@ -14278,13 +14309,7 @@ uint8_t NeaacDecoder::estimate_current_envelope(sbr_info* sbr, sbr_hfadj_info* a
     #endif
                 }
                 sbr->E_curr[ch][m][l] = nrg / div;
-    #ifdef SBR_LOW_POWER
-        #ifdef FIXED_POINT
-                sbr->E_curr[ch][m][l] <<= 1;
-        #else
-                sbr->E_curr[ch][m][l] *= 2;
-        #endif
-    #endif
+                if (sbr->lowPower) sbr->E_curr[ch][m][l] *= 2; // real part only
             }
         }
     } else {
@@ -14318,13 +14343,7 @@ uint8_t NeaacDecoder::estimate_current_envelope(sbr_info* sbr, sbr_hfadj_info* a
                         }
                     }
                     sbr->E_curr[ch][k - sbr->kx][l] = nrg / div;
-    #ifdef SBR_LOW_POWER
-        #ifdef FIXED_POINT
-                    sbr->E_curr[ch][k - sbr->kx][l] <<= 1;
-        #else
-                    sbr->E_curr[ch][k - sbr->kx][l] *= 2;
-        #endif
-    #endif
+                    if (sbr->lowPower) sbr->E_curr[ch][k - sbr->kx][l] *= 2; // real part only
                 }
             }
         }
@@ -14588,14 +14607,11 @@ void NeaacDecoder::calculate_gain(sbr_info* sbr, sbr_hfadj_info* adj, uint8_t ch
             G_boost = min(G_boost, REAL_CONST(1.328771237) /* log2(1.584893192 ^ 2) */);
             for (m = ml1; m < ml2; m++) {
                     /* apply compensation to gain, noise floor sf's and sinusoid levels */
-        #ifndef SBR_LOW_POWER
-                adj->G_lim_boost[l][m] = pow2_fix((G_lim[m] + G_boost) >> 1);
-        #else
-                /* sqrt() will be done after the aliasing reduction to save a
-                 * few multiplies
-                 */
-                adj->G_lim_boost[l][m] = pow2_fix(G_lim[m] + G_boost);
-        #endif
+                if (!sbr->lowPower) {
+                    adj->G_lim_boost[l][m] = pow2_fix((G_lim[m] + G_boost) >> 1);
+                } else { // sqrt() will be done after the aliasing reduction to save a few multiplies
+                    adj->G_lim_boost[l][m] = pow2_fix(G_lim[m] + G_boost);
+                }
                 adj->Q_M_lim_boost[l][m] = pow2_fix((Q_M_lim[m] + G_boost) >> 1);
                 if (S_M[m] != LOG2_MIN_INF) {
                     adj->S_M_boost[l][m] = pow2_int((S_M[m] + G_boost) >> 1);
@@ -14605,9 +14621,9 @@ void NeaacDecoder::calculate_gain(sbr_info* sbr, sbr_hfadj_info* adj, uint8_t ch
             }
         }
     }
-    if (Q_M_lim) free(Q_M_lim);
-    if (G_lim) free(G_lim);
-    if (S_M) free(S_M);
+    if (Q_M_lim) faad_free(&Q_M_lim);
+    if (G_lim) faad_free(&G_lim);
+    if (S_M) faad_free(&S_M);
 }
     #endif // FIXED_POINT
 #endif     // SBR_DEC
@@ -14640,81 +14656,82 @@ void NeaacDecoder::hf_generation(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][64], qmf
     //    complex_t alpha_0[64], alpha_1[64];
     complex_t* alpha_0 = (complex_t*)faad_malloc(64 * sizeof(complex_t));
     complex_t* alpha_1 = (complex_t*)faad_malloc(64 * sizeof(complex_t));
-    #ifdef SBR_LOW_POWER
-    // real_t rxx[64];
-    real_t* rxx = faad_malloc(64 * sizeof(real_t));
-    #endif
-    uint8_t offset = sbr->tHFAdj;
-    uint8_t first = sbr->t_E[ch][0];
-    uint8_t last = sbr->t_E[ch][sbr->L_E[ch]];
+    real_t*    rxx = NULL; // low power only
+    uint8_t    offset = sbr->tHFAdj;
+    uint8_t    first = sbr->t_E[ch][0];
+    uint8_t    last = sbr->t_E[ch][sbr->L_E[ch]];
     calc_chirp_factors(sbr, ch);
-    #ifdef SBR_LOW_POWER
-    memset(deg, 0, 64 * sizeof(real_t));
-    #endif
+    if (sbr->lowPower) memset(deg, 0, 64 * sizeof(real_t));
     if ((ch == 0) && (sbr->Reset)) patch_construction(sbr);
     /* calculate the prediction coefficients */
-    #ifdef SBR_LOW_POWER
-    calc_prediction_coef_lp(sbr, Xlow, alpha_0, alpha_1, rxx);
-    calc_aliasing_degree(sbr, rxx, deg);
-    #endif
+    if (sbr->lowPower) {
+        rxx = (real_t*)faad_malloc(64 * sizeof(real_t));
+        calc_prediction_coef_lp(sbr, Xlow, alpha_0, alpha_1, rxx);
+        calc_aliasing_degree(sbr, rxx, deg);
+    }
     /* actual HF generation */
     for (i = 0; i < sbr->noPatches; i++) {
         for (x = 0; x < sbr->patchNoSubbands[i]; x++) {
-            real_t a0_r, a0_i, a1_r, a1_i;
-            (void)a0_i;
-            (void)a1_i;
+            real_t  a0_r, a0_i, a1_r, a1_i;
             real_t  bw, bw2;
             uint8_t q, p, k, g;
             /* find the low and high band for patching */
             k = sbr->kx + x;
             for (q = 0; q < i; q++) { k += sbr->patchNoSubbands[q]; }
             p = sbr->patchStartSubband[i] + x;
-    #ifdef SBR_LOW_POWER
-            if (x != 0 /*x < sbr->patchNoSubbands[i]-1*/)
-                deg[k] = deg[p];
-            else
-                deg[k] = 0;
-    #endif
+            if (sbr->lowPower) {
+                if (x != 0 /*x < sbr->patchNoSubbands[i]-1*/)
+                    deg[k] = deg[p];
+                else
+                    deg[k] = 0;
+            }
             g = sbr->table_map_k_to_g[k];
             bw = sbr->bwArray[ch][g];
             bw2 = MUL_C(bw, bw);
             /* do the patching */
             /* with or without filtering */
-            if (bw2 > 0) {
+            if (bw2 > 0 && sbr->lowPower) {
                 real_t temp1_r, temp2_r, temp3_r;
+                a0_r = MUL_C(RE(alpha_0[p]), bw);
+                a1_r = MUL_C(RE(alpha_1[p]), bw2);
+                temp2_r = QMF_RE(Xlow[first - 2 + offset][p]);
+                temp3_r = QMF_RE(Xlow[first - 1 + offset][p]);
+                for (l = first; l < last; l++) {
+                    temp1_r = temp2_r;
+                    temp2_r = temp3_r;
+                    temp3_r = QMF_RE(Xlow[l + offset][p]);
+                    QMF_RE(Xhigh[l + offset][k]) = temp3_r + (MUL_R(a0_r, temp2_r) + MUL_R(a1_r, temp1_r));
     #ifndef SBR_LOW_POWER
+                    QMF_IM(Xhigh[l + offset][k]) = 0;
+    #endif
+                }
+            }
+    #ifndef SBR_LOW_POWER
+            else if (bw2 > 0) {
+                real_t temp1_r, temp2_r, temp3_r;
                 real_t temp1_i, temp2_i, temp3_i;
                 calc_prediction_coef(sbr, Xlow, alpha_0, alpha_1, p);
-    #endif
                 a0_r = MUL_C(RE(alpha_0[p]), bw);
                 a1_r = MUL_C(RE(alpha_1[p]), bw2);
-    #ifndef SBR_LOW_POWER
                 a0_i = MUL_C(IM(alpha_0[p]), bw);
                 a1_i = MUL_C(IM(alpha_1[p]), bw2);
-    #endif
                 temp2_r = QMF_RE(Xlow[first - 2 + offset][p]);
                 temp3_r = QMF_RE(Xlow[first - 1 + offset][p]);
-    #ifndef SBR_LOW_POWER
                 temp2_i = QMF_IM(Xlow[first - 2 + offset][p]);
                 temp3_i = QMF_IM(Xlow[first - 1 + offset][p]);
-    #endif
                 for (l = first; l < last; l++) {
                     temp1_r = temp2_r;
                     temp2_r = temp3_r;
                     temp3_r = QMF_RE(Xlow[l + offset][p]);
-    #ifndef SBR_LOW_POWER
                     temp1_i = temp2_i;
                     temp2_i = temp3_i;
                     temp3_i = QMF_IM(Xlow[l + offset][p]);
-    #endif
-    #ifdef SBR_LOW_POWER
-                    QMF_RE(Xhigh[l + offset][k]) = temp3_r + (MUL_R(a0_r, temp2_r) + MUL_R(a1_r, temp1_r));
-    #else
                     QMF_RE(Xhigh[l + offset][k]) = temp3_r + (MUL_R(a0_r, temp2_r) - MUL_R(a0_i, temp2_i) + MUL_R(a1_r, temp1_r) - MUL_R(a1_i, temp1_i));
                     QMF_IM(Xhigh[l + offset][k]) = temp3_i + (MUL_R(a0_i, temp2_r) + MUL_R(a0_r, temp2_i) + MUL_R(a1_i, temp1_r) + MUL_R(a1_r, temp1_i));
-    #endif
                 }
-            } else {
+            }
+    #endif // SBR_LOW_POWER
+            else {
                 for (l = first; l < last; l++) {
                     QMF_RE(Xhigh[l + offset][k]) = QMF_RE(Xlow[l + offset][p]);
     #ifndef SBR_LOW_POWER
@@ -14727,28 +14744,25 @@ void NeaacDecoder::hf_generation(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][64], qmf
     if (sbr->Reset) { limiter_frequency_table(sbr); }
     faad_free(&alpha_0);
     faad_free(&alpha_1);
-    #ifdef SBR_LOW_POWER
-    faad_free(&rxx);
-    #endif
+    if (rxx) faad_free(&rxx);
 }
 #endif // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
-void NeaacDecoder::auto_correlation(sbr_info* sbr, acorr_coef* ac, qmf_t buffer[MAX_NTSRHFG][64], uint8_t bd, uint8_t len) {
+void NeaacDecoder::auto_correlation_lp(sbr_info* sbr, acorr_coef* ac, qmf_t buffer[MAX_NTSRHFG][64], uint8_t bd, uint8_t len) {
     real_t  r01 = 0, r02 = 0, r11 = 0;
     int8_t  j;
     uint8_t offset = sbr->tHFAdj;
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
     const real_t rel = FRAC_CONST(0.999999); // 1 / (1 + 1e-6f);
     uint32_t     maxi = 0;
     (void)maxi;
     uint32_t pow2, exp;
     (void)pow2;
-        #else
+    #else
     const real_t rel = 1 / (1 + 1e-6f);
-        #endif
-        #ifdef FIXED_POINT
+    #endif
+    #ifdef FIXED_POINT
     uint32_t mask = 0;
     for (j = (offset - 2); j < (len + offset); j++) {
         real_t x;
@@ -14771,7 +14785,7 @@ void NeaacDecoder::auto_correlation(sbr_info* sbr, acorr_coef* ac, qmf_t buffer[
                   MUL_R(((QMF_RE(buffer[offset - 1][bd]) + (1 << (exp - 1))) >> exp), ((QMF_RE(buffer[offset - 2][bd]) + (1 << (exp - 1))) >> exp));
     RE(ac->r22) = r11 - MUL_R(((QMF_RE(buffer[len + offset - 2][bd]) + (1 << (exp - 1))) >> exp), ((QMF_RE(buffer[len + offset - 2][bd]) + (1 << (exp - 1))) >> exp)) +
                   MUL_R(((QMF_RE(buffer[offset - 2][bd]) + (1 << (exp - 1))) >> exp), ((QMF_RE(buffer[offset - 2][bd]) + (1 << (exp - 1))) >> exp));
-        #else
+    #else
     for (j = offset; j < len + offset; j++) {
         r01 += QMF_RE(buffer[j][bd]) * QMF_RE(buffer[j - 1][bd]);
         r02 += QMF_RE(buffer[j][bd]) * QMF_RE(buffer[j - 2][bd]);
@@ -14779,13 +14793,12 @@ void NeaacDecoder::auto_correlation(sbr_info* sbr, acorr_coef* ac, qmf_t buffer[
     }
     RE(ac->r12) = r01 - QMF_RE(buffer[len + offset - 1][bd]) * QMF_RE(buffer[len + offset - 2][bd]) + QMF_RE(buffer[offset - 1][bd]) * QMF_RE(buffer[offset - 2][bd]);
     RE(ac->r22) = r11 - QMF_RE(buffer[len + offset - 2][bd]) * QMF_RE(buffer[len + offset - 2][bd]) + QMF_RE(buffer[offset - 2][bd]) * QMF_RE(buffer[offset - 2][bd]);
-        #endif
+    #endif
     RE(ac->r01) = r01;
     RE(ac->r02) = r02;
     RE(ac->r11) = r11;
     ac->det = MUL_R(RE(ac->r11), RE(ac->r22)) - MUL_F(MUL_R(RE(ac->r12), RE(ac->r12)), rel);
 }
-    #endif //  SBR_LOW_POWER
 #endif     // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
@@ -14948,13 +14961,12 @@ void NeaacDecoder::calc_prediction_coef(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][6
 #endif     // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
 void NeaacDecoder::calc_prediction_coef_lp(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][64], complex_t* alpha_0, complex_t* alpha_1, real_t* rxx) {
     uint8_t    k;
     real_t     tmp;
     acorr_coef ac;
     for (k = 1; k < sbr->f_master[0]; k++) {
-        auto_correlation(sbr, &ac, Xlow, k, sbr->numTimeSlotsRate + 6);
+        auto_correlation_lp(sbr, &ac, Xlow, k, sbr->numTimeSlotsRate + 6);
         if (ac.det == 0) {
             RE(alpha_0[k]) = 0;
             RE(alpha_1[k]) = 0;
@@ -14979,11 +14991,9 @@ void NeaacDecoder::calc_prediction_coef_lp(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG
         }
     }
 }
-    #endif // SBR_LOW_POWER
 #endif     // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
 void NeaacDecoder::calc_aliasing_degree(sbr_info* sbr, real_t* rxx, real_t* deg) {
     uint8_t k;
     rxx[0] = COEF_CONST(0.0);
@@ -15008,7 +15018,6 @@ void NeaacDecoder::calc_aliasing_degree(sbr_info* sbr, real_t* rxx, real_t* deg)
         }
     }
 }
-    #endif // SBR_LOW_POWER
 #endif     // SBR_DEC
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
@@ -15210,11 +15219,21 @@ qmfs_info* NeaacDecoder::qmfs_init(uint8_t channels) {
     memset(qmfs->v, 0, 2 * channels * 20 * sizeof(real_t));
     qmfs->v_index = 0;
     qmfs->channels = channels;
+    qmfs->lowPower = 0;
     return qmfs;
 }
 #endif /*SBR_DEC*/
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
+void NeaacDecoder::qmfs_set_mode(qmfs_info* qmfs, uint8_t lowPower) {
+    if (qmfs->lowPower == lowPower) return;
+    /* the real and the complex filterbank build different histories, restart from silence (~10 slots fade in) instead of a click */
+    memset(qmfs->v, 0, 2 * qmfs->channels * 20 * sizeof(real_t));
+    qmfs->lowPower = lowPower;
+}
+#endif /*SBR_DEC*/
+// ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+#ifdef SBR_DEC
 void NeaacDecoder::qmfs_end(qmfs_info* qmfs) {
     if (qmfs) {
         if (qmfs->v) faad_free(&qmfs->v);
@@ -15224,8 +15243,7 @@ void NeaacDecoder::qmfs_end(qmfs_info* qmfs) {
 #endif /*SBR_DEC*/
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
-void NeaacDecoder::sbr_qmf_synthesis_32(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output) {
+void NeaacDecoder::sbr_qmf_synthesis_32_lp(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output) {
     real_t  x[16];
     real_t  y[16];
     int32_t n, k, out = 0;
@@ -15237,13 +15255,13 @@ void NeaacDecoder::sbr_qmf_synthesis_32(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
         // memmove(qmfs->v + 64, qmfs->v, (640-64)*sizeof(real_t));
         /* calculate 64 samples */
         for (k = 0; k < 16; k++) {
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
             y[k] = (QMF_RE(X[l][k]) - QMF_RE(X[l][31 - k]));
             x[k] = (QMF_RE(X[l][k]) + QMF_RE(X[l][31 - k]));
-        #else
+    #else
             y[k] = (QMF_RE(X[l][k]) - QMF_RE(X[l][31 - k])) / 32.0;
             x[k] = (QMF_RE(X[l][k]) + QMF_RE(X[l][31 - k])) / 32.0;
-        #endif
+    #endif
         }
         /* even n samples */
         DCT2_16_unscaled(x, x);
@@ -15258,23 +15276,21 @@ void NeaacDecoder::sbr_qmf_synthesis_32(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
         for (n = 1; n < 16; n++) { qmfs->v[qmfs->v_index + 48 + n] = qmfs->v[qmfs->v_index + 640 + 48 + n] = -qmfs->v[qmfs->v_index + 48 - n]; }
         /* calculate 32 output samples and window */
         for (k = 0; k < 32; k++) {
-            output[out++] = MUL_F(qmfs->v[qmfs->v_index + k], qmf_c[2 * k]) + MUL_F(qmfs->v[qmfs->v_index + 96 + k], qmf_c[64 + 2 * k]) + MUL_F(qmfs->v[qmfs->v_index + 128 + k], qmf_c[128 + 2 * k]) +
-                            MUL_F(qmfs->v[qmfs->v_index + 224 + k], qmf_c[192 + 2 * k]) + MUL_F(qmfs->v[qmfs->v_index + 256 + k], qmf_c[256 + 2 * k]) +
-                            MUL_F(qmfs->v[qmfs->v_index + 352 + k], qmf_c[320 + 2 * k]) + MUL_F(qmfs->v[qmfs->v_index + 384 + k], qmf_c[384 + 2 * k]) +
-                            MUL_F(qmfs->v[qmfs->v_index + 480 + k], qmf_c[448 + 2 * k]) + MUL_F(qmfs->v[qmfs->v_index + 512 + k], qmf_c[512 + 2 * k]) +
-                            MUL_F(qmfs->v[qmfs->v_index + 608 + k], qmf_c[576 + 2 * k]);
+            output[out++] = MUL_F(qmfs->v[qmfs->v_index + k], qmf_c_even[k]) + MUL_F(qmfs->v[qmfs->v_index + 96 + k], qmf_c_even[32 + k]) + MUL_F(qmfs->v[qmfs->v_index + 128 + k], qmf_c_even[64 + k]) +
+                            MUL_F(qmfs->v[qmfs->v_index + 224 + k], qmf_c_even[96 + k]) + MUL_F(qmfs->v[qmfs->v_index + 256 + k], qmf_c_even[128 + k]) +
+                            MUL_F(qmfs->v[qmfs->v_index + 352 + k], qmf_c_even[160 + k]) + MUL_F(qmfs->v[qmfs->v_index + 384 + k], qmf_c_even[192 + k]) +
+                            MUL_F(qmfs->v[qmfs->v_index + 480 + k], qmf_c_even[224 + k]) + MUL_F(qmfs->v[qmfs->v_index + 512 + k], qmf_c_even[256 + k]) +
+                            MUL_F(qmfs->v[qmfs->v_index + 608 + k], qmf_c_even[288 + k]);
         }
         /* update the ringbuffer index */
         qmfs->v_index -= 64;
         if (qmfs->v_index < 0) qmfs->v_index = (640 - 64);
     }
 }
-    #endif /*SBR_LOW_POWER*/
 #endif     /*SBR_DEC*/
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
-void NeaacDecoder::sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output) {
+void NeaacDecoder::sbr_qmf_synthesis_64_lp(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output) {
     real_t  x[64];
     real_t  y[64];
     int32_t n, k, out = 0;
@@ -15286,13 +15302,13 @@ void NeaacDecoder::sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
         // memmove(qmfs->v + 128, qmfs->v, (1280-128)*sizeof(real_t));
         /* calculate 128 samples */
         for (k = 0; k < 32; k++) {
-        #ifdef FIXED_POINT
+    #ifdef FIXED_POINT
             y[k] = (QMF_RE(X[l][k]) - QMF_RE(X[l][63 - k]));
             x[k] = (QMF_RE(X[l][k]) + QMF_RE(X[l][63 - k]));
-        #else
+    #else
             y[k] = (QMF_RE(X[l][k]) - QMF_RE(X[l][63 - k])) / 32.0;
             x[k] = (QMF_RE(X[l][k]) + QMF_RE(X[l][63 - k])) / 32.0;
-        #endif
+    #endif
         }
         /* even n samples */
         DCT2_32_unscaled(x, x);
@@ -15318,12 +15334,16 @@ void NeaacDecoder::sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
         if (qmfs->v_index < 0) qmfs->v_index = (1280 - 128);
     }
 }
-    #endif /*SBR_LOW_POWER*/
 #endif     /*SBR_DEC*/
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifndef SBR_LOW_POWER
 void NeaacDecoder::sbr_qmf_synthesis_32(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output) {
+    qmfs_set_mode(qmfs, sbr->lowPower);
+    if (sbr->lowPower) { // real valued, no PS
+        sbr_qmf_synthesis_32_lp(sbr, qmfs, X, output);
+        return;
+    }
+    #ifndef SBR_LOW_POWER
     real_t x1[32], x2[32];
         #ifndef FIXED_POINT
     real_t scale = 1.f / 64.f;
@@ -15357,28 +15377,31 @@ void NeaacDecoder::sbr_qmf_synthesis_32(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
         }
         /* calculate 32 output samples and window */
         for (k = 0; k < 32; k++) {
-            output[out++] = MUL_F(qmfs->v[qmfs->v_index + k], qmf_c[2 * k]) + MUL_F(qmfs->v[qmfs->v_index + 96 + k], qmf_c[64 + 2 * k]) + MUL_F(qmfs->v[qmfs->v_index + 128 + k], qmf_c[128 + 2 * k]) +
-                            MUL_F(qmfs->v[qmfs->v_index + 224 + k], qmf_c[192 + 2 * k]) + MUL_F(qmfs->v[qmfs->v_index + 256 + k], qmf_c[256 + 2 * k]) +
-                            MUL_F(qmfs->v[qmfs->v_index + 352 + k], qmf_c[320 + 2 * k]) + MUL_F(qmfs->v[qmfs->v_index + 384 + k], qmf_c[384 + 2 * k]) +
-                            MUL_F(qmfs->v[qmfs->v_index + 480 + k], qmf_c[448 + 2 * k]) + MUL_F(qmfs->v[qmfs->v_index + 512 + k], qmf_c[512 + 2 * k]) +
-                            MUL_F(qmfs->v[qmfs->v_index + 608 + k], qmf_c[576 + 2 * k]);
+            output[out++] = MUL_F(qmfs->v[qmfs->v_index + k], qmf_c_even[k]) + MUL_F(qmfs->v[qmfs->v_index + 96 + k], qmf_c_even[32 + k]) + MUL_F(qmfs->v[qmfs->v_index + 128 + k], qmf_c_even[64 + k]) +
+                            MUL_F(qmfs->v[qmfs->v_index + 224 + k], qmf_c_even[96 + k]) + MUL_F(qmfs->v[qmfs->v_index + 256 + k], qmf_c_even[128 + k]) +
+                            MUL_F(qmfs->v[qmfs->v_index + 352 + k], qmf_c_even[160 + k]) + MUL_F(qmfs->v[qmfs->v_index + 384 + k], qmf_c_even[192 + k]) +
+                            MUL_F(qmfs->v[qmfs->v_index + 480 + k], qmf_c_even[224 + k]) + MUL_F(qmfs->v[qmfs->v_index + 512 + k], qmf_c_even[256 + k]) +
+                            MUL_F(qmfs->v[qmfs->v_index + 608 + k], qmf_c_even[288 + k]);
         }
         /* update ringbuffer index */
         qmfs->v_index -= 64;
         if (qmfs->v_index < 0) qmfs->v_index = (640 - 64);
     }
+    #endif // SBR_LOW_POWER
 }
-    #endif /*SBR_LOW_POWER*/
 #endif     /*SBR_DEC*/
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
-    #ifndef SBR_LOW_POWER
 void NeaacDecoder::sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output) {
+    qmfs_set_mode(qmfs, sbr->lowPower);
+    if (sbr->lowPower) {
+        sbr_qmf_synthesis_64_lp(sbr, qmfs, X, output);
+        return;
+    }
+    #ifndef SBR_LOW_POWER
         //    real_t x1[64], x2[64];
-        #ifndef SBR_LOW_POWER
     real_t in_real1[32], in_imag1[32], out_real1[32], out_imag1[32];
     real_t in_real2[32], in_imag2[32], out_real2[32], out_imag2[32];
-        #endif
     qmf_t*  pX;
     real_t *pring_buffer_1, *pring_buffer_3;
         //    real_t * ptemp_1, * ptemp_2;
@@ -15507,8 +15530,8 @@ void NeaacDecoder::sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[
         qmfs->v_index -= 128;
         if (qmfs->v_index < 0) qmfs->v_index = (1280 - 128);
     }
+    #endif // SBR_LOW_POWER
 }
-    #endif /*SBR_LOW_POWER*/
 #endif     /*SBR_DEC*/
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
@@ -15538,9 +15561,8 @@ void NeaacDecoder::sbr_qmf_analysis_32(sbr_info* sbr, qmfa_info* qmfa, const rea
     real_t u[64];
     #ifndef SBR_LOW_POWER
     real_t in_real[32], in_imag[32], out_real[32], out_imag[32];
-    #else
-    real_t y[32];
     #endif
+    real_t y[32];
     uint32_t in = 0;
     uint8_t  l;
     /* qmf subsample l */
@@ -15559,30 +15581,35 @@ void NeaacDecoder::sbr_qmf_analysis_32(sbr_info* sbr, qmfa_info* qmfa, const rea
         }
         /* window and summation to create array u */
         for (n = 0; n < 64; n++) {
-            u[n] = MUL_F(qmfa->x[qmfa->x_index + n], qmf_c[2 * n]) + MUL_F(qmfa->x[qmfa->x_index + n + 64], qmf_c[2 * (n + 64)]) + MUL_F(qmfa->x[qmfa->x_index + n + 128], qmf_c[2 * (n + 128)]) +
-                   MUL_F(qmfa->x[qmfa->x_index + n + 192], qmf_c[2 * (n + 192)]) + MUL_F(qmfa->x[qmfa->x_index + n + 256], qmf_c[2 * (n + 256)]);
+            u[n] = MUL_F(qmfa->x[qmfa->x_index + n], qmf_c_even[n]) + MUL_F(qmfa->x[qmfa->x_index + n + 64], qmf_c_even[n + 64]) + MUL_F(qmfa->x[qmfa->x_index + n + 128], qmf_c_even[n + 128]) +
+                   MUL_F(qmfa->x[qmfa->x_index + n + 192], qmf_c_even[n + 192]) + MUL_F(qmfa->x[qmfa->x_index + n + 256], qmf_c_even[n + 256]);
         }
         /* update ringbuffer index */
         qmfa->x_index -= 32;
         if (qmfa->x_index < 0) qmfa->x_index = (320 - 32);
         /* calculate 32 subband samples by introducing X */
-    #ifdef SBR_LOW_POWER
-        y[0] = u[48];
-        for (n = 1; n < 16; n++) y[n] = u[n + 48] + u[48 - n];
-        for (n = 16; n < 32; n++) y[n] = -u[n - 16] + u[48 - n];
-        DCT3_32_unscaled(u, y);
-        for (n = 0; n < 32; n++) {
-            if (n < kx) {
-        #ifdef FIXED_POINT
-                QMF_RE(X[l + offset][n]) = u[n] /*<< 1*/;
-        #else
-                QMF_RE(X[l + offset][n]) = 2. * u[n];
-        #endif
-            } else {
-                QMF_RE(X[l + offset][n]) = 0;
+        if (sbr->lowPower) { // real part only
+            y[0] = u[48];
+            for (n = 1; n < 16; n++) y[n] = u[n + 48] + u[48 - n];
+            for (n = 16; n < 32; n++) y[n] = -u[n - 16] + u[48 - n];
+            DCT3_32_unscaled(u, y);
+            for (n = 0; n < 32; n++) {
+                if (n < kx) {
+    #ifdef FIXED_POINT
+                    QMF_RE(X[l + offset][n]) = u[n] /*<< 1*/;
+    #else
+                    QMF_RE(X[l + offset][n]) = 2. * u[n];
+    #endif
+                } else {
+                    QMF_RE(X[l + offset][n]) = 0;
+                }
+    #ifndef SBR_LOW_POWER
+                QMF_IM(X[l + offset][n]) = 0;
+    #endif
             }
+            continue;
         }
-    #else
+    #ifndef SBR_LOW_POWER
         // Reordering of data moved from DCT_IV to here
         in_imag[31] = u[1];
         in_real[0] = u[0];
@@ -15625,7 +15652,7 @@ void NeaacDecoder::sbr_qmf_analysis_32(sbr_info* sbr, qmfa_info* qmfa, const rea
                 QMF_IM(X[l + offset][2 * n + 1]) = 0;
             }
         }
-    #endif
+    #endif // SBR_LOW_POWER
     }
 }
 #endif /*SBR_DEC*/
@@ -51,6 +51,7 @@ class NeaacDecoder {
     void*                    NeAACDecDecode2(NeAACDecHandle hpDecoder, NeAACDecFrameInfo* hInfo, uint8_t* buffer, uint32_t buffer_size, void** sample_buffer, uint32_t sample_buffer_size);
     const char*              NeAACDecGetErrorMessage(const uint8_t errcode);
     uint8_t                  get_sr_index(const uint32_t samplerate);
+    void                     NeAACDecSetDownmix(const Downmix& dmx) { m_downmix = dmx; } // > 2 channels with config.downMatrix
 
   private:
     uint32_t __r1 __attribute__((unused)) = 1;
@@ -71,11 +72,18 @@ class NeaacDecoder {
     ps_ptr<adts_header>m_adts;
     ps_ptr<bitfile>m_ld;
     ps_ptr<uint8_t>m_sample_buffer;
+    ps_ptr<real_t> m_dmxBuff;   // L and R of the downmix, 2 * frame_len
+    Downmix        m_downmix;
 	
 
     uint32_t ne_rng(uint32_t* __r1, uint32_t* __r2);
     uint32_t wl_min_lzc(uint32_t x);
     uint8_t m_initFlag = 0;
+    ps_ptr<uint8_t> m_pool;                            // faad_malloc(), AAC_POOL_SIZE bytes
+    uint32_t        m_poolUsed = 0;
+    uint32_t        m_poolSize[AAC_POOL_CLASSES] = {}; // block size per class
+    void*           m_poolFree[AAC_POOL_CLASSES] = {}; // free list per class
+    bool            m_poolInit = false;
 #ifdef FIXED_POINT
     int32_t log2_int(uint32_t val);
     int32_t log2_fix(uint32_t val);
@@ -146,6 +154,7 @@ class NeaacDecoder {
     real_t    find_log2_Q(sbr_info* sbr, uint8_t k, uint8_t l, uint8_t ch);
     real_t    find_log2_Qplus1(sbr_info* sbr, uint8_t k, uint8_t l, uint8_t ch);
     void      auto_correlation(sbr_info* sbr, acorr_coef* ac, qmf_t buffer[MAX_NTSRHFG][64], uint8_t bd, uint8_t len);
+    void      auto_correlation_lp(sbr_info* sbr, acorr_coef* ac, qmf_t buffer[MAX_NTSRHFG][64], uint8_t bd, uint8_t len);
     real_t    mapNewBw(uint8_t invf_mode, uint8_t invf_mode_prev);
     uint8_t   max_pred_sfb(const uint8_t sr_index);
     uint8_t   max_tns_sfb(const uint8_t sr_index, const uint8_t object_type, const uint8_t is_short);
@@ -356,22 +365,17 @@ class NeaacDecoder {
     uint8_t  derived_frequency_table(sbr_info* sbr, uint8_t bs_xover_band, uint8_t k2);
     void     limiter_frequency_table(sbr_info* sbr);
 #ifdef SBR_DEC
-    #ifdef SBR_LOW_POWER
     void calc_prediction_coef_lp(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][64], complex_t* alpha_0, complex_t* alpha_1, real_t* rxx);
     void calc_aliasing_degree(sbr_info* sbr, real_t* rxx, real_t* deg);
-    #else  // SBR_LOW_POWER
     void calc_prediction_coef(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][64], complex_t* alpha_0, complex_t* alpha_1, uint8_t k);
-    #endif // SBR_LOW_POWER
     void calc_chirp_factors(sbr_info* sbr, uint8_t ch);
     void patch_construction(sbr_info* sbr);
 #endif // SBR_DEC
 #ifdef SBR_DEC
     uint8_t estimate_current_envelope(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MAX_NTSRHFG][64], uint8_t ch);
     void    calculate_gain(sbr_info* sbr, sbr_hfadj_info* adj, uint8_t ch);
-    #ifdef SBR_LOW_POWER
     void calc_gain_groups(sbr_info* sbr, sbr_hfadj_info* adj, real_t* deg, uint8_t ch);
     void aliasing_reduction(sbr_info* sbr, sbr_hfadj_info* adj, real_t* deg, uint8_t ch);
-    #endif // SBR_LOW_POWER
     void hf_assembly(sbr_info* sbr, sbr_hfadj_info* adj, qmf_t Xsbr[MAX_NTSRHFG][64], uint8_t ch);
 #endif // SBR_DEC
     uint8_t    get_S_mapped(sbr_info* sbr, uint8_t ch, uint8_t l, uint8_t current_band);
@@ -382,6 +386,9 @@ class NeaacDecoder {
     void       sbr_qmf_analysis_32(sbr_info* sbr, qmfa_info* qmfa, const real_t* input, qmf_t X[MAX_NTSRHFG][64], uint8_t offset, uint8_t kx);
     void       sbr_qmf_synthesis_32(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output);
     void       sbr_qmf_synthesis_64(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output);
+    void       qmfs_set_mode(qmfs_info* qmfs, uint8_t lowPower);
+    void       sbr_qmf_synthesis_32_lp(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output);
+    void       sbr_qmf_synthesis_64_lp(sbr_info* sbr, qmfs_info* qmfs, qmf_t X[MAX_NTSRHFG][64], real_t* output);
     uint8_t    envelope_time_border_vector(sbr_info* sbr, uint8_t ch);
     void       noise_floor_time_border_vector(sbr_info* sbr, uint8_t ch);
     void       hf_generation(sbr_info* sbr, qmf_t Xlow[MAX_NTSRHFG][64], qmf_t Xhigh[MAX_NTSRHFG][64], real_t* deg, uint8_t ch);
@@ -4,18 +4,34 @@
 #define PREFER_POINTERS // Use if target platform has address generators with autoincrement
 // #define BIG_IQ_TABLE
 // #define USE_DOUBLE_PRECISION // use double precision
-// #define FIXED_POINT          // use fixed point reals, undefs MAIN_DEC and SSR_DEC
+// #define FIXED_POINT          // use fixed point reals, undefs MAIN_DEC and SSR_DEC, see AAC_FIXED_POINT
 // #define ERROR_RESILIENCE 2
 // #define MAIN_DEC // Allow decoding of MAIN profile AAC
 // #define SSR_DEC // Allow decoding of SSR profile AAC
 #define LTP_DEC // Allow decoding of LTP (Long Term Prediction) profile AAC
 #define LD_DEC  // Allow decoding of LD (Low Delay) profile AAC
 // #define DRM_SUPPORT // Allow decoding of Digital Radio Mondiale (DRM)
-#if (defined CONFIG_IDF_TARGET_ESP32S3 || defined CONFIG_IDF_TARGET_ESP32P4)
+#ifndef AAC_FIXED_POINT // opt-in build profile (-DAAC_FIXED_POINT=1), also enables SBR and PS on the plain ESP32, not yet measured on target
+    #define AAC_FIXED_POINT 0
+#endif
+#if AAC_FIXED_POINT // 16 bit output within +-22 LSB of the float build, ~84dB SNR (Miss-Marple.m4a, LC and LC+SBR upsampling)
+    #define FIXED_POINT
+#endif
+#if (defined CONFIG_IDF_TARGET_ESP32S3 || defined CONFIG_IDF_TARGET_ESP32P4 || AAC_FIXED_POINT)
     #define SBR_DEC // Allow decoding of SBR (Spectral Band Replication) profile AAC
     #define PS_DEC // Allow decoding of PS (Parametric Stereo) profile AAC
 #endif
-// #define SBR_LOW_POWER
+#ifndef AAC_POOL_SIZE // faad_malloc() pool per decoder, high water mark of a stereo stream, more goes to the heap
+    #if defined PS_DEC
+        #define AAC_POOL_SIZE (260 * 1024) // SBR ~200kB, PS ~55kB
+    #elif defined SBR_DEC
+        #define AAC_POOL_SIZE (204 * 1024)
+    #else
+        #define AAC_POOL_SIZE (100 * 1024)
+    #endif
+#endif
+#define AAC_POOL_CLASSES 48 // different block sizes
+// #define SBR_LOW_POWER // real valued qmf_t, low power SBR only and no PS, less RAM. Without it low power is selectable at runtime
 #define ALLOW_SMALL_FRAMELENGTH
 // #define LC_ONLY_DECODER // if you want a pure AAC LC decoder (independant of SBR_DEC and PS_DEC)
 //——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -297,8 +297,10 @@ typedef struct NeAACDecConfiguration
     unsigned long defSampleRate;
     unsigned char outputFormat;
     unsigned char downMatrix;
+    unsigned char upMatrix;    /* mono is delivered as L = R */
     unsigned char useOldADTSFormat;
     unsigned char dontUpSampleImplicitSBR;
+    unsigned char sbrLowPower; /* real valued SBR, can be changed between frames, not used for PS streams */
 } NeAACDecConfiguration, *NeAACDecConfigurationPtr;
 typedef struct
 {
@@ -410,6 +412,7 @@ typedef struct {
     real_t *v;
     int16_t v_index;
     uint8_t channels;
+    uint8_t lowPower; /* mode the history in v was built with */
 } qmfs_info;
 typedef struct{
     uint32_t sample_rate;
@@ -497,6 +500,7 @@ typedef struct{
     ps_info *ps;
     uint8_t ps_used;
     uint8_t psResetFlag;
+    uint8_t lowPower; /* real valued QMF and HF generation for this frame */
     /* to get it compiling */
     /* we'll see during the coding of all the tools, whether
        these are all used or not.
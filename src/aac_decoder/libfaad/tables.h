@@ -23629,6 +23629,62 @@ static const real_t qmf_c[640] = {
     FRAC_CONST(-0.00071577364744), FRAC_CONST(-0.00069416146273), FRAC_CONST(-0.00067776907764),        FRAC_CONST(-0.00065403333621), FRAC_CONST(-0.00063124935319), FRAC_CONST(-0.00061327473938),
     FRAC_CONST(-0.00058709304852), FRAC_CONST(-0.00056778025613), FRAC_CONST(-0.00054665656337),        FRAC_CONST(-0.00052265642972), FRAC_CONST(-0.00050407143497), FRAC_CONST(-0.00048937912498),
     FRAC_CONST(-0.00048752279712), FRAC_CONST(-0.00049475180896), FRAC_CONST(-0.00056176925738),        FRAC_CONST(-0.00055252865047)};
+// qmf_c_even[i] = qmf_c[2 * i], the 32 band analysis and synthesis windows with unit stride
+static const real_t qmf_c_even[320] = {
+    FRAC_CONST(0.0000000000000),    FRAC_CONST(-0.00056176925738),  FRAC_CONST(-0.00048752279712),  FRAC_CONST(-0.00050407143497),  FRAC_CONST(-0.00054665656337),  FRAC_CONST(-0.00058709304852),
+    FRAC_CONST(-0.00063124935319),  FRAC_CONST(-0.00067776907764),  FRAC_CONST(-0.00071577364744),  FRAC_CONST(-0.00074409418541),  FRAC_CONST(-0.0007681371927),   FRAC_CONST(-0.00078343322877),
+    FRAC_CONST(-0.000780366471),    FRAC_CONST(-0.0007757977331),   FRAC_CONST(-0.00075300014201),  FRAC_CONST(-0.00072153919876),  FRAC_CONST(-0.00066504150893),  FRAC_CONST(-0.0005946118933),
+    FRAC_CONST(-0.00051455722108),  FRAC_CONST(-0.00040951214522),  FRAC_CONST(-0.00028969811748),  FRAC_CONST(-0.00014463809349),  FRAC_CONST(1.349497418E-005),   FRAC_CONST(0.00020430170688),
+    FRAC_CONST(0.0004026540216),    FRAC_CONST(0.00062393761391),   FRAC_CONST(0.00086084433262),   FRAC_CONST(0.00112501551307),   FRAC_CONST(0.00139024948272),   FRAC_CONST(0.00168680832531),
+    FRAC_CONST(0.00198411407369),   FRAC_CONST(0.00230172547746),   FRAC_CONST(0.00262017586902),   FRAC_CONST(0.00294694477165),   FRAC_CONST(0.00327396134847),   FRAC_CONST(0.00360082681231),
+    FRAC_CONST(0.00392074323703),   FRAC_CONST(0.0042264269227),    FRAC_CONST(0.00452098527825),   FRAC_CONST(0.00479325608498),   FRAC_CONST(0.00503930226013),   FRAC_CONST(0.00524611661324),
+    FRAC_CONST(0.00541967759307),   FRAC_CONST(0.00554757145088),   FRAC_CONST(0.00562206432097),   FRAC_CONST(0.00563891995151),   FRAC_CONST(0.0055917128663),    FRAC_CONST(0.0054753783077),
+    FRAC_CONST(0.00527157587272),   FRAC_CONST(0.00498396877629),   FRAC_CONST(0.00460395301471),   FRAC_CONST(0.0041251642327),    FRAC_CONST(0.00354012465507),   FRAC_CONST(0.00284467578623),
+    FRAC_CONST(0.0020274176185),    FRAC_CONST(0.00109023290512),   FRAC_CONST(2.760451905E-005),   FRAC_CONST(-0.00115681355227),  FRAC_CONST(-0.00248267236449),  FRAC_CONST(-0.00394011240522),
+    FRAC_CONST(-0.00553372111088),  FRAC_CONST(-0.00726158168517),  FRAC_CONST(-0.00913253296085),  FRAC_CONST(-0.01113155480321),  FRAC_CONST(0.01327182200351),   FRAC_CONST(0.01554055533423),
+    FRAC_CONST(0.01794333813443),   FRAC_CONST(0.02045317933555),   FRAC_CONST(0.02306801692862),   FRAC_CONST(0.02578758475467),   FRAC_CONST(0.02860721736385),   FRAC_CONST(0.03150176087389),
+    FRAC_CONST(0.03446209487686),   FRAC_CONST(0.03748128504252),   FRAC_CONST(0.04053491705584),   FRAC_CONST(0.04360975421304),   FRAC_CONST(0.04668430272642),   FRAC_CONST(0.04973857556014),
+    FRAC_CONST(0.05276307465207),   FRAC_CONST(0.05571736482138),   FRAC_CONST(0.0585915683626),    FRAC_CONST(0.06134551717207),   FRAC_CONST(0.06397158980681),   FRAC_CONST(0.06643675122104),
+    FRAC_CONST(0.06870438283512),   FRAC_CONST(0.07076287107266),   FRAC_CONST(0.07256825833083),   FRAC_CONST(0.07410036424342),   FRAC_CONST(0.07531373362019),   FRAC_CONST(0.07619924793396),
+    FRAC_CONST(0.07670934904245),   FRAC_CONST(0.07682300113923),   FRAC_CONST(0.07650507183194),   FRAC_CONST(0.07573057565061),   FRAC_CONST(0.07446643947564),   FRAC_CONST(0.07267746427299),
+    FRAC_CONST(0.07035330735093),   FRAC_CONST(0.06745250215166),   FRAC_CONST(0.06394448059633),   FRAC_CONST(0.0598166570809),    FRAC_CONST(0.05504600343009),   FRAC_CONST(0.04959786763445),
+    FRAC_CONST(0.04347687821958),   FRAC_CONST(0.03664181168133),   FRAC_CONST(0.02908240060125),   FRAC_CONST(0.02079970728622),   FRAC_CONST(0.01176238327857),   FRAC_CONST(0.00197656014503),
+    FRAC_CONST(-0.00857117491366),  FRAC_CONST(-0.01988341292573),  FRAC_CONST(-0.03195312745332),  FRAC_CONST(-0.04478068215856),  FRAC_CONST(-0.05837053268336),  FRAC_CONST(-0.07269433008129),
+    FRAC_CONST(-0.08775475365593),  FRAC_CONST(-0.10353295311463),  FRAC_CONST(-0.120007798468),    FRAC_CONST(-0.13715517611934),  FRAC_CONST(-0.15496070710605),  FRAC_CONST(-0.17338081721706),
+    FRAC_CONST(-0.19239667457267),  FRAC_CONST(-0.21197358538056),  FRAC_CONST(-0.23206908706791),  FRAC_CONST(-0.25264803095722),  FRAC_CONST(-0.27366340405625),  FRAC_CONST(-0.29507167170646),
+    FRAC_CONST(-0.31682789136456),  FRAC_CONST(-0.33887226938665),  FRAC_CONST(0.36115899031355),   FRAC_CONST(0.38363500139043),   FRAC_CONST(0.40623176767625),   FRAC_CONST(0.42891199207373),
+    FRAC_CONST(0.45159965356824),   FRAC_CONST(0.47424532146115),   FRAC_CONST(0.49677082545707),   FRAC_CONST(0.51912349702391),   FRAC_CONST(0.54125534487322),   FRAC_CONST(0.5630789140137),
+    FRAC_CONST(0.58454032354679),   FRAC_CONST(0.6055783538918),    FRAC_CONST(0.62612426956055),   FRAC_CONST(0.64612696959461),   FRAC_CONST(0.66551398801627),   FRAC_CONST(0.68423532934598),
+    FRAC_CONST(0.70223887193539),   FRAC_CONST(0.71944626349561),   FRAC_CONST(0.73582117582769),   FRAC_CONST(0.75131374561237),   FRAC_CONST(0.76586748650939),   FRAC_CONST(0.77942875190216),
+    FRAC_CONST(0.79197358416424),   FRAC_CONST(0.80344857518505),   FRAC_CONST(0.81381912706217),   FRAC_CONST(0.82304198905409),   FRAC_CONST(0.8311038457152),    FRAC_CONST(0.83797173378865),
+    FRAC_CONST(0.84362382812005),   FRAC_CONST(0.84803157770763),   FRAC_CONST(0.85119715249343),   FRAC_CONST(0.85310209497017),   FRAC_CONST(0.85373856005937 /*max*/), FRAC_CONST(0.85310209497017),
+    FRAC_CONST(0.85119715249343),   FRAC_CONST(0.84803157770763),   FRAC_CONST(0.84362382812005),   FRAC_CONST(0.83797173378865),   FRAC_CONST(0.8311038457152),    FRAC_CONST(0.82304198905409),
+    FRAC_CONST(0.81381912706217),   FRAC_CONST(0.80344857518505),   FRAC_CONST(0.79197358416424),   FRAC_CONST(0.77942875190216),   FRAC_CONST(0.76586748650939),   FRAC_CONST(0.75131374561237),
+    FRAC_CONST(0.73582117582769),   FRAC_CONST(0.71944626349561),   FRAC_CONST(0.70223887193539),   FRAC_CONST(0.68423532934598),   FRAC_CONST(0.66551398801627),   FRAC_CONST(0.64612696959461),
+    FRAC_CONST(0.62612426956055),   FRAC_CONST(0.6055783538918),    FRAC_CONST(0.58454032354679),   FRAC_CONST(0.5630789140137),    FRAC_CONST(0.54125534487322),   FRAC_CONST(0.51912349702391),
+    FRAC_CONST(0.49677082545707),   FRAC_CONST(0.47424532146115),   FRAC_CONST(0.45159965356824),   FRAC_CONST(0.42891199207373),   FRAC_CONST(0.40623176767625),   FRAC_CONST(0.38363500139043),
+    FRAC_CONST(-0.36115899031355),  FRAC_CONST(-0.33887226938665),  FRAC_CONST(-0.31682789136456),  FRAC_CONST(-0.29507167170646),  FRAC_CONST(-0.27366340405625),  FRAC_CONST(-0.25264803095722),
+    FRAC_CONST(-0.23206908706791),  FRAC_CONST(-0.21197358538056),  FRAC_CONST(-0.19239667457267),  FRAC_CONST(-0.17338081721706),  FRAC_CONST(-0.15496070710605),  FRAC_CONST(-0.13715517611934),
+    FRAC_CONST(-0.120007798468),    FRAC_CONST(-0.10353295311463),  FRAC_CONST(-0.08775475365593),  FRAC_CONST(-0.07269433008129),  FRAC_CONST(-0.05837053268336),  FRAC_CONST(-0.04478068215856),
+    FRAC_CONST(-0.03195312745332),  FRAC_CONST(-0.01988341292573),  FRAC_CONST(-0.00857117491366),  FRAC_CONST(0.00197656014503),   FRAC_CONST(0.01176238327857),   FRAC_CONST(0.02079970728622),
+    FRAC_CONST(0.02908240060125),   FRAC_CONST(0.03664181168133),   FRAC_CONST(0.04347687821958),   FRAC_CONST(0.04959786763445),   FRAC_CONST(0.05504600343009),   FRAC_CONST(0.0598166570809),
+    FRAC_CONST(0.06394448059633),   FRAC_CONST(0.06745250215166),   FRAC_CONST(0.07035330735093),   FRAC_CONST(0.07267746427299),   FRAC_CONST(0.07446643947564),   FRAC_CONST(0.07573057565061),
+    FRAC_CONST(0.07650507183194),   FRAC_CONST(0.07682300113923),   FRAC_CONST(0.07670934904245),   FRAC_CONST(0.07619924793396),   FRAC_CONST(0.07531373362019),   FRAC_CONST(0.07410036424342),
+    FRAC_CONST(0.07256825833083),   FRAC_CONST(0.07076287107266),   FRAC_CONST(0.06870438283512),   FRAC_CONST(0.06643675122104),   FRAC_CONST(0.06397158980681),   FRAC_CONST(0.06134551717207),
+    FRAC_CONST(0.0585915683626),    FRAC_CONST(0.05571736482138),   FRAC_CONST(0.05276307465207),   FRAC_CONST(0.04973857556014),   FRAC_CONST(0.04668430272642),   FRAC_CONST(0.04360975421304),
+    FRAC_CONST(0.04053491705584),   FRAC_CONST(0.03748128504252),   FRAC_CONST(0.03446209487686),   FRAC_CONST(0.03150176087389),   FRAC_CONST(0.02860721736385),   FRAC_CONST(0.02578758475467),
+    FRAC_CONST(0.02306801692862),   FRAC_CONST(0.02045317933555),   FRAC_CONST(0.01794333813443),   FRAC_CONST(0.01554055533423),   FRAC_CONST(-0.01327182200351),  FRAC_CONST(-0.01113155480321),
+    FRAC_CONST(-0.00913253296085),  FRAC_CONST(-0.00726158168517),  FRAC_CONST(-0.00553372111088),  FRAC_CONST(-0.00394011240522),  FRAC_CONST(-0.00248267236449),  FRAC_CONST(-0.00115681355227),
+    FRAC_CONST(2.760451905E-005),   FRAC_CONST(0.00109023290512),   FRAC_CONST(0.0020274176185),    FRAC_CONST(0.00284467578623),   FRAC_CONST(0.00354012465507),   FRAC_CONST(0.0041251642327),
+    FRAC_CONST(0.00460395301471),   FRAC_CONST(0.00498396877629),   FRAC_CONST(0.00527157587272),   FRAC_CONST(0.0054753783077),    FRAC_CONST(0.0055917128663),    FRAC_CONST(0.00563891995151),
+    FRAC_CONST(0.00562206432097),   FRAC_CONST(0.00554757145088),   FRAC_CONST(0.00541967759307),   FRAC_CONST(0.00524611661324),   FRAC_CONST(0.00503930226013),   FRAC_CONST(0.00479325608498),
+    FRAC_CONST(0.00452098527825),   FRAC_CONST(0.0042264269227),    FRAC_CONST(0.00392074323703),   FRAC_CONST(0.00360082681231),   FRAC_CONST(0.00327396134847),   FRAC_CONST(0.00294694477165),
+    FRAC_CONST(0.00262017586902),   FRAC_CONST(0.00230172547746),   FRAC_CONST(0.00198411407369),   FRAC_CONST(0.00168680832531),   FRAC_CONST(0.00139024948272),   FRAC_CONST(0.00112501551307),
+    FRAC_CONST(0.00086084433262),   FRAC_CONST(0.00062393761391),   FRAC_CONST(0.0004026540216),    FRAC_CONST(0.00020430170688),   FRAC_CONST(1.349497418E-005),   FRAC_CONST(-0.00014463809349),
+    FRAC_CONST(-0.00028969811748),  FRAC_CONST(-0.00040951214522),  FRAC_CONST(-0.00051455722108),  FRAC_CONST(-0.0005946118933),   FRAC_CONST(-0.00066504150893),  FRAC_CONST(-0.00072153919876),
+    FRAC_CONST(-0.00075300014201),  FRAC_CONST(-0.0007757977331),   FRAC_CONST(-0.000780366471),    FRAC_CONST(-0.00078343322877),  FRAC_CONST(-0.0007681371927),   FRAC_CONST(-0.00074409418541),
+    FRAC_CONST(-0.00071577364744),  FRAC_CONST(-0.00067776907764),  FRAC_CONST(-0.00063124935319),  FRAC_CONST(-0.00058709304852),  FRAC_CONST(-0.00054665656337),  FRAC_CONST(-0.00050407143497),
+    FRAC_CONST(-0.00048752279712),  FRAC_CONST(-0.00056176925738)};
 // ——————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 #ifdef SBR_DEC
 __unused static const complex_t qmf32_pre_twiddle[] = {
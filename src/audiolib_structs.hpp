@@ -1,10 +1,17 @@
 #pragma once
 #include "psram_unique_ptr.hpp"
+#include <algorithm>
 #include <cstdint>
 #include <stddef.h>
 
 // this file contains definitions of various structs used in Audio lib
 
+#ifdef AUDIO_PCM_32BIT
+typedef int32_t audio_pcm_t; // left justified, up to 24 significant bits
+#else
+typedef int16_t audio_pcm_t;
+#endif
+
 namespace audiolib {
 struct sylt_t {
     size_t   size;
@@ -108,20 +115,30 @@ struct m4aHdr_t { // used in read_M4A_Header
     uint8_t  aac_profile;
     uint32_t stsz_num_entries;
     uint32_t stsz_table_pos;
+    uint32_t stsz_sample_size; // all samples have this size, no table
+    uint32_t stts_num_entries;
+    uint32_t stts_table_pos;
+    uint32_t stsc_num_entries;
+    uint32_t stsc_table_pos;
+    uint32_t stco_num_entries; // stco or co64
+    uint32_t stco_table_pos;
+    bool     co64;
+    bool     soundTrak;        // the current trak has a mp4a sample description, chapter and text traks are ignored
+    uint32_t sound_timescale;  // mdhd of the sound trak
     bool     progressive; // Progressive (moov before mdat)
     bool     version_flags;
 };
 
 struct plCh_t { // used in playChunk
-    int32_t   validSamples;
-    int32_t   samples48K = 0;
-    uint32_t  count = 0;
-    size_t    i2s_bytesConsumed;
-    int16_t*  sample[2];
-    int16_t*  s2;
-    int       sampleSize;
-    esp_err_t err;
-    int       i;
+    int32_t      validSamples;
+    int32_t      samples48K = 0;
+    uint32_t     count = 0;
+    size_t       i2s_bytesConsumed;
+    audio_pcm_t* sample[2];
+    audio_pcm_t* s2;
+    int          sampleSize;
+    esp_err_t    err;
+    int          i;
 };
 
 struct lVar_t { // used in loop
@@ -169,22 +186,81 @@ typedef struct _cat { // used in calculateAudioTime
     }
 } cat_t;
 
-struct cVUl_t { // used in computeVUlevel
-    uint8_t sampleArray[2][4][8] = {0};
-    uint8_t cnt0 = 0, cnt1 = 0, cnt2 = 0, cnt3 = 0, cnt4 = 0;
-    bool    f_vu = false;
-};
+typedef struct _cVUl { // used in computeVUlevel, block based level meter
+    float peak[2]{};      // linear, with ballistics
+    float ms[2]{};        // mean square, with ballistics
+    float hold[2]{};      // peak hold value
+    float holdTime[2]{};  // seconds since the hold value was set
+    float attack{0.010};  // seconds
+    float release{0.300}; // seconds
+    float peakHold{1.5};  // seconds
+
+    void reset() { // keeps the ballistics
+        for (int ch = 0; ch < 2; ch++) { peak[ch] = ms[ch] = hold[ch] = holdTime[ch] = 0; }
+    }
+} cVUl_t;
+
+typedef struct _rpGn { // used in setReplayGainTag, computeLimit
+    float trackGain{};  // dB, ReplayGain reference level (-18 LUFS)
+    float albumGain{};  // dB
+    float trackPeak{};  // 1.0 is full scale, 0 if unknown
+    float albumPeak{};  //
+    float outputGain{}; // dB, Opus header, always applied
+    float autoGain{};   // dB, set by computeLoudness
+    bool  f_trackGain{};
+    bool  f_albumGain{};
+
+    void reset() {
+        // Default-initialize alles neu (inklusive Array)
+        *this = _rpGn{};
+    }
+} rpGn_t;
+
+typedef struct _cLdn { // used in computeLoudness, EBU R128 short term loudness
+    uint32_t sampleRate{};
+    float    shelf[5]{};      // K-weighting stage 1, high shelf b0 b1 b2 a1 a2
+    float    hp[2]{};         // K-weighting stage 2, high pass a1 a2 (b = 1, -2, 1)
+    float    z[2][4]{};       // filter states per channel
+    float    blockSum{};      // sum of squares, current 100ms block
+    uint32_t blockCnt{};      // samples in the current block
+    uint32_t blockLen{};      // samples per 100ms
+    float    blocks[30]{};    // mean square of the last 30 blocks (3s)
+    uint8_t  blockIdx{};      //
+    uint8_t  blocksFilled{};  //
+    float    loudness{-70.0}; // LUFS
+
+    void reset() {
+        // Default-initialize alles neu (inklusive Array)
+        *this = _cLdn{};
+    }
+} cLdn_t;
+
+typedef struct _lmtr { // used in Limiter
+    uint32_t sampleRate{};
+    uint16_t len{};         // look-ahead in samples (delay line length)
+    uint16_t idx{};         // delay line read/write position
+    uint16_t holdCnt{};     // samples until the sample that set 'target' leaves the delay line
+    float    env{1.0};      // current gain reduction
+    float    target{1.0};   // lowest gain needed within the look-ahead window
+    float    pending{1.0};  // lowest gain needed by samples that arrived during the hold time
+    float    step{};        // attack, linear ramp per sample
+    float    release{};     // release coefficient
+
+    void reset() {
+        *this = _lmtr{};
+    }
+} lmtr_t;
 
 struct ifCh_t { // used in IIR_filterChain0, 1, 2
-    float   inSample0[2];
-    float   outSample0[2];
-    int16_t iir_out0[2];
-    float   inSample1[2];
-    float   outSample1[2];
-    int16_t iir_out1[2];
-    float   inSample2[2];
-    float   outSample2[2];
-    int16_t iir_out2[2];
+    float       inSample0[2];
+    float       outSample0[2];
+    audio_pcm_t iir_out0[2];
+    float       inSample1[2];
+    float       outSample1[2];
+    audio_pcm_t iir_out1[2];
+    float       inSample2[2];
+    float       outSample2[2];
+    audio_pcm_t iir_out2[2];
 };
 
 typedef struct _tspp { // used in ts_parsePacket
@@ -289,7 +365,12 @@ typedef struct _rflh { // used in read_FLAC_Header
     uint32_t              sampleRate{};
     uint32_t              maxFrameSize{};
     uint32_t              maxBlockSize{};
+    uint32_t              minBlockSize{};
     uint32_t              totalSamplesInStream{};
+    std::vector<std::pair<uint64_t, uint64_t>> seekTable{}; // SEEKTABLE: sample number, offset from the first frame header
+    uint32_t              seekPoints{}; // SEEKTABLE: points not read yet, the table may span several buffer fills
+    uint32_t              seekIdx{};
+    uint32_t              seekStep{};
 
     void reset() {
         // Default-initialize alles neu (inklusive Array)
@@ -297,6 +378,86 @@ typedef struct _rflh { // used in read_FLAC_Header
     }
 } rflh_t;
 
+typedef struct _mp3Toc { // used in read_ID3_Header (Xing/Info, VBRI), mp3_tocFilePos
+    std::vector<std::pair<uint32_t, uint32_t>> points{}; // frame number, offset from the first frame, ascending
+    uint32_t              frames{};
+    uint32_t              sampleRate{};
+    uint16_t              samplesPerFrame{};
+
+    void reset() {
+        // Default-initialize alles neu (inklusive Array)
+        *this = _mp3Toc{};
+    }
+} mp3Toc_t;
+
+typedef struct _mp3Idx { // used in mp3_indexFrame, mp3_scanTask, mp3_idxFilePos
+    static constexpr uint16_t step = 32; // frames from point to point, 32 * 1441 bytes fit in uint16_t
+    std::vector<uint16_t> delta{};       // byte distance from point k to point k + 1, point 0 is the first frame, 0: in wide
+    std::vector<std::pair<uint32_t, uint32_t>> wide{}; // k, distance: junk between the frames made it too large for delta
+    uint32_t              frames{};      // contiguous from the first frame on
+    uint32_t              bytes{};       // offset behind the last frame, from the first frame
+    uint32_t              lastPoint{};   // offset of the last point
+    uint32_t              sampleRate{};
+    uint16_t              samplesPerFrame{};
+    bool                  complete{};    // up to the end of the audio data (scan)
+
+    void addFrame(uint16_t len) {
+        if (frames && frames % step == 0) {
+            uint32_t d = bytes - lastPoint;
+            if (d > UINT16_MAX) {
+                wide.push_back({delta.size(), d});
+                d = 0;
+            }
+            delta.push_back(d);
+            lastPoint = bytes;
+        }
+        bytes += len;
+        frames++;
+    }
+    uint32_t offset(uint32_t k) const { // of point k from the first frame
+        uint32_t pos = 0;
+        auto     w = wide.begin();
+        for (uint32_t i = 0; i < k; i++) pos += delta[i] ? delta[i] : (w++)->second;
+        return pos;
+    }
+    void reset() {
+        // Default-initialize alles neu (inklusive Array)
+        *this = _mp3Idx{};
+    }
+} mp3Idx_t;
+
+typedef struct _m4aIdx { // used in m4a_buildIndex, m4a_idxFilePos
+    static constexpr uint16_t                  step = 32; // samples (AAC frames) from checkpoint to checkpoint
+    std::vector<std::pair<uint32_t, uint32_t>> base{};    // checkpoint, file position: every 64th checkpoint and where the delta does not fit
+    std::vector<uint16_t>                      delta{};   // file position of checkpoint k minus checkpoint k - 1, 0 at a base
+    std::vector<std::pair<uint32_t, uint32_t>> stts{};    // sample count, sample duration (timescale units)
+    uint32_t                                   samples{};
+    uint32_t                                   timescale{};
+    uint32_t                                   lastPos{};
+    bool                                       built{};   // tried, successful or not
+
+    void addPoint(uint32_t pos) {
+        uint32_t k = delta.size();
+        if (k % 64 == 0 || pos < lastPos || pos - lastPos > UINT16_MAX) {
+            base.push_back({k, pos});
+            delta.push_back(0);
+        } else {
+            delta.push_back(pos - lastPos);
+        }
+        lastPos = pos;
+    }
+    uint32_t filePos(uint32_t k) const { // nearest base before k plus max. 63 deltas
+        auto b = std::upper_bound(base.begin(), base.end(), k, [](uint32_t v, const std::pair<uint32_t, uint32_t>& e) { return v < e.first; }) - 1;
+        uint32_t pos = b->second;
+        for (uint32_t i = b->first + 1; i <= k; i++) pos += delta[i];
+        return pos;
+    }
+    void reset() {
+        // Default-initialize alles neu (inklusive Array)
+        *this = _m4aIdx{};
+    }
+} m4aIdx_t;
+
 typedef struct _phreh { // used in parseHttpResponseHeader
     uint32_t ctime{};
     uint32_t timeout{};
@@ -0,0 +1,63 @@
+/*
+ * downmix.cpp
+ *
+ * Created on: Oct 18,2026
+ *
+ */
+#include "downmix.h"
+
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Downmix::setDefaults() {
+    // ITU-R BS.775 3/2 -> 2/0: L = L + 0.707 C + 0.707 Ls, R = R + 0.707 C + 0.707 Rs, LFE is not part of the downmix.
+    // 6.1 / 7.1: the back channels are treated like the surrounds, the back centre goes to both sides (-6dB)
+    const float k = 0.70710678f;
+    for (uint8_t i = 0; i < DMX_POSITIONS; i++) m_coef[i][0] = m_coef[i][1] = 0;
+    m_coef[DMX_L][0] = 1;
+    m_coef[DMX_R][1] = 1;
+    m_coef[DMX_C][0] = m_coef[DMX_C][1] = k;
+    m_coef[DMX_LS][0] = k;
+    m_coef[DMX_RS][1] = k;
+    m_coef[DMX_LB][0] = k;
+    m_coef[DMX_RB][1] = k;
+    m_coef[DMX_CB][0] = m_coef[DMX_CB][1] = 0.5f;
+    calcGains();
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool Downmix::setCoefficient(uint8_t pos, float left, float right) {
+    if (pos >= DMX_POSITIONS || !isfinite(left) || !isfinite(right)) return false;
+    m_coef[pos][0] = std::clamp(left, -4.0f, 4.0f);
+    m_coef[pos][1] = std::clamp(right, -4.0f, 4.0f);
+    calcGains();
+    return true;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool Downmix::setLayout(uint8_t channels, const uint8_t* pos) {
+    if (channels > DMX_MAX_CHANNELS) return false;
+    bool changed = channels != m_channels;
+    for (uint8_t ch = 0; ch < channels; ch++) {
+        changed |= m_pos[ch] != pos[ch];
+        m_pos[ch] = pos[ch];
+    }
+    m_channels = channels;
+    if (changed) calcGains(); // once per stream, the decoders set the layout with every frame
+    return true;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Downmix::calcGains() {
+    // gains of the decoded channels from their positions, scaled down as a whole if the sum of L or R exceeds 1
+    float sumL = 0, sumR = 0;
+    for (uint8_t ch = 0; ch < m_channels; ch++) {
+        const uint8_t p = m_pos[ch];
+        m_gain[ch][0] = (p < DMX_POSITIONS) ? m_coef[p][0] : 0;
+        m_gain[ch][1] = (p < DMX_POSITIONS) ? m_coef[p][1] : 0;
+        sumL += fabsf(m_gain[ch][0]);
+        sumR += fabsf(m_gain[ch][1]);
+    }
+    const float scale = 1.0f / std::max({sumL, sumR, 1.0f});
+    for (uint8_t ch = 0; ch < m_channels; ch++) {
+        for (uint8_t i = 0; i < 2; i++) {
+            m_gain[ch][i] *= scale;
+            m_q15[ch][i] = lrintf(m_gain[ch][i] * 32768.0f);
+        }
+    }
+}
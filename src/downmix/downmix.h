@@ -0,0 +1,83 @@
+/*
+ * downmix.h
+ *
+ * Created on: Oct 18,2026
+ *
+ * multichannel -> stereo matrix for the decoders (AAC, FLAC, Vorbis), 3 ... 8 channels
+ * defaults after ITU-R BS.775 (3/2 -> 2/0): centre and surrounds -3dB, LFE dropped, every coefficient can be overridden
+ * the decoders call process() on their deinterleaved channel buffers, block by block, before the PCM output pass
+ *
+ */
+#pragma once
+#pragma GCC optimize("Ofast")
+
+#include <algorithm>
+#include <math.h>
+#include <stdint.h>
+#include <type_traits>
+
+class Downmix {
+
+public:
+    enum : uint8_t { DMX_L, DMX_R, DMX_C, DMX_LFE, DMX_LS, DMX_RS, DMX_LB, DMX_RB, DMX_CB, DMX_POSITIONS }; // speaker positions
+    static constexpr uint8_t DMX_MAX_CHANNELS = 8;
+    static constexpr uint8_t DMX_SILENT = DMX_POSITIONS; // unknown position, not mixed
+
+    Downmix() { setDefaults(); }
+    void    setDefaults();                                           // ITU-R BS.775
+    bool    setCoefficient(uint8_t pos, float left, float right);    // linear gain of a speaker position in L and R
+    void    setLfe(float gain) { setCoefficient(DMX_LFE, gain, gain); } // 0: LFE dropped (BS.775)
+    bool    setLayout(uint8_t channels, const uint8_t* pos);         // speaker position of each decoded channel
+    uint8_t getChannels() { return m_channels; }                     // of the layout, 0: not set
+
+    // L/R = sum over the channels of gain * in[ch], in place (outL == in[0]) is allowed. Integer samples with Q15 gains,
+    // the gains are scaled down if L or R could exceed full scale, so the result needs no clipping
+    template <typename T> void process(const T* const* in, uint32_t n, T* outL, T* outR, uint8_t stride = 1) const {
+        using acc_t = std::conditional_t<std::is_floating_point_v<T>, float, std::conditional_t<sizeof(T) == 2, int32_t, int64_t>>;
+        acc_t accL[DMX_BLOCK];
+        acc_t accR[DMX_BLOCK];
+        for (uint32_t i0 = 0; i0 < n; i0 += DMX_BLOCK) {
+            uint32_t len = std::min<uint32_t>(DMX_BLOCK, n - i0);
+            for (uint32_t j = 0; j < len; j++) accL[j] = accR[j] = 0;
+            for (uint8_t ch = 0; ch < m_channels; ch++) {
+                const T* x = in[ch] + i0;
+                if constexpr (std::is_floating_point_v<T>) {
+                    const float gl = m_gain[ch][0], gr = m_gain[ch][1];
+                    if (gl == 0 && gr == 0) continue;
+                    for (uint32_t j = 0; j < len; j++) {
+                        accL[j] += gl * x[j];
+                        accR[j] += gr * x[j];
+                    }
+                } else {
+                    const int32_t gl = m_q15[ch][0], gr = m_q15[ch][1];
+                    if (gl == 0 && gr == 0) continue;
+                    for (uint32_t j = 0; j < len; j++) {
+                        accL[j] += (acc_t)gl * x[j];
+                        accR[j] += (acc_t)gr * x[j];
+                    }
+                }
+            }
+            T* l = outL + i0 * stride;
+            T* r = outR + i0 * stride;
+            for (uint32_t j = 0; j < len; j++) {
+                if constexpr (std::is_floating_point_v<T>) {
+                    l[j * stride] = accL[j];
+                    r[j * stride] = accR[j];
+                } else {
+                    l[j * stride] = (T)((accL[j] + (1 << 14)) >> 15);
+                    r[j * stride] = (T)((accR[j] + (1 << 14)) >> 15);
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr uint8_t DMX_BLOCK = 64; // samples per block, the accumulators stay on the stack
+
+    float   m_coef[DMX_POSITIONS][2];         // per speaker position, setCoefficient()
+    float   m_gain[DMX_MAX_CHANNELS][2];      // per decoded channel, normalized
+    int32_t m_q15[DMX_MAX_CHANNELS][2];       // m_gain in Q15
+    uint8_t m_pos[DMX_MAX_CHANNELS] = {};     // layout
+    uint8_t m_channels = 0;
+    void    calcGains();
+};
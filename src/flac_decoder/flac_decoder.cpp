@@ -28,6 +28,9 @@ bool FlacDecoder::init() {
     clear();
     setDefaults();
     m_flacPageNr = 0;
+    m_stats = {};
+    m_f_crcCheck = flacCrcCheck(); // per stream
+    m_downmix = downmix();
     m_valid = true;
     return true;
 }
@@ -36,9 +39,7 @@ void FlacDecoder::clear() {
     FLACFrameHeader.zero_mem();
     FLACMetadataBlock.zero_mem();
 
-    m_samplesBuffer[0].clear();
-    m_samplesBuffer[1].clear();
-    coefs.clear();
+    for (auto& b : m_samplesBuffer) b.clear();
     m_flacSegmTableVec.clear();
     m_flacStatus = DECODE_FRAME;
     return;
@@ -50,16 +51,14 @@ void FlacDecoder::reset() {
     m_flacStreamTitle.reset();
     m_flacVendorString.reset();
 
-    m_samplesBuffer[0].reset();
-    m_samplesBuffer[1].reset();
-    coefs.clear();
+    for (auto& b : m_samplesBuffer) b.reset();
+    workerStop();
     m_flacSegmTableVec.clear();
     m_flacBlockPicItem.clear();
     m_valid = false;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void FlacDecoder::setDefaults() {
-    coefs.clear();
     m_flacSegmTableVec.clear();
     m_flacBlockPicItem.clear();
     m_flac_bitBuffer = 0;
@@ -86,6 +85,9 @@ void FlacDecoder::setDefaults() {
     m_f_flacParseOgg = false;
     m_f_bitReaderError = false;
     m_nBytes = 0;
+    m_oggFrameLen = 0;
+    m_f_oggDeframed = false;
+    m_f_oggContinued = false;
 }
 bool FlacDecoder::isValid() {
     return m_valid;
@@ -94,46 +96,43 @@ bool FlacDecoder::isValid() {
 //            B I T R E A D E R
 //----------------------------------------------------------------------------------------------------------------------
 
-uint32_t FlacDecoder::readUint(uint8_t nBits, int32_t* bytesLeft) {
-
-    const uint32_t mask[33] = {0x00000000, 0x00000001, 0x00000003, 0x00000007, 0x0000000f, 0x0000001f, 0x0000003f, 0x0000007f, 0x000000ff, 0x000001ff, 0x000003ff,
-                               0x000007ff, 0x00000fff, 0x00001fff, 0x00003fff, 0x00007fff, 0x0000ffff, 0x0001ffff, 0x0003ffff, 0x0007ffff, 0x000fffff, 0x001fffff,
-                               0x003fffff, 0x007fffff, 0x00ffffff, 0x01ffffff, 0x03ffffff, 0x07ffffff, 0x0fffffff, 0x1fffffff, 0x3fffffff, 0x7fffffff, 0xffffffff};
-
-    while (m_flacBitBufferLen < nBits) {
-        uint8_t temp = *(m_flacInptr + m_rIndex);
+void FlacDecoder::refillBitBuffer(int32_t* bytesLeft) {
+    // the cache is left aligned, the next bit is bit 63, whole bytes are added until 56...64 bits are valid
+    // fast path: one unaligned 64 bit big endian load, the bits below the valid ones are the following stream bytes,
+    // loading them again in the next refill doesn't change them (OR of the same data)
+    const uint8_t* p = m_flacInptr + m_rIndex;
+    if (*bytesLeft >= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        w = __builtin_bswap64(w);
+        uint8_t n = (64 - m_flacBitBufferLen) >> 3; // whole bytes that fit
+        m_flac_bitBuffer |= w >> m_flacBitBufferLen;
+        m_flacBitBufferLen += n * 8;
+        m_rIndex += n;
+        *bytesLeft -= n;
+        return;
+    }
+    while (m_flacBitBufferLen <= 56 && *bytesLeft > 0) { // end of the input, byte by byte
+        m_flac_bitBuffer |= (uint64_t)*p++ << (56 - m_flacBitBufferLen);
+        m_flacBitBufferLen += 8;
         m_rIndex++;
         (*bytesLeft)--;
-        if (*bytesLeft == -1) {
-            if (m_f_oggWrapper) {
-                m_rIndex--;
-                (*bytesLeft)++;
-                // If the Flac frame is larger than the OGG frame, we are looking for the OGG's identifier
-                if (specialIndexOf(m_flacInptr + m_rIndex, "OggS", 4) == 0) { // next OGG recognized
-                    parseOGG(m_flacInptr + m_rIndex, bytesLeft);              // parse OGG an set segment tables, bytesLeft is now negative
-                    m_segmLength = m_flacSegmTableVec.back();                 // read the first table
-                    m_flacSegmTableVec.pop_back();                            // and remove them
-                    m_f_flacParseOgg = false;                                 // no next OGG parse necessary
-                    m_rIndex += abs(*bytesLeft);                              // increase m_rIndex
-                    continue;                                                 // go ahead
-                } else {
-                    FLAC_LOG_ERROR("error in bitreader");
-                    m_f_bitReaderError = true;
-                    break;
-                }
-            }
-        }
-        m_flac_bitBuffer = (m_flac_bitBuffer << 8) | temp;
-        m_flacBitBufferLen += 8;
     }
-    m_flacBitBufferLen -= nBits;
-    uint32_t result = m_flac_bitBuffer >> m_flacBitBufferLen;
-    if (nBits < 32) result &= mask[nBits];
-    return result;
 }
-
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void FlacDecoder::bitReaderGiveBack(int32_t* bytesLeft) {
+    // whole bytes in the cache are not consumed, they are returned before the decoder gives control back to the caller
+    uint8_t n = m_flacBitBufferLen >> 3;
+    m_rIndex -= n;
+    *bytesLeft += n;
+    m_flacBitBufferLen &= 7;
+    m_flac_bitBuffer = m_flacBitBufferLen ? m_flac_bitBuffer & (~0ULL << (64 - m_flacBitBufferLen)) : 0;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void FlacDecoder::alignToByte() {
-    m_flacBitBufferLen -= m_flacBitBufferLen % 8;
+    uint8_t r = m_flacBitBufferLen & 7; // the cache holds whole bytes only, the remainder is the rest of the current byte
+    m_flac_bitBuffer <<= r;
+    m_flacBitBufferLen -= r;
 }
 //----------------------------------------------------------------------------------------------------------------------
 //              F L A C - D E C O D E R
@@ -167,7 +166,11 @@ int32_t FlacDecoder::findSyncWord(uint8_t* buf, int32_t nBytes) {
         /* find byte-aligned sync code - need 14 matching bits */
         for (i = 0; i < nBytes - 1; i++) {
             if ((buf[i + 0] & 0xFF) == 0xFF && (buf[i + 1] & 0xFC) == 0xF8) { // <14> Sync code '11111111111110xx'
-                if (i) decoderReset();
+                if (m_f_crcCheck && frameHeaderSample(buf + i, nBytes - i, 0, 0) < 0) continue; // false sync, header CRC-8
+                if (i) {
+                    decoderReset();
+                    m_stats.resyncs++;
+                }
                 //    m_f_bitReaderError = false;
                 return i;
             }
@@ -260,6 +263,8 @@ int32_t FlacDecoder::parseOGG(uint8_t* inbuf, int32_t* bytesLeft) { // reference
     }
     // for(int32_t i = 0; i< m_flacSegmTableVec.size(); i++){FLAC_LOG_INFO("%i", m_flacSegmTableVec[i]);}
 
+    m_f_oggContinued = pageSegments && *(inbuf + 27 + pageSegments - 1) == 255; // the last packet continues on the next page
+
     bool continuedPage = headerType & 0x01; // set: page contains data of a packet continued from the previous page
     bool firstPage = headerType & 0x02;     // set: this is the first page of a logical bitstream (bos)
     bool lastPage = headerType & 0x04;      // set: this is the last page of a logical bitstream (eos)
@@ -278,6 +283,72 @@ int32_t FlacDecoder::parseOGG(uint8_t* inbuf, int32_t* bytesLeft) { // reference
     return FLAC_NONE; // no error
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int32_t FlacDecoder::oggDeframe(uint8_t* inbuf, int32_t* bytesLeft) {
+    // the frame starting at inbuf continues on the following page(s), its parts are collected into a contiguous buffer,
+    // the bit reader never sees a page header. Nothing is consumed until all pages are in the input buffer
+    uint32_t segmLen = m_flacSegmTableVec.back();
+    int32_t  pos = segmLen;
+    int32_t  lastPage = 0;
+    uint32_t frameLen = segmLen;
+    bool     continued = true;
+    while (continued) {
+        if (pos + 27 > *bytesLeft) return FLAC_DECODE_FRAMES_LOOP; // need more data
+        if (specialIndexOf(inbuf + pos, "OggS", 6) != 0) {
+            FLAC_LOG_ERROR("Flac decoder asyncron, \"OggS\" not found");
+            return FLAC_ERR;
+        }
+        uint8_t pageSegments = *(inbuf + pos + 26);
+        if (pos + 27 + pageSegments > *bytesLeft) return FLAC_DECODE_FRAMES_LOOP;
+        uint32_t partLen = 0;
+        continued = true;
+        for (int i = 0; i < pageSegments; i++) { // the first lacing values < 255 ends the packet
+            partLen += *(inbuf + pos + 27 + i);
+            if (*(inbuf + pos + 27 + i) < 255) {
+                continued = false;
+                break;
+            }
+        }
+        if (pos + 27 + pageSegments + (int32_t)partLen > *bytesLeft) return FLAC_DECODE_FRAMES_LOOP;
+        lastPage = pos;
+        pos += 27 + pageSegments + partLen;
+        frameLen += partLen;
+    }
+
+    if (m_oggFrame.size() < frameLen + 8) { // + 8, the bit reader loads 64 bit words
+        if (!m_oggFrame.alloc(frameLen + 8, "m_oggFrame")) {
+            FLAC_LOG_ERROR("out of memory");
+            return FLAC_ERR;
+        }
+    }
+    memcpy(m_oggFrame.get(), inbuf, segmLen);
+    uint32_t n = segmLen;
+    for (int32_t p = segmLen; p <= lastPage;) { // second pass, copy the parts
+        uint8_t  pageSegments = *(inbuf + p + 26);
+        uint32_t partLen = 0;
+        for (int i = 0; i < pageSegments; i++) {
+            partLen += *(inbuf + p + 27 + i);
+            if (*(inbuf + p + 27 + i) < 255) break;
+        }
+        memcpy(m_oggFrame.get() + n, inbuf + p + 27 + pageSegments, partLen);
+        n += partLen;
+        p += 27 + pageSegments + partLen;
+    }
+
+    // segment table of the last page, its first entry is the tail of this frame
+    int32_t  bl = *bytesLeft - lastPage;
+    uint32_t filePos = m_flacCurrentFilePos;
+    if (parseOGG(inbuf + lastPage, &bl) != FLAC_NONE) return FLAC_ERR;
+    m_flacCurrentFilePos = filePos + pos;
+    *bytesLeft -= pos;
+    m_flacSegmTableVec.pop_back();
+    if (m_flacSegmTableVec.empty()) m_f_flacParseOgg = true;
+
+    m_oggFrameLen = frameLen;
+    m_nBytes = frameLen;
+    m_f_oggDeframed = true;
+    return FLAC_PARSE_OGG_DONE;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 std::vector<uint32_t> FlacDecoder::getMetadataBlockPicture() {
     if (m_f_flacNewMetadataBlockPicture) {
         m_f_flacNewMetadataBlockPicture = false;
@@ -473,6 +544,16 @@ int32_t FlacDecoder::parseMetaDataBlockHeader(uint8_t* inbuf, int16_t nBytes) {
                         vb[6].assign((const char*)(inbuf + pos + 4 + 12), min((uint32_t)127, commemtStringLength - 12));
                         FLAC_LOG_VERBOSE("TRACKNUMBER: %s", vb[6].c_get());
                     }
+                    if ((commemtStringLength > 11 && strncasecmp((const char*)inbuf + pos + 4, "REPLAYGAIN_", 11) == 0) ||
+                        (commemtStringLength > 5 && strncasecmp((const char*)inbuf + pos + 4, "R128_", 5) == 0)) {
+                        ps_ptr<char> rg;
+                        rg.assign((const char*)(inbuf + pos + 4), min((uint32_t)63, commemtStringLength));
+                        int eq = rg.index_of("=");
+                        if (eq > 0) {
+                            rg[eq] = '\0'; // key '\0' value
+                            setReplayGainTag(rg.get(), rg.get() + eq + 1);
+                        }
+                    }
                     if ((specialIndexOf(inbuf + pos + 4, "METADATA_BLOCK_PICTURE", 23) == 0) || (specialIndexOf(inbuf + pos + 4, "metadata_block_picture", 23) == 0)) {
                         FLAC_LOG_VERBOSE("METADATA_BLOCK_PICTURE found, commemtStringLength %i", commemtStringLength);
                         m_flacBlockPicLen = commemtStringLength - 23;
@@ -517,7 +598,19 @@ int32_t FlacDecoder::parseMetaDataBlockHeader(uint8_t* inbuf, int16_t nBytes) {
     return 0;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-int32_t FlacDecoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf) { //  MAIN LOOP
+int32_t FlacDecoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf) { // 16 bit output, more than 16 bps are truncated
+    return decodeFlac(inbuf, bytesLeft, outbuf);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool FlacDecoder::hasPCM32Output() {
+    return true;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int32_t FlacDecoder::decode32(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf) { // 32 bit output, left justified
+    return decodeFlac(inbuf, bytesLeft, outbuf);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+template <typename T> int32_t FlacDecoder::decodeFlac(uint8_t* inbuf, int32_t* bytesLeft, T* outbuf) { //  MAIN LOOP
 
     int32_t  ret = 0;
     uint32_t segmLen = 0;
@@ -550,13 +643,20 @@ int32_t FlacDecoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf)
         }
 
         if (m_nBytes > 0) {
-            int16_t diff = m_nBytes;
+            int32_t diff = m_nBytes;
             if (m_flacAudioDataStart == 0) { m_flacAudioDataStart = m_flacCurrentFilePos; }
-            ret = decodeNative(inbuf, &m_nBytes, outbuf);
-            diff -= m_nBytes;
-            m_flacCurrentFilePos += diff;
-            *bytesLeft -= diff;
-            if (m_nBytes < 0) m_nBytes = 0; // When the FLAC frame is larger than the OGG frame m_nbytes becomes negative
+            if (m_f_oggDeframed) { // frame collected from more than one page, the input is already consumed
+                ret = decodeNative(m_oggFrame.get() + m_oggFrameLen - m_nBytes, &m_nBytes, outbuf);
+            } else {
+                ret = decodeNative(inbuf, &m_nBytes, outbuf);
+                diff -= m_nBytes;
+                m_flacCurrentFilePos += diff;
+                *bytesLeft -= diff;
+            }
+            if (m_nBytes <= 0) {
+                m_nBytes = 0;
+                m_f_oggDeframed = false;
+            }
             return ret;
         }
         if (m_nBytes < 0) {
@@ -622,6 +722,11 @@ int32_t FlacDecoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf)
                 if (m_f_lastMetaDataBlock) m_flacPageNr = 2;
                 break;
             case 2:
+                if (m_flacSegmTableVec.empty() && m_f_oggContinued) { // the frame continues on the next page
+                    m_flacSegmTableVec.push_back(segmLen);            // undo, if the next page is not yet in the buffer
+                    m_f_flacParseOgg = false;
+                    return oggDeframe(inbuf, bytesLeft);
+                }
                 m_nBytes = segmLen;
                 return FLAC_PARSE_OGG_DONE;
                 break;
@@ -638,19 +743,22 @@ int32_t FlacDecoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf)
     return ret;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-int8_t FlacDecoder::decodeNative(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf) {
+template <typename T> int8_t FlacDecoder::decodeNative(uint8_t* inbuf, int32_t* bytesLeft, T* outbuf) {
 
     int32_t        bl = *bytesLeft;
     static int32_t sbl = 0;
 
     if (m_flacStatus != OUT_SAMPLES) {
         m_rIndex = 0;
+        m_crcIdx = 0;
         m_flacInptr = inbuf;
     }
 
     while (m_flacStatus == DECODE_FRAME) { // Read a ton of header fields, and ignore most of them
         int32_t ret = decodeFrame(inbuf, bytesLeft);
         if (ret != 0) return ret;
+        bitReaderGiveBack(bytesLeft);
+        if (m_f_crcCheck) crc16Update();
         if (*bytesLeft < FLAC_MAX_BLOCKSIZE) return FLAC_DECODE_FRAMES_LOOP; // need more data
         sbl += bl - *bytesLeft;
     }
@@ -658,7 +766,23 @@ int8_t FlacDecoder::decodeNative(uint8_t* inbuf, int32_t* bytesLeft, int16_t* ou
     if (m_flacStatus == DECODE_SUBFRAMES) {
         // Decode each channel's subframe, then skip footer
         int32_t ret = decodeSubframes(bytesLeft);
-        if (ret != 0) return ret;
+        if (ret != 0) {
+            m_stats.corruptFrames++;
+            m_flacStatus = DECODE_FRAME;
+            return ret;
+        }
+        alignToByte(); // footer, verified before any sample is written
+        bitReaderGiveBack(bytesLeft);
+        if (m_f_crcCheck) crc16Update();
+        uint16_t crc = readUint(16, bytesLeft);
+        bitReaderGiveBack(bytesLeft);
+        if (m_f_crcCheck && crc != m_crc16) {
+            FLAC_LOG_DEBUG("Flac frame CRC-16 error");
+            m_stats.corruptFrames++;
+            m_flacStatus = DECODE_FRAME;
+            return FLAC_ERR;
+        }
+        m_stats.decodedFrames++;
         m_flacStatus = OUT_SAMPLES;
         sbl += bl - *bytesLeft;
     }
@@ -675,37 +799,44 @@ int8_t FlacDecoder::decodeNative(uint8_t* inbuf, int32_t* bytesLeft, int16_t* ou
             m_flacValidSamples = blockSize;
         }
 
+        const uint8_t bps = FLACMetadataBlock->bitsPerSample;
+        auto          toPCM = [bps](int32_t val) -> T {
+            if constexpr (sizeof(T) == sizeof(int32_t)) {
+                return val << (32 - bps); // left justified
+            } else {
+                if (bps == 8) return val + 128;
+                if (bps > 16) return val >> (bps - 16);
+                return val;
+            }
+        };
+
         if (FLACMetadataBlock->numChannels == 1) {
             const int32_t* src = m_samplesBuffer[0].get() + m_offset;
-            int16_t*       dst = outbuf;
+            T*             dst = outbuf;
 
-            for (int32_t i = 0; i < blockSize; i++) {
-                int32_t val = *src++;
-                if (FLACMetadataBlock->bitsPerSample == 8) { val += 128; }
-                *dst++ = val;
-            }
+            for (int32_t i = 0; i < blockSize; i++) { *dst++ = toPCM(*src++); }
+        }
+
+        if (FLACMetadataBlock->numChannels > 2) { // mixed in place into the buffers of channel 0 and 1, out as stereo
+            const int32_t* in[FLAC_MAX_CHANNELS];
+            for (uint8_t ch = 0; ch < FLACMetadataBlock->numChannels; ch++) in[ch] = m_samplesBuffer[ch].get() + m_offset;
+            m_downmix.process(in, blockSize, m_samplesBuffer[0].get() + m_offset, m_samplesBuffer[1].get() + m_offset);
         }
 
-        if (FLACMetadataBlock->numChannels == 2) {
+        if (FLACMetadataBlock->numChannels >= 2) {
             const int32_t* left = m_samplesBuffer[0].get() + m_offset;
             const int32_t* right = m_samplesBuffer[1].get() + m_offset;
-            int16_t*       dst = outbuf;
+            T*             dst = outbuf;
 
             for (int32_t i = 0; i < blockSize; i++) {
-                int32_t l = *left++;
-                int32_t r = *right++;
-                if (FLACMetadataBlock->bitsPerSample == 8) {
-                    l += 128;
-                    r += 128;
-                }
-                *dst++ = l;
-                *dst++ = r;
+                *dst++ = toPCM(*left++);
+                *dst++ = toPCM(*right++);
             }
         }
 
         m_offset += blockSize;
         if (sbl > 0) {
-            m_flacCompressionRatio = (float)((m_flacValidSamples * 2) * FLACMetadataBlock->numChannels) / sbl; // valid samples are 16 bit
+            m_flacCompressionRatio = (float)(m_flacValidSamples * FLACMetadataBlock->numChannels * bps) / 8 / sbl;
             sbl = 0;
             m_flacBitrate = FLACMetadataBlock->sampleRate * FLACMetadataBlock->bitsPerSample * FLACMetadataBlock->numChannels;
             m_flacBitrate /= m_flacCompressionRatio;
@@ -717,14 +848,103 @@ int8_t FlacDecoder::decodeNative(uint8_t* inbuf, int32_t* bytesLeft, int16_t* ou
         m_offset = 0;
     }
 
-    alignToByte();
-    readUint(16, bytesLeft);
     //    m_flacCompressionRatio = (float)m_bytesDecoded / (float)s_numOfOutSamples * FLACMetadataBlock->numChannels * (16/8);
     //    FLAC_LOG_INFO("s_flacCompressionRatio % f", m_flacCompressionRatio);
     m_flacStatus = DECODE_FRAME;
     return FLAC_NONE;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+// CRC tables for slicing-by-4, [k][b]: CRC of byte b followed by k zero bytes
+typedef struct _crcTables {
+    uint8_t  t8[4][256];  // CRC-8, polynomial x^8 + x^2 + x^1 + x^0, frame header
+    uint16_t t16[4][256]; // CRC-16, polynomial x^16 + x^15 + x^2 + x^0, whole frame
+} crcTables_t;
+
+static constexpr crcTables_t makeCrcTables() {
+    crcTables_t t{};
+    for (int b = 0; b < 256; b++) {
+        uint8_t  c8 = b;
+        uint16_t c16 = b << 8;
+        for (int i = 0; i < 8; i++) {
+            c8 = (c8 & 0x80) ? (c8 << 1) ^ 0x07 : c8 << 1;
+            c16 = (c16 & 0x8000) ? (c16 << 1) ^ 0x8005 : c16 << 1;
+        }
+        t.t8[0][b] = c8;
+        t.t16[0][b] = c16;
+    }
+    for (int k = 1; k < 4; k++) {
+        for (int b = 0; b < 256; b++) {
+            t.t8[k][b] = t.t8[0][t.t8[k - 1][b]];
+            t.t16[k][b] = (t.t16[k - 1][b] << 8) ^ t.t16[0][t.t16[k - 1][b] >> 8];
+        }
+    }
+    return t;
+}
+static constexpr crcTables_t crcTab = makeCrcTables();
+
+uint8_t FlacDecoder::crc8(const uint8_t* data, int32_t len) {
+    uint8_t crc = 0;
+    for (; len >= 4; len -= 4, data += 4) { crc = crcTab.t8[3][crc ^ data[0]] ^ crcTab.t8[2][data[1]] ^ crcTab.t8[1][data[2]] ^ crcTab.t8[0][data[3]]; }
+    while (len-- > 0) crc = crcTab.t8[0][crc ^ *data++];
+    return crc;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+uint16_t FlacDecoder::crc16(uint16_t crc, const uint8_t* data, int32_t len) {
+    for (; len >= 4; len -= 4, data += 4) {
+        crc = crcTab.t16[3][(crc >> 8) ^ data[0]] ^ crcTab.t16[2][(crc & 0xFF) ^ data[1]] ^ crcTab.t16[1][data[2]] ^ crcTab.t16[0][data[3]];
+    }
+    while (len-- > 0) crc = (crc << 8) ^ crcTab.t16[0][(crc >> 8) ^ *data++];
+    return crc;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void FlacDecoder::crc16Update() { // the consumed bytes since the last call, the bit reader cache must not hold whole bytes
+    m_crc16 = crc16(m_crc16, m_flacInptr + m_crcIdx, m_rIndex - m_crcIdx);
+    m_crcIdx = m_rIndex;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int64_t FlacDecoder::frameHeaderSample(const uint8_t* p, int32_t len, uint16_t fixedBlockSize, uint16_t maxBlockSize) {
+    // parses a frame header at p, returns the number of its first sample or -1 if there is no valid header (CRC-8 included)
+    // fixedBlockSize: blocksize of a fixed blocksize stream (STREAMINFO), the header contains the frame number then
+    if (len < 6) return -1;
+    if (p[0] != 0xFF || (p[1] & 0xFE) != 0xF8) return -1; // sync code + reserved bit
+    bool    variable = p[1] & 0x01;
+    uint8_t bsCode = p[2] >> 4;
+    uint8_t srCode = p[2] & 0x0F;
+    uint8_t chAsgn = p[3] >> 4;
+    uint8_t ssCode = (p[3] >> 1) & 0x07;
+    if (bsCode == 0 || srCode == 15 || chAsgn > 10 || ssCode == 3 || (p[3] & 0x01)) return -1; // reserved values
+
+    int32_t  pos = 4;
+    uint8_t  ones = __builtin_clz(~((uint32_t)p[pos] << 24)); // UTF-8 like coded frame or sample number, 1...7 bytes
+    if (ones == 1 || ones > 7) return -1;
+    uint8_t  extra = ones ? ones - 1 : 0;
+    uint64_t num = p[pos] & (0x7F >> ones);
+    pos++;
+    if (pos + extra + 5 > len) return -1; // + blocksize, samplerate, CRC-8
+    for (int i = 0; i < extra; i++) {
+        if ((p[pos] & 0xC0) != 0x80) return -1;
+        num = (num << 6) | (p[pos++] & 0x3F);
+    }
+
+    uint32_t blockSize = 0;
+    if (bsCode == 1) blockSize = 192;
+    else if (bsCode <= 5) blockSize = 576 << (bsCode - 2);
+    else if (bsCode == 6) blockSize = p[pos++] + 1;
+    else if (bsCode == 7) {
+        blockSize = ((p[pos] << 8) | p[pos + 1]) + 1;
+        pos += 2;
+    }
+    else blockSize = 256 << (bsCode - 8);
+    if (maxBlockSize && blockSize > maxBlockSize) return -1;
+    if (srCode == 12) pos += 1;
+    else if (srCode == 13 || srCode == 14) pos += 2;
+    if (pos >= len) return -1;
+    if (crc8(p, pos) != p[pos]) return -1;
+
+    if (variable) return num;
+    return num * (fixedBlockSize ? fixedBlockSize : blockSize);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 int8_t FlacDecoder::decodeFrame(uint8_t* inbuf, int32_t* bytesLeft) {
     if (specialIndexOf(inbuf, "OggS", *bytesLeft) == 0) { // async? => new sync is OggS => reset and decode (not page 0 or 1)
         decoderReset();
@@ -738,7 +958,9 @@ int8_t FlacDecoder::decodeFrame(uint8_t* inbuf, int32_t* bytesLeft) {
 
     m_rIndex = 0;
     m_flac_bitBuffer = 0;
-    coefs.clear();
+    m_flacBitBufferLen = 0;
+    m_crc16 = 0;
+    m_crcIdx = 0;
 
     readUint(14 + 1, bytesLeft); // synccode + reserved bit
     FLACFrameHeader->blockingStrategy = readUint(1, bytesLeft);
@@ -747,8 +969,7 @@ int8_t FlacDecoder::decodeFrame(uint8_t* inbuf, int32_t* bytesLeft) {
     FLACFrameHeader->chanAsgn = readUint(4, bytesLeft);
     FLACFrameHeader->sampleSizeCode = readUint(3, bytesLeft);
     if (!FLACMetadataBlock->numChannels) {
-        if (FLACFrameHeader->chanAsgn == 0) FLACMetadataBlock->numChannels = 1;
-        if (FLACFrameHeader->chanAsgn == 1) FLACMetadataBlock->numChannels = 2;
+        if (FLACFrameHeader->chanAsgn <= 7) FLACMetadataBlock->numChannels = FLACFrameHeader->chanAsgn + 1;
         if (FLACFrameHeader->chanAsgn > 7) FLACMetadataBlock->numChannels = 2;
     }
     if (FLACMetadataBlock->numChannels < 1) {
@@ -762,8 +983,8 @@ int8_t FlacDecoder::decodeFrame(uint8_t* inbuf, int32_t* bytesLeft) {
         if (FLACFrameHeader->sampleSizeCode == 5) FLACMetadataBlock->bitsPerSample = 20;
         if (FLACFrameHeader->sampleSizeCode == 6) FLACMetadataBlock->bitsPerSample = 24;
     }
-    if (FLACMetadataBlock->bitsPerSample > 16) {
-        FLAC_LOG_ERROR("Flac, bits per sample > 16, bps: %i", FLACMetadataBlock->bitsPerSample);
+    if (FLACMetadataBlock->bitsPerSample > 24) {
+        FLAC_LOG_ERROR("Flac, bits per sample > 24, bps: %i", FLACMetadataBlock->bitsPerSample);
         return FLAC_STOP;
     }
     if (FLACMetadataBlock->bitsPerSample < 8) {
@@ -816,9 +1037,20 @@ int8_t FlacDecoder::decodeFrame(uint8_t* inbuf, int32_t* bytesLeft) {
     if (FLACFrameHeader->sampleRateCode == 12)
         readUint(8, bytesLeft);
     else if (FLACFrameHeader->sampleRateCode == 13 || FLACFrameHeader->sampleRateCode == 14) { readUint(16, bytesLeft); }
-    readUint(8, bytesLeft);
+    uint16_t headerLen = m_rIndex - (m_flacBitBufferLen >> 3); // the header is byte aligned at its CRC-8
+    uint8_t  crc = readUint(8, bytesLeft);
+    if (m_f_crcCheck && crc8(inbuf, headerLen) != crc) { // false sync or corrupt header, nothing is consumed
+        FLAC_LOG_DEBUG("Flac frame header CRC-8 error");
+        m_stats.corruptFrames++;
+        *bytesLeft += m_rIndex;
+        m_rIndex = 0;
+        m_flac_bitBuffer = 0;
+        m_flacBitBufferLen = 0;
+        return FLAC_ERR;
+    }
 
-    for (int32_t i = 0; i < FLAC_MAX_CHANNELS; i++) {
+    const uint8_t numCh = std::clamp<uint8_t>(FLACMetadataBlock->numChannels, 2, FLAC_MAX_CHANNELS);
+    for (int32_t i = 0; i < numCh; i++) {
         if (m_samplesBuffer[i].size() == m_numOfOutSamples) continue;
         m_samplesBuffer[i].calloc_array(m_numOfOutSamples);
         if (!m_samplesBuffer[i].valid()) { // ps_ptr<T> should overload operator bool()
@@ -829,6 +1061,17 @@ int8_t FlacDecoder::decodeFrame(uint8_t* inbuf, int32_t* bytesLeft) {
         }
     }
 
+    if (FLACMetadataBlock->numChannels > 2) { // WAVEFORMATEXTENSIBLE order, the back pair of 4.0 ... 5.1 are the surrounds
+        static const uint8_t layout[6][FLAC_MAX_CHANNELS] = {
+            {Downmix::DMX_L, Downmix::DMX_R, Downmix::DMX_C},
+            {Downmix::DMX_L, Downmix::DMX_R, Downmix::DMX_LS, Downmix::DMX_RS},
+            {Downmix::DMX_L, Downmix::DMX_R, Downmix::DMX_C, Downmix::DMX_LS, Downmix::DMX_RS},
+            {Downmix::DMX_L, Downmix::DMX_R, Downmix::DMX_C, Downmix::DMX_LFE, Downmix::DMX_LS, Downmix::DMX_RS},
+            {Downmix::DMX_L, Downmix::DMX_R, Downmix::DMX_C, Downmix::DMX_LFE, Downmix::DMX_CB, Downmix::DMX_LS, Downmix::DMX_RS},
+            {Downmix::DMX_L, Downmix::DMX_R, Downmix::DMX_C, Downmix::DMX_LFE, Downmix::DMX_LB, Downmix::DMX_RB, Downmix::DMX_LS, Downmix::DMX_RS}};
+        m_downmix.setLayout(numCh, layout[numCh - 3]);
+    }
+
     m_flacStatus = DECODE_SUBFRAMES;
     return FLAC_NONE;
 }
@@ -850,7 +1093,7 @@ uint8_t FlacDecoder::getBitsPerSample() {
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 uint8_t FlacDecoder::getChannels() {
     if (!FLACMetadataBlock) return 0;
-    return FLACMetadataBlock->numChannels;
+    return std::min<uint8_t>(FLACMetadataBlock->numChannels, 2); // more are mixed down
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 uint32_t FlacDecoder::getSampleRate() {
@@ -883,45 +1126,70 @@ int32_t FlacDecoder::val2() {
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 int8_t FlacDecoder::decodeSubframes(int32_t* bytesLeft) {
+    // the subframes must be parsed one after the other (there is no length field), but the prediction of channel 0
+    // can be restored on the other core while channel 1 is parsed (setDualCoreDecoding)
 
-    if (FLACFrameHeader->chanAsgn <= 7) {
-        for (int32_t ch = 0; ch < FLACMetadataBlock->numChannels; ch++) decodeSubframe(FLACMetadataBlock->bitsPerSample, ch, bytesLeft);
-    } else if (8 <= FLACFrameHeader->chanAsgn && FLACFrameHeader->chanAsgn <= 10) {
-        decodeSubframe(FLACMetadataBlock->bitsPerSample + (FLACFrameHeader->chanAsgn == 9 ? 1 : 0), 0, bytesLeft);
-        decodeSubframe(FLACMetadataBlock->bitsPerSample + (FLACFrameHeader->chanAsgn == 9 ? 0 : 1), 1, bytesLeft);
-
-        int32_t*      ch0 = m_samplesBuffer[0].get();
-        int32_t*      ch1 = m_samplesBuffer[1].get();
-        const int32_t n = m_numOfOutSamples;
+    int8_t  ret = FLAC_NONE;
+    uint8_t chAsgn = FLACFrameHeader->chanAsgn;
+    if (chAsgn > 10) {
+        FLAC_LOG_ERROR("Flac reserved channel assignment, %i", chAsgn);
+        return FLAC_ERR;
+    }
+    uint8_t numCh = (chAsgn <= 7) ? FLACMetadataBlock->numChannels : 2;
+    bool    parallel = numCh == 2 && dualCoreDecoding() && workerStart("FlacWorker", [this] { restoreChannel(0); });
+    bool    dispatched = false;
+
+    for (uint8_t ch = 0; ch < numCh; ch++) {
+        uint8_t sampleDepth = FLACMetadataBlock->bitsPerSample;
+        if (chAsgn == 8 || chAsgn == 10) sampleDepth += ch; // side channel is one bit wider
+        if (chAsgn == 9) sampleDepth += 1 - ch;
+        ret = decodeSubframe(sampleDepth, ch, bytesLeft);
+        if (ret) break;
+        if (ch == 0 && parallel) {
+            workerRun(); // restoreChannel(0) on the other core
+            dispatched = true;
+        } else {
+            restoreChannel(ch);
+        }
+    }
+    if (dispatched) workerJoin();
+    if (ret) return ret;
 
-        switch (FLACFrameHeader->chanAsgn) { // 8, 9 or 10
-            case 8:                          // left + side → right
-                for (int32_t i = 0; i < n; i++) ch1[i] = ch0[i] - ch1[i];
-                break;
+    int32_t*      ch0 = m_samplesBuffer[0].get();
+    int32_t*      ch1 = m_samplesBuffer[1].get();
+    const int32_t n = m_numOfOutSamples;
 
-            case 9: // right + side → left
-                for (int32_t i = 0; i < n; i++) ch0[i] += ch1[i];
-                break;
+    switch (chAsgn) { // 8, 9 or 10
+        case 8:       // left + side → right
+            for (int32_t i = 0; i < n; i++) ch1[i] = ch0[i] - ch1[i];
+            break;
 
-            case 10: // mid + side → left/right
-                for (int32_t i = 0; i < n; i++) {
-                    int32_t s = ch1[i];
-                    int32_t r = ch0[i] - (s >> 1);
-                    ch1[i] = r;
-                    ch0[i] = r + s;
-                }
-                break;
+        case 9: // right + side → left
+            for (int32_t i = 0; i < n; i++) ch0[i] += ch1[i];
+            break;
 
-            default: break;
-        }
+        case 10: // mid + side → left/right
+            for (int32_t i = 0; i < n; i++) {
+                int32_t s = ch1[i];
+                int32_t r = ch0[i] - (s >> 1);
+                ch1[i] = r;
+                ch0[i] = r + s;
+            }
+            break;
 
-    } else {
-        FLAC_LOG_ERROR("Flac reserved channel assignment, %i", FLACFrameHeader->chanAsgn);
-        return FLAC_ERR;
+        default: break; // independent channels
     }
     return FLAC_NONE;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void FlacDecoder::restoreChannel(uint8_t ch) {
+    if (m_pred[ch].type == PRED_FIXED) restoreFixedPrediction(ch);
+    if (m_pred[ch].type == PRED_LPC) restoreLinearPrediction(ch);
+    if (m_pred[ch].wasted) {
+        for (int32_t i = 0; i < m_numOfOutSamples; i++) { m_samplesBuffer[ch][i] <<= m_pred[ch].wasted; }
+    }
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 int8_t FlacDecoder::decodeSubframe(uint8_t sampleDepth, uint8_t ch, int32_t* bytesLeft) {
 
     int8_t ret = 0;
@@ -941,6 +1209,8 @@ int8_t FlacDecoder::decodeSubframe(uint8_t sampleDepth, uint8_t ch, int32_t* byt
         while (readUint(1, bytesLeft) == 0) { shift++; }
     }
     sampleDepth -= shift;
+    m_pred[ch].type = PRED_NONE;
+    m_pred[ch].wasted = shift;
 
     if (type == 0) {                                       // Constant coding
         int32_t s = readSignedInt(sampleDepth, bytesLeft); // SUBFRAME_CONSTANT
@@ -957,10 +1227,7 @@ int8_t FlacDecoder::decodeSubframe(uint8_t sampleDepth, uint8_t ch, int32_t* byt
         FLAC_LOG_ERROR("Flac unimplemented reserved subtype: %i", type);
         return FLAC_ERR;
     }
-    if (shift > 0) {
-        for (int32_t i = 0; i < m_numOfOutSamples; i++) { m_samplesBuffer[ch][i] <<= shift; }
-    }
-    return FLAC_NONE;
+    return FLAC_NONE; // the prediction is restored in restoreChannel()
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 int8_t FlacDecoder::decodeFixedPredictionSubframe(uint8_t predOrder, uint8_t sampleDepth, uint8_t ch, int32_t* bytesLeft) { // SUBFRAME_FIXED
@@ -969,30 +1236,13 @@ int8_t FlacDecoder::decodeFixedPredictionSubframe(uint8_t predOrder, uint8_t sam
     for (uint8_t i = 0; i < predOrder; i++) m_samplesBuffer[ch][i] = readSignedInt(sampleDepth, bytesLeft); // Unencoded warm-up samples (n = frame's bits-per-sample * predictor order).
     ret = decodeResiduals(predOrder, ch, bytesLeft);
     if (ret) return ret;
-    coefs.clear();
-    coefs.shrink_to_fit();
-    if (predOrder == 0) coefs.resize(0);
-    if (predOrder == 1) coefs.push_back(1); // FIXED_PREDICTION_COEFFICIENTS
-    if (predOrder == 2) {
-        coefs.push_back(2);
-        coefs.push_back(-1);
-    }
-    if (predOrder == 3) {
-        coefs.push_back(3);
-        coefs.push_back(-3);
-        coefs.push_back(1);
-    }
-    if (predOrder == 4) {
-        coefs.push_back(4);
-        coefs.push_back(-6);
-        coefs.push_back(4);
-        coefs.push_back(-1);
-    }
     if (predOrder > 4) {
         FLAC_LOG_ERROR("Flac preorder too big: %i", predOrder);
         return FLAC_ERR;
     } // Error: preorder > 4"
-    restoreLinearPrediction(ch, 0);
+    m_pred[ch].type = PRED_FIXED;
+    m_pred[ch].order = predOrder;
+    m_pred[ch].sampleDepth = sampleDepth;
     return FLAC_NONE;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -1004,13 +1254,20 @@ int8_t FlacDecoder::decodeLinearPredictiveCodingSubframe(int32_t lpcOrder, int32
     }
     int32_t precision = readUint(4, bytesLeft) + 1; // (Quantized linear predictor coefficients' precision in bits)-1 (1111 = invalid).
     int32_t shift = readSignedInt(5, bytesLeft);    // Quantized linear predictor coefficient shift needed in bits (NOTE: this number is signed two's-complement).
-    coefs.clear();
     for (uint8_t i = 0; i < lpcOrder; i++) {
-        coefs.push_back(readSignedInt(precision, bytesLeft)); // Unencoded predictor coefficients (n = qlp coeff precision * lpc order) (NOTE: the coefficients are signed two's-complement).
+        m_pred[ch].coefs[i] = readSignedInt(precision, bytesLeft); // Unencoded predictor coefficients (n = qlp coeff precision * lpc order) (NOTE: the coefficients are signed two's-complement).
+    }
+    if (shift < 0) {
+        FLAC_LOG_ERROR("Flac negative lpc shift: %i", shift);
+        return FLAC_ERR;
     }
     ret = decodeResiduals(lpcOrder, ch, bytesLeft);
     if (ret) return ret;
-    restoreLinearPrediction(ch, shift);
+    m_pred[ch].type = PRED_LPC;
+    m_pred[ch].order = lpcOrder;
+    m_pred[ch].shift = shift;
+    m_pred[ch].sampleDepth = sampleDepth;
+    m_pred[ch].precision = precision;
     return FLAC_NONE;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -1043,35 +1300,63 @@ int8_t FlacDecoder::decodeResiduals(uint8_t warmup, uint8_t ch, int32_t* bytesLe
         const int32_t param = readUint(paramBits, bytesLeft);
 
         if (param < escapeParam) {
-            // Rice-coded partition
+            // Rice-coded partition, the cache is held in registers, the unary prefix is counted with clz
+            uint64_t cache = m_flac_bitBuffer;
+            uint32_t len = m_flacBitBufferLen;
+            auto     refill = [&]() {
+                m_flac_bitBuffer = cache;
+                m_flacBitBufferLen = len;
+                refillBitBuffer(bytesLeft);
+                cache = m_flac_bitBuffer;
+                len = m_flacBitBufferLen;
+            };
             while (dst < dstEnd) {
+                uint32_t q = 0; // unary prefix
+                while (true) {
+                    uint32_t z = cache ? __builtin_clzll(cache) : 64;
+                    if (z < len) { // stop bit is in the cache
+                        q += z;
+                        cache <<= z;
+                        cache <<= 1;
+                        len -= z + 1;
+                        break;
+                    }
+                    q += len; // all valid bits are zero
+                    cache = 0;
+                    len = 0;
+                    refill();
+                    if (!len) {
+                        m_f_bitReaderError = true;
+                        break;
+                    }
+                }
                 if (m_f_bitReaderError) break;
-
-                uint32_t val = 0;
-                // Inline Rice unary prefix
-                while (readUint(1, bytesLeft) == 0) {
-                    val++;
-                    if (m_f_bitReaderError) break;
+                uint32_t val = q;
+                if (param) { // remainder bits
+                    if (len < (uint32_t)param) {
+                        refill();
+                        if (len < (uint32_t)param) {
+                            m_f_bitReaderError = true;
+                            break;
+                        }
+                    }
+                    val = (q << param) | (uint32_t)(cache >> (64 - param));
+                    cache <<= param;
+                    len -= param;
                 }
-                // Append remainder bits
-                val = (val << param) | readUint(param, bytesLeft);
-
-                // Convert to signed
-                int32_t signedVal = (val >> 1) ^ -(val & 1);
-                *dst++ = signedVal;
+                *dst++ = (val >> 1) ^ -(val & 1); // zigzag to signed
             }
+            m_flac_bitBuffer = cache;
+            m_flacBitBufferLen = len;
         } else {
             // Escape partition (raw signed integers)
             const int32_t numBits = readUint(5, bytesLeft);
             while (dst < dstEnd) {
                 if (m_f_bitReaderError) break;
-
-                uint32_t val = readUint(numBits, bytesLeft);
-                // Sign extend
-                int32_t signedVal = (int32_t)(val << (32 - numBits)) >> (32 - numBits);
-                *dst++ = signedVal;
+                *dst++ = numBits ? readSignedInt(numBits, bytesLeft) : 0;
             }
         }
+        if (m_f_bitReaderError) break;
     }
 
     if (m_f_bitReaderError) {
@@ -1081,15 +1366,53 @@ int8_t FlacDecoder::decodeResiduals(uint8_t warmup, uint8_t ch, int32_t* bytesLe
     return FLAC_NONE;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
-void FlacDecoder::restoreLinearPrediction(uint8_t ch, uint8_t shift) {
+// prediction kernels, the order is a template parameter so that the inner loop is unrolled completely
+// ACC is int32_t if the sum can't exceed 32 bit, int64_t otherwise (24 bit high order streams)
+template <int ORDER, typename ACC> static void lpcKernel(int32_t* s, const int32_t* c, int32_t n, uint8_t shift) {
+    for (int32_t i = ORDER; i < n; i++) {
+        ACC sum = 0;
+        for (int j = 0; j < ORDER; j++) sum += (ACC)c[j] * s[i - 1 - j];
+        s[i] += (int32_t)(sum >> shift);
+    }
+}
 
-    for (int32_t i = coefs.size(); i < m_numOfOutSamples; i++) {
-        int32_t sum = 0;
-        for (int32_t j = 0; j < coefs.size(); j++) { sum += m_samplesBuffer[ch][i - 1 - j] * coefs[j]; }
-        m_samplesBuffer[ch][i] += (sum >> shift);
+template <typename ACC, int... O> static constexpr auto lpcKernelTable(std::integer_sequence<int, O...>) {
+    return std::array<void (*)(int32_t*, const int32_t*, int32_t, uint8_t), sizeof...(O)>{lpcKernel<O + 1, ACC>...};
+}
+
+static constexpr auto lpcKernel32 = lpcKernelTable<int32_t>(std::make_integer_sequence<int, 32>{}); // order 1...32
+static constexpr auto lpcKernel64 = lpcKernelTable<int64_t>(std::make_integer_sequence<int, 32>{});
+
+template <int ORDER, typename ACC> static void fixedKernel(int32_t* s, int32_t n) { // FIXED_PREDICTION_COEFFICIENTS
+    for (int32_t i = ORDER; i < n; i++) {
+        if constexpr (ORDER == 1) s[i] += s[i - 1];
+        if constexpr (ORDER == 2) s[i] += (int32_t)(2 * (ACC)s[i - 1] - s[i - 2]);
+        if constexpr (ORDER == 3) s[i] += (int32_t)(3 * ((ACC)s[i - 1] - s[i - 2]) + s[i - 3]);
+        if constexpr (ORDER == 4) s[i] += (int32_t)(4 * ((ACC)s[i - 1] + s[i - 3]) - 6 * (ACC)s[i - 2] - s[i - 4]);
     }
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void FlacDecoder::restoreFixedPrediction(uint8_t ch) {
+    int32_t* s = m_samplesBuffer[ch].get();
+    int32_t  n = m_numOfOutSamples;
+    bool     wide = m_pred[ch].sampleDepth + m_pred[ch].order > 32; // sum of |coefficients| is at most 2^order
+    switch (m_pred[ch].order) {
+        case 1: fixedKernel<1, int32_t>(s, n); break;
+        case 2: wide ? fixedKernel<2, int64_t>(s, n) : fixedKernel<2, int32_t>(s, n); break;
+        case 3: wide ? fixedKernel<3, int64_t>(s, n) : fixedKernel<3, int32_t>(s, n); break;
+        case 4: wide ? fixedKernel<4, int64_t>(s, n) : fixedKernel<4, int32_t>(s, n); break;
+        default: break; // order 0, the residuals are the samples
+    }
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void FlacDecoder::restoreLinearPrediction(uint8_t ch) {
+    const prediction_t& p = m_pred[ch];
+    if (p.order < 1 || p.order > 32) return;
+    uint8_t log2Order = 32 - __builtin_clz(p.order); // bits of order, >= ceil(log2(order))
+    bool    wide = p.sampleDepth + p.precision + log2Order > 32;
+    (wide ? lpcKernel64 : lpcKernel32)[p.order - 1](m_samplesBuffer[ch].get(), p.coefs, m_numOfOutSamples, p.shift);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 int32_t FlacDecoder::specialIndexOf(uint8_t* base, const char* str, int32_t baselen, bool exact) {
     int32_t result = 0;                   // seek for str in buffer or in header up to baselen, not nullterninated
     if (strlen(str) > baselen) return -1; // if exact == true seekstr in buffer must have "\0" at the end
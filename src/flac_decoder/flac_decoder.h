@@ -8,8 +8,8 @@
  *
  *  Restrictions:
  *  blocksize must not exceed 24576 bytes
- *  bits per sample must be 8 or 16
- *  num Channels must be 1 or 2
+ *  bits per sample 8, 16, 20 or 24, more than 16 with full resolution via decode32() (AUDIO_PCM_32BIT)
+ *  num Channels 1 ... 8, more than 2 are mixed down to stereo (setDownmixCoefficient)
  *
  *
  */
@@ -17,6 +17,7 @@
 #pragma GCC optimize("Ofast")
 
 #include "../Audio.h"
+#include <array>
 
 #define ANSI_ESC_RESET   "\033[0m"
 #define ANSI_ESC_BLACK   "\033[30m"
@@ -48,12 +49,18 @@ public:
     const char*           getStreamTitle() override;
     const char*           whoIsIt() override;
     int32_t               decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf) override;
+    bool                  hasPCM32Output() override;
+    int32_t               decode32(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf) override;
     void                  setRawBlockParams(uint8_t channels, uint32_t sampleRate, uint8_t BPS, uint32_t tsis, uint32_t AuDaLength) override;
     std::vector<uint32_t> getMetadataBlockPicture() override;
     const char*           arg1() override;
     const char*           arg2() override;
     virtual int32_t       val1() override;
     virtual int32_t       val2() override;
+    Audio::decoderStats_t getStats() override { return m_stats; }
+    static uint8_t        crc8(const uint8_t* data, int32_t len);
+    static uint16_t       crc16(uint16_t crc, const uint8_t* data, int32_t len);
+    static int64_t        frameHeaderSample(const uint8_t* p, int32_t len, uint16_t fixedBlockSize, uint16_t maxBlockSize); // -1: no valid header
 
     enum : int8_t {
         FLAC_PARSE_OGG_DONE = 100,
@@ -67,9 +74,9 @@ public:
 
 private:
     Audio& audio;
-#define FLAC_MAX_CHANNELS    2
+#define FLAC_MAX_CHANNELS    8
 #define FLAC_MAX_BLOCKSIZE   24576 // 24 * 1024
-    #define FLAC_MAX_OUTBUFFSIZE 4096 * 2
+    #define FLAC_MAX_OUTBUFFSIZE 4096 // frames per chunk, must fit into Audio::m_outBuff (stereo)
 
     enum : uint8_t { FLACDECODER_INIT, FLACDECODER_READ_IN, FLACDECODER_WRITE_OUT };
     enum : uint8_t { DECODE_FRAME, DECODE_SUBFRAMES, OUT_SAMPLES };
@@ -179,11 +186,23 @@ private:
 
 //    std::deque<int> coefs;
 
+    typedef struct _prediction { // restore parameters of a decoded subframe, applied by restoreChannel()
+        uint8_t type;            // PRED_NONE, PRED_FIXED, PRED_LPC
+        uint8_t order;
+        uint8_t shift;
+        uint8_t sampleDepth;
+        uint8_t precision;
+        uint8_t wasted; // wasted bits per sample
+        int32_t coefs[32];
+    } prediction_t;
+    enum : uint8_t { PRED_NONE = 0, PRED_FIXED = 1, PRED_LPC = 2 };
+
+    prediction_t      m_pred[FLAC_MAX_CHANNELS];
+
     ps_ptr<FLACFrameHeader_t>   FLACFrameHeader;
     ps_ptr<FLACMetadataBlock_t> FLACMetadataBlock;
 
     std::vector<uint32_t> m_flacSegmTableVec;
-    std::vector<int32_t>  coefs;
     std::vector<uint32_t> m_flacBlockPicItem;
 
     uint64_t        m_flac_bitBuffer = 0;
@@ -198,7 +217,7 @@ private:
     uint32_t        m_segmLenTmp = 0;
     uint16_t        m_numOfOutSamples = 0;
     uint16_t        m_flacValidSamples = 0;
-    uint16_t        m_rIndex = 0;
+    uint32_t        m_rIndex = 0; // relative to m_flacInptr, a frame can be larger than 64kB
     uint16_t        m_offset = 0;
     uint8_t         m_flacStatus = 0;
     uint8_t*        m_flacInptr;
@@ -216,30 +235,60 @@ private:
     bool            m_f_flacNewMetadataBlockPicture = false;
     bool            m_valid = false;
     uint8_t         m_flacPageNr = 0;
-    ps_ptr<int32_t> m_samplesBuffer[2];
+    ps_ptr<int32_t> m_samplesBuffer[FLAC_MAX_CHANNELS]; // deinterleaved, allocated for numChannels
+    Downmix         m_downmix;                          // > 2 channels, per stream
     uint16_t        m_maxBlocksize = FLAC_MAX_BLOCKSIZE;
     int32_t         m_nBytes = 0;
+    Audio::decoderStats_t m_stats;
+    bool            m_f_crcCheck = true;
+    uint16_t        m_crc16 = 0;  // CRC-16 of the current frame up to m_crcIdx
+    uint32_t        m_crcIdx = 0; // relative to m_flacInptr
+    ps_ptr<uint8_t> m_oggFrame = {};        // frame collected from more than one ogg page
+    uint32_t        m_oggFrameLen = 0;
+    bool            m_f_oggDeframed = false; // m_nBytes refers to m_oggFrame
+    bool            m_f_oggContinued = false; // the last packet of the current page continues on the next page
 
     boolean  FLACFindMagicWord(unsigned char* buf, int32_t nBytes);
     int32_t  parseOGG(uint8_t* inbuf, int32_t* bytesLeft);
+    int32_t  oggDeframe(uint8_t* inbuf, int32_t* bytesLeft);
     int32_t  parseFlacFirstPacket(uint8_t* inbuf, int16_t nBytes);
     int32_t  parseMetaDataBlockHeader(uint8_t* inbuf, int16_t nBytes);
     void     setDefaults();
     void     decoderReset();
-    int8_t   decodeNative(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf);
+    template <typename T> int32_t decodeFlac(uint8_t* inbuf, int32_t* bytesLeft, T* outbuf);
+    template <typename T> int8_t  decodeNative(uint8_t* inbuf, int32_t* bytesLeft, T* outbuf);
     int8_t   decodeFrame(uint8_t* inbuf, int32_t* bytesLeft);
     uint64_t getTotoalSamplesInStream();
-    uint32_t readUint(uint8_t nBits, int32_t* bytesLeft);
+    void     refillBitBuffer(int32_t* bytesLeft);
+    void     bitReaderGiveBack(int32_t* bytesLeft);
+    void     crc16Update();
     void     alignToByte();
     int8_t   decodeSubframes(int32_t* bytesLeft);
     int8_t   decodeSubframe(uint8_t sampleDepth, uint8_t ch, int32_t* bytesLeft);
     int8_t   decodeFixedPredictionSubframe(uint8_t predOrder, uint8_t sampleDepth, uint8_t ch, int32_t* bytesLeft);
     int8_t   decodeLinearPredictiveCodingSubframe(int32_t lpcOrder, int32_t sampleDepth, uint8_t ch, int32_t* bytesLeft);
     int8_t   decodeResiduals(uint8_t warmup, uint8_t ch, int32_t* bytesLeft);
-    void     restoreLinearPrediction(uint8_t ch, uint8_t shift);
+    void     restoreChannel(uint8_t ch);
+    void     restoreFixedPrediction(uint8_t ch);
+    void     restoreLinearPrediction(uint8_t ch);
     int32_t  specialIndexOf(uint8_t* base, const char* str, int32_t baselen, bool exact = false);
 
 
+    inline uint32_t readUint(uint8_t nBits, int32_t* bytesLeft) { // 64 bit cache, left aligned, refilled with whole words
+        if (!nBits) return 0;
+        if (m_flacBitBufferLen < nBits) {
+            refillBitBuffer(bytesLeft);
+            if (m_flacBitBufferLen < nBits) {
+                m_f_bitReaderError = true;
+                return 0;
+            }
+        }
+        uint32_t result = m_flac_bitBuffer >> (64 - nBits);
+        m_flac_bitBuffer <<= nBits;
+        m_flacBitBufferLen -= nBits;
+        return result;
+    }
+
     inline int32_t readSignedInt(int32_t nBits, int32_t* bytesLeft) {
         int32_t temp = readUint(nBits, bytesLeft) << (32 - nBits);
         temp = temp >> (32 - nBits); // The C++ compiler uses the sign bit to fill vacated bit positions
@@ -19,14 +19,16 @@ bool MP3Decoder::init() {
     m_IMDCTInfo.alloc("m_IMDCTInfo");
     m_SubbandInfo.alloc("m_SubbandInfo");
     m_MP3FrameInfo.alloc("m_MP3FrameInfo");
+    m_ConcealInfo.alloc("m_ConcealInfo");
 
     if (!m_MP3DecInfo.valid() || !m_FrameHeader.valid() || !m_SideInfo.valid() || !m_ScaleFactorJS.valid() || !m_HuffmanInfo.valid() || !m_DequantInfo.valid() || !m_IMDCTInfo.valid() ||
-        !m_SubbandInfo.valid() || !m_MP3FrameInfo.valid()) {
+        !m_SubbandInfo.valid() || !m_MP3FrameInfo.valid() || !m_ConcealInfo.valid() || !buildHuffLut()) {
         reset();
         MP3_LOG_ERROR("not enough memory to allocate mp3decoder buffers");
         return false;
     }
     clear();
+    m_stats = {};
     return true;
 }
 
@@ -41,7 +43,11 @@ void MP3Decoder::reset() {
     m_IMDCTInfo.reset();
     m_SubbandInfo.reset();
     m_MP3FrameInfo.reset();
+    m_ConcealInfo.reset();
     m_mpeg_version_str.reset();
+    m_huffLut.reset();
+    workerStop();
+    m_sync.reset();
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void MP3Decoder::clear() {
@@ -55,7 +61,10 @@ void MP3Decoder::clear() {
     m_IMDCTInfo.clear();
     m_SubbandInfo.clear();
     m_MP3FrameInfo.clear();
+    m_ConcealInfo.clear();
     m_mpeg_version_str.clear();
+    m_underflowCounter = 0;
+    memset(m_upsHist, 0, sizeof(m_upsHist));
     memset(&m_SFBandTable, 0, sizeof(SFBandTable_t));                                         // Clear SFBandTable
     memset(&m_ScaleFactorInfoSub, 0, sizeof(ScaleFactorInfoSub_t) * (MAX_NGRAN * MAX_NCHAN)); // Clear ScaleFactorInfo
     memset(&m_CriticalBandInfo, 0, sizeof(CriticalBandInfo_t) * MAX_NCHAN);                   // Clear CriticalBandInfo
@@ -65,7 +74,7 @@ void MP3Decoder::clear() {
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 bool MP3Decoder::isValid() {
     if (!m_MP3DecInfo.valid() || !m_FrameHeader.valid() || !m_SideInfo.valid() || !m_ScaleFactorJS.valid() || !m_HuffmanInfo.valid() || !m_DequantInfo.valid() || !m_IMDCTInfo.valid() ||
-        !m_SubbandInfo.valid() || !m_MP3FrameInfo.valid()) {
+        !m_SubbandInfo.valid() || !m_MP3FrameInfo.valid() || !m_ConcealInfo.valid()) {
         return false;
     }
     return true;
@@ -545,279 +554,15 @@ int32_t MP3Decoder::UnpackScaleFactors(uint8_t* buf, int32_t* bitOffset, int32_t
  *              -1 if sync not found after searching nBytes
  */
 int32_t MP3Decoder::findSyncWord(uint8_t* buf, int32_t nBytes) {
-
-    // Auxiliary function for extracting bits, byte 'value', 'start_bit' is that bit from the left (0-7), 'num_bits' is the number of bits
-    // auto extract_bits = [&](uint8_t byte, uint8_t start_bit, uint8_t num_bits) {
-    //   return (byte >> (8 - start_bit - num_bits)) & ((1 << num_bits) - 1);
-    // };
-
-    typedef struct {
-        uint8_t  mpeg_version; // 0=MPEG2.5, 1=reserved, 2=MPEG2, 3=MPEG1
-        uint8_t  layer;        // 0=reserved, 1=Layer III, 2=Layer II, 3=Layer I
-        bool     crc_protected;
-        uint8_t  bitrate_idx;
-        uint8_t  sample_rate_idx;
-        bool     padding;
-        uint8_t  channel_mode;
-        uint32_t frame_length = 0; // cytes
-        uint16_t sample_rate_hz;   // the actual sampling rate in Hz
-        uint16_t bitrate_kbps;     // the actual bit rate in Kbps
-        uint16_t samples_per_frame;
-    } Mp3FrameHeader_sync_t;
-
-    // SamplingFrequenz-Lookup tables(Beispiel für MPEG1, MPEG2, MPEG2.5)
-    const uint16_t sampling_rates[3][4] = {
-        {44100, 48000, 32000, 0}, // MPEG1
-        {22050, 24000, 16000, 0}, // MPEG2
-        {11025, 12000, 8000, 0}   // MPEG2.5
-    };
-
-    typedef enum { /* map to 0,1,2 to make table indexing easier */
-                   MPEG1 = 0,
-                   MPEG2 = 1,
-                   MPEG25 = 2
-    } MPEGVersion_t;
-
-    const uint16_t mpeg1_layer1_bitrates[16] = {0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448, 0};
-
-    const uint16_t mpeg1_layer3_bitrates[16] = {
-        // Bitraten-Lookup tables (example for MPEG1 Layer III)
-        0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0 // Attention: These tables must be complete and correct!
-    };
-    // Define bitrate tables for MPEG1 Layer II and MPEG2/2.5 Layer II
-    // These tables are examples and need to be complete based on the MPEG standard
-    const uint16_t mpeg1_layer2_bitrates[] = {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 0};
-    const uint16_t mpeg2_layer2_bitrates[] = {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0};
-    const uint16_t mpeg2_layer3_bitrates[] = {
-        0, // "Free format" oder ungültig
-        8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160,
-        0 // Ungültig
-    };
-
-    // Funktion zum Parsen des Headers und Überprüfen der Gültigkeit
-    auto parseMp3Header = [&](const uint8_t* header_data, Mp3FrameHeader_sync_t* header_info) {
-        // Byte 0: Syncword H (bereits geprüft)
-        // Byte 1: Syncword L, MPEG Version, Layer
-        // Byte 2: Bitrate, Sampling Frequency, Padding, Private
-        // Byte 3: Channel Mode, Mode Extension, Copyright, Original, Emphasis
-
-        // Syncword has already been checked, here we start with the other bits
-        header_info->mpeg_version = (header_data[1] >> 3) & 0b11;    // Bits 12, 13 (A, B)
-        header_info->layer = (header_data[1] >> 1) & 0b11;           // Bits 14, 15 (C, D)
-        header_info->crc_protected = !((header_data[1] >> 0) & 0b1); // Bit 16 (Schutzbit)
-
-        header_info->bitrate_idx = (header_data[2] >> 4) & 0b1111;   // Bits 17-20
-        header_info->sample_rate_idx = (header_data[2] >> 2) & 0b11; // Bits 21-22
-        header_info->padding = (header_data[2] >> 1) & 0b1;          // Bit 23
-
-        header_info->channel_mode = (header_data[3] >> 6) & 0b11; // Bits 24-25
-
-        // Gültigkeitsprüfungen
-        if (header_info->mpeg_version == 1) { // Reserved
-            MP3_LOG_DEBUG("Reserved MPEG version\n");
-            return false;
-        }
-        if (header_info->layer == 0) { // Reserved
-            MP3_LOG_DEBUG("Reserved Layer\n");
-            return false;
-        }
-        // Modified part: Support for Layer II and Layer III
-        if (header_info->layer != 1 && header_info->layer != 2 && header_info->layer != 3) { // Allow Layer I (3) Layer II (2) and Layer III (1)
-            printf("\n");
-            for (int i = 0; i < 10; i++) printf("0x%02x ", header_data[i]);
-            printf("\n"); // Use header_data instead of buf
-            MP3_LOG_DEBUG("Not Layer I or II or III\n");
-            return false;
-        }
-
-        if (header_info->bitrate_idx == 0 || header_info->bitrate_idx == 15) { // Invalid bit rate
-            MP3_LOG_DEBUG("Invalid bitrate index\n");
-            return false;
-        }
-        if (header_info->sample_rate_idx == 3) { // Invalid sampling frequency
-            MP3_LOG_DEBUG("Invalid sampling rate index\n");
-            return false;
-        }
-
-        // Determine the actual bit rate and sampling frequency
-        uint16_t bitrate_kbps = 0;
-        uint16_t sample_rate_hz = 0;
-
-        // Mapping from MPEG version to sampling rate table
-        uint8_t sr_table_idx;
-        if (header_info->mpeg_version == 3)
-            sr_table_idx = 0; // MPEG 1 (0b11)
-        else if (header_info->mpeg_version == 2)
-            sr_table_idx = 1; // MPEG 2 (0b10)
-        else
-            sr_table_idx = 2; // MPEG 2.5 (da mpeg_version == 0) - Although Google TTS is likely MPEG 2.0
-
-        sample_rate_hz = sampling_rates[sr_table_idx][header_info->sample_rate_idx];
-
-        // Bitraten-Mapping für verschiedene MPEG-Versionen und Layer
-        if (header_info->mpeg_version == 3) { // MPEG 1
-            if (header_info->layer == 1) {    // Layer III
-                bitrate_kbps = mpeg1_layer3_bitrates[header_info->bitrate_idx];
-            } else if (header_info->layer == 2) { // Layer II
-                bitrate_kbps = mpeg1_layer2_bitrates[header_info->bitrate_idx];
-            } else if (header_info->layer == 3) { // Layer I
-                bitrate_kbps = mpeg1_layer1_bitrates[header_info->bitrate_idx];
-            }
-        } else if (header_info->mpeg_version == 2 || header_info->mpeg_version == 0) { // MPEG 2 or MPEG 2.5
-            if (header_info->layer == 1) {                                             // Layer III
-                bitrate_kbps = mpeg2_layer3_bitrates[header_info->bitrate_idx];
-            } else if (header_info->layer == 2) { // Layer II
-                bitrate_kbps = mpeg2_layer2_bitrates[header_info->bitrate_idx];
-            }
-            // If you also want to support MPEG 2/2.5 Layer I, you'd add another else if here
-            // e.g., else if (header_info->layer == 3) { bitrate_kbps = mpeg2_layer1_bitrates[header_info->bitrate_idx]; }
-        }
-
-        if (bitrate_kbps == 0 || sample_rate_hz == 0) {
-            MP3_LOG_DEBUG("Could not determine valid bitrate or sample rate\n");
-            return false;
-        }
-
-        // Calculate frame length based on layer
-        // FrameSize = (1152 * BitRate / SampleRate) + Padding (for Layer III)
-        // FrameSize = (144 * BitRate / SampleRate) + Padding (for Layer I)
-        // FrameSize = (576 * BitRate / SampleRate) + Padding (for Layer II, MPEG 2.0/2.5)
-        // Note: For MPEG 1 Layer II, it's (1152 * BitRate / SampleRate) + Padding
-        // Need to be careful with the constant depending on MPEG version and layer
-        if (header_info->layer == 1) {                                                   // Layer III
-            header_info->frame_length = (144 * bitrate_kbps * 1000) / sample_rate_hz;    // Assuming MPEG1 Layer III
-            if (header_info->mpeg_version == 2 || header_info->mpeg_version == 0) {      // MPEG2/2.5 Layer III
-                header_info->frame_length = (72 * bitrate_kbps * 1000) / sample_rate_hz; // Correct constant for MPEG2/2.5 Layer III
-            }
-        } else if (header_info->layer == 2) {     // Layer II
-            if (header_info->mpeg_version == 3) { // MPEG 1 Layer II
-                header_info->frame_length = (144 * bitrate_kbps * 1000) / sample_rate_hz;
-            } else if (header_info->mpeg_version == 2 || header_info->mpeg_version == 0) { // MPEG 2/2.5 Layer II
-                header_info->frame_length = (144 * bitrate_kbps * 1000) / sample_rate_hz;
-            }
-        } else if (header_info->layer == 3) { // Layer I
-            // For Layer I, the formula is (Bitrate * 12 / SampleRate) + Padding (in Bytes)
-            // Note: Bitrate is in kbps, so multiply by 1000 to get bps
-            if (header_info->mpeg_version == 3) {                                            // MPEG 1 Layer I
-                header_info->frame_length = (bitrate_kbps * 1000 / 8 * 12) / sample_rate_hz; // Correct
-            } else if (header_info->mpeg_version == 2 || header_info->mpeg_version == 0) {   // MPEG 2/2.5 Layer I (if supported)
-                // You'd add the specific calculation for MPEG2/2.5 Layer I here
-                // For MPEG 2/2.5 Layer I, samples per frame is 576, so the constant is 6
-                header_info->frame_length = (bitrate_kbps * 1000 / 8 * 6) / sample_rate_hz; // Hypothetical, verify constant
-            }
-        }
-
-        if (header_info->padding) {
-            header_info->frame_length += 1; // Füge 1 Byte für Padding hinzu
-        }
-
-        if (header_info->frame_length == 0) {
-            MP3_LOG_DEBUG("Calculated frame length is zero\n");
-            return false;
-        }
-        header_info->sample_rate_hz = sample_rate_hz;
-        header_info->bitrate_kbps = bitrate_kbps;
-
-        // Determine samples_per_frame based on the version and layer
-        if (header_info->mpeg_version == 3) {                         // MPEG-1
-            if (header_info->layer == 1 || header_info->layer == 2) { // Layer III oder Layer II
-                header_info->samples_per_frame = 1152;
-            } else if (header_info->layer == 3) { // Layer I
-                header_info->samples_per_frame = 384;
-            } else {
-                header_info->samples_per_frame = 0; // Should be caught by previous checks
-                return false;
-            }
-        } else if (header_info->mpeg_version == 2 || header_info->mpeg_version == 0) { // MPEG-2 oder MPEG-2.5
-            if (header_info->layer == 1) {                                             // Layer III
-                header_info->samples_per_frame = 576;
-            } else if (header_info->layer == 2) { // Layer II
-                header_info->samples_per_frame = 1152;
-            } else if (header_info->layer == 3) {     // Layer I
-                header_info->samples_per_frame = 576; // Correct for MPEG-2/2.5 Layer I
-            } else {
-                header_info->samples_per_frame = 0; // Should be caught by previous checks
-                return false;
-            }
-        } else { // header_info->mpeg_version == 1 (Reserved)
-            header_info->samples_per_frame = 0;
-            return false;
-        }
-        return true; // Header ist gültig
-    };
-
-    const uint8_t mp3FHsize = 4; // frame header size
-
-    // Lambda for the fast syncword search
-    auto findSync = [&](uint8_t* search_buf, uint16_t offset, uint16_t len) {
-        for (int32_t i = 0; i < len - 1; i++) {
-            // Prüfe auf die 11 oder 12 Sync-Bits
-            if ((search_buf[i + offset] == SYNCWORDH) && ((search_buf[i + offset + 1] & SYNCWORDL) == SYNCWORDL)) { return i; }
-        }
-        return (int32_t)-1;
-    };
-
-    int32_t current_pos = 0;
-
-    while (nBytes >= mp3FHsize) { // Make sure that there are enough bytes for a header
-        int32_t sync_offset = findSync(buf, current_pos, nBytes);
-
-        if (sync_offset == -1) {
-            MP3_LOG_DEBUG("No syncword found in remaining buffer\n");
-            return -1; // No more syncword found
-        }
-
-        current_pos += sync_offset;
-        nBytes -= sync_offset;
-
-        if (nBytes < mp3FHsize) {
-            MP3_LOG_DEBUG("Not enough bytes for a full header after syncword\n");
-            return -1; // Not enough data for a full header
-        }
-
-        Mp3FrameHeader_sync_t header;
-        if (parseMp3Header(&buf[current_pos], &header)) {
-            // This is where the crucial step comes: Check the next frame
-            if (current_pos + header.frame_length + mp3FHsize <= current_pos + nBytes) {
-                // Check whether there is a syncword at the expected next frame start and a valid header is (optional but very robust)
-                Mp3FrameHeader_sync_t next_header;
-                if (((buf[current_pos + header.frame_length] == SYNCWORDH) && ((buf[current_pos + header.frame_length + 1] & SYNCWORDL) == SYNCWORDL)) &&
-                    parseMp3Header(&buf[current_pos + header.frame_length], &next_header)) {
-                    // MP3_LOG_DEBUG("Found reliable MP3 frame at pos: %d, length: %lu\n", current_pos, header.frame_length);
-
-                    // s_samplerate   = header.sample_rate_hz; // (suppose in the structure available)
-                    // s_bitRate      = header.bitrate_kbps;   // (suppose in the structure available)
-                    // s_mpeg_version = header.mpeg_version;
-                    // s_layer        = header.layer;
-                    // s_channel_mode = header.channel_mode;
-                    // s_samples_per_frame = header.samples_per_frame;
-
-                    // // s_channels (1 Mono, 2 Stereo)
-                    // if (header.channel_mode == 0b11) { // 0b11 ist Mono
-                    //     s_channels = 1;
-                    // } else { // 2 channels for all other (Stereo, Joint Stereo, Dual Channel)
-                    //     s_channels = 2;
-                    // }
-                    return current_pos;
-                } else {
-                    MP3_LOG_DEBUG("Header valid, but next frame does not validate. False positive. Moving on.");
-                }
-            } else {
-                MP3_LOG_DEBUG("Header valid, but not enough data for next frame check. Possibly end of stream or false positive.");
-                // If not enough data for the next frame, it could still be the right one.
-                // This is a compromise.If in doubt, continue to search or return the current one.
-                // For robustness: search.
-            }
-        } else {
-            MP3_LOG_DEBUG("Found syncword but header is invalid. Moving to next possible syncword.");
-        }
-
-        // If the current header was invalid or the next frame did not validate the current "SyncWord" and continue to search
-        current_pos += 1; // go a byte on and look for the Syncword again
-        nBytes -= 1;
-    }
-
-    return -1; // no valid MP3 frame found
+    // layer III frames only, three frames in a row with the same version, samplerate and channel mode
+    return m_sync.find(buf, nBytes);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int32_t MP3Decoder::syncHeader(const uint8_t* hdr, uint32_t* fixed) {
+    int32_t len = frameLength(hdr, nullptr, nullptr);
+    if (len <= 0) return -1; // free format has no computable length
+    *fixed = (hdr[1] << 8) | (hdr[2] & 0x0C) | ((hdr[3] >> 6) == Mono); // version, layer, crc, samplerate, mono
+    return len;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 /*
@@ -854,7 +599,7 @@ int32_t MP3Decoder::MP3FindFreeSync(uint8_t* buf, uint8_t firstFH[4], int32_t nB
      *      in next header must match current header)
      */
     while (1) {
-        offset = findSyncWord(bufPtr, nBytes);
+        offset = SyncScanner::candidate(bufPtr, nBytes, SYNCWORDL); // findSyncWord() needs a bitrate
         bufPtr += offset;
         if (offset < 0) {
             return -1;
@@ -990,6 +735,21 @@ int32_t MP3Decoder::MP3GetNextFrameInfo(uint8_t* buf) {
     return MP3_NONE;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int32_t MP3Decoder::frameLength(const uint8_t* hdr, uint32_t* sampleRate, uint16_t* samplesPerFrame) {
+    // header only, the decoder state is not touched, returns the frame size in bytes, 0: free format, -1: no layer III header
+    if (hdr[0] != 0xFF || (hdr[1] & 0xE0) != 0xE0) return -1;
+    int32_t verIdx = (hdr[1] >> 3) & 0x03;
+    if (verIdx == 1 || ((hdr[1] >> 1) & 0x03) != 1) return -1; // reserved, not layer III
+    MPEGVersion_t ver = (MPEGVersion_t)(verIdx == 0 ? MPEG25 : ((verIdx & 0x01) ? MPEG1 : MPEG2));
+    int32_t       brIdx = (hdr[2] >> 4) & 0x0f;
+    int32_t       srIdx = (hdr[2] >> 2) & 0x03;
+    if (brIdx == 15 || srIdx == 3) return -1;
+    if (sampleRate) *sampleRate = samplerateTab[ver][srIdx];
+    if (samplesPerFrame) *samplesPerFrame = samplesPerFrameTab[ver][2];
+    if (brIdx == 0) return 0;
+    return slotTab[ver][srIdx][brIdx] + ((hdr[2] >> 1) & 0x01);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 /*
  * Function:    MP3ClearBadFrame
  *
@@ -1007,6 +767,76 @@ void MP3Decoder::MP3ClearBadFrame(int16_t* outbuf) {
     for (i = 0; i < m_MP3DecInfo->nGrans * m_MP3DecInfo->nGranSamps * m_MP3DecInfo->nChans; i++) outbuf[i] = 0;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+/*
+ * Function:    SaveConcealGranule
+ *
+ * Description: keep the dequantized spectrum of a good granule for MP3ConcealBadFrame()
+ *
+ * Inputs:      granule index, after MP3Dequantize(), before IMDCT() (antialias works in place)
+ *
+ * Outputs:     m_ConcealInfo
+ *
+ * Return:      none
+ */
+void MP3Decoder::SaveConcealGranule(int32_t gr) {
+    ConcealInfo_t* ci = m_ConcealInfo.get();
+    for (int32_t ch = 0; ch < m_MP3DecInfo->nChans; ch++) {
+        ci->nonZeroBound[ch] = m_HuffmanInfo->nonZeroBound[ch]; /* above are zeros only */
+        ci->gb[ch] = m_HuffmanInfo->gb[ch];
+        ci->sis[ch] = m_SideInfoSub[gr][ch];
+        memcpy(ci->coef[ch], m_HuffmanInfo->huffDecBuf[ch], ci->nonZeroBound[ch] * sizeof(int32_t));
+    }
+    ci->nChans = m_MP3DecInfo->nChans;
+    ci->nGranSamps = m_MP3DecInfo->nGranSamps;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+/*
+ * Function:    MP3ConcealBadFrame
+ *
+ * Description: replace the granules gr ... nGrans - 1 of a bad frame by the last good spectrum, -3dB per granule,
+ *              random signs above subband 1 so that the repetition doesn't buzz
+ *              the spectrum goes through IMDCT and synthesis as usual, overlap-add and filterbank stay continuous
+ *              after MP3_CONCEAL_FRAMES bad frames in a row the frame is dropped (silence, resync)
+ *
+ * Inputs:      valid frame header and side info of the bad frame, pcm output buffer, first bad granule
+ *
+ * Outputs:     pcm data of the whole frame, the granules before gr are decoded already
+ *
+ * Return:      MP3_NONE if concealed, MP3_ERR if not
+ */
+int32_t MP3Decoder::MP3ConcealBadFrame(int16_t* outbuf, int32_t gr) {
+    ConcealInfo_t* ci = m_ConcealInfo.get();
+    int32_t        ch, i;
+
+    m_stats.corruptFrames++;
+    if (ci->nChans != m_MP3DecInfo->nChans || ci->nGranSamps != m_MP3DecInfo->nGranSamps || ci->frames >= MP3_CONCEAL_FRAMES) {
+        MP3ClearBadFrame(outbuf);
+        return MP3_ERR;
+    }
+    ci->frames++;
+    for (; gr < m_MP3DecInfo->nGrans; gr++) {
+        for (ch = 0; ch < ci->nChans; ch++) {
+            int32_t* x = ci->coef[ch];
+            for (i = 0; i < ci->nonZeroBound[ch]; i++) {
+                x[i] = MULSHIFT32(x[i], 0x5a82799a) << 1; /* 1/sqrt(2) */
+                if (i < 2 * 18) continue;
+                ci->seed = ci->seed * 1664525 + 1013904223;
+                if (ci->seed & 0x80000000) x[i] = -x[i];
+            }
+            memcpy(m_HuffmanInfo->huffDecBuf[ch], x, ci->nonZeroBound[ch] * sizeof(int32_t));
+            memset(m_HuffmanInfo->huffDecBuf[ch] + ci->nonZeroBound[ch], 0, (MAX_NSAMP - ci->nonZeroBound[ch]) * sizeof(int32_t));
+            m_HuffmanInfo->nonZeroBound[ch] = ci->nonZeroBound[ch];
+            m_HuffmanInfo->gb[ch] = ci->gb[ch]; /* attenuated, at least as many guard bits */
+            m_SideInfoSub[gr][ch] = ci->sis[ch];
+            IMDCT(gr, ch);
+        }
+        Subband(outbuf + gr * m_MP3DecInfo->nGranSamps * m_MP3DecInfo->nChans);
+    }
+    MP3GetLastFrameInfo();
+    m_stats.concealedFrames++;
+    return MP3_NONE;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 /*
  * Function:    MP3Decode
  *
@@ -1031,14 +861,16 @@ int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf)
     int32_t        offset, bitOffset, mainBits, gr, ch, fhBytes, siBytes, freeFrameBytes;
     int32_t        prevBitOffset, sfBlockBits, huffBlockBits;
     uint8_t*       mainPtr;
-    static uint8_t underflowCounter = 0; // http://macslons-irish-pub-radio.stream.laut.fm/macslons-irish-pub-radio
     /* unpack frame header */
     fhBytes = UnpackFrameHeader(inbuf);
     if (fhBytes < 0) {
         MP3_LOG_ERROR("MP3 invalid frameheader"); /* don't clear outbuf since we don't know size (failed to parse header) */
+        m_MP3DecInfo->mainDataBytes = 0;          /* the main data of this frame is lost, the bit reservoir is not usable */
+        m_stats.corruptFrames++;
         return MP3_ERR;
     }
     inbuf += fhBytes;
+    m_halfRate = mp3LowPower(); /* per frame, setMp3LowPower() */
     /* unpack side info */
     siBytes = UnpackSideInfo(inbuf);
     if (siBytes < 0) {
@@ -1098,7 +930,7 @@ int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf)
     /* fill main data buffer with enough new data for this frame */
     if (m_MP3DecInfo->mainDataBytes >= m_MP3DecInfo->mainDataBegin) {
         /* adequate "old" main data available (i.e. bit reservoir) */
-        underflowCounter = 0;
+        m_underflowCounter = 0;
         memmove(m_MP3DecInfo->mainBuf, m_MP3DecInfo->mainBuf + m_MP3DecInfo->mainDataBytes - m_MP3DecInfo->mainDataBegin, m_MP3DecInfo->mainDataBegin);
         memcpy(m_MP3DecInfo->mainBuf + m_MP3DecInfo->mainDataBegin, inbuf, m_MP3DecInfo->nSlots);
 
@@ -1108,12 +940,16 @@ int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf)
         mainPtr = m_MP3DecInfo->mainBuf;
     } else {
         /* not enough data in bit reservoir from previous frames (perhaps starting in middle of file) */
-        underflowCounter++;
+        m_underflowCounter++;
         memcpy(m_MP3DecInfo->mainBuf + m_MP3DecInfo->mainDataBytes, inbuf, m_MP3DecInfo->nSlots);
         m_MP3DecInfo->mainDataBytes += m_MP3DecInfo->nSlots;
         inbuf += m_MP3DecInfo->nSlots;
         *bytesLeft -= (m_MP3DecInfo->nSlots);
-        if (underflowCounter < 4) { return MP3_NONE; }
+        if (m_ConcealInfo->nChans) { /* frames were lost (resync), not the start of the stream */
+            MP3_LOG_ERROR("MP3, maindata underflow");
+            return MP3ConcealBadFrame(outbuf, 0);
+        }
+        if (m_underflowCounter < 4) { return MP3_NONE; }
         MP3ClearBadFrame(outbuf);
         MP3_LOG_ERROR("MP3, maindata underflow");
         return MP3_ERR;
@@ -1134,26 +970,45 @@ int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf)
             mainBits -= sfBlockBits;
 
             if (offset < 0 || mainBits < huffBlockBits) {
-                MP3ClearBadFrame(outbuf);
                 MP3_LOG_ERROR("MP3, invalid scalefact");
-                return MP3_ERR;
+                return MP3ConcealBadFrame(outbuf, gr);
             }
             /* decode Huffman code words */
             prevBitOffset = bitOffset;
             offset = DecodeHuffman(mainPtr, &bitOffset, huffBlockBits, gr, ch);
             if (offset < 0) {
-                MP3ClearBadFrame(outbuf);
                 MP3_LOG_ERROR("MP3, invalid Huffman code words");
-                return MP3_ERR;
+                return MP3ConcealBadFrame(outbuf, gr);
             }
             mainPtr += offset;
             mainBits -= (8 * offset - prevBitOffset + bitOffset);
         }
         /* dequantize coefficients, decode stereo, reorder int16_t blocks */
         if (MP3Dequantize(gr) < 0) {
-            MP3ClearBadFrame(outbuf);
             MP3_LOG_ERROR("MP3, invalid dequantize coefficients");
-            return MP3_ERR;
+            return MP3ConcealBadFrame(outbuf, gr);
+        }
+        if (gr == m_MP3DecInfo->nGrans - 1 && MP3_CONCEAL_FRAMES) SaveConcealGranule(gr);
+
+        int16_t* pcm = outbuf + gr * m_MP3DecInfo->nGranSamps * m_MP3DecInfo->nChans;
+        if (m_MP3DecInfo->nChans == 2 && dualCoreDecoding() && workerStart("MP3Worker", [this] {
+                m_workerRet = IMDCT(m_workerGr, 1);
+                if (m_workerRet >= 0) SubbandChannel(m_workerPcm, 1);
+            })) {
+            /* from here on the channels are independent, channel 1 runs on the other core, join per granule */
+            m_workerGr = gr;
+            m_workerPcm = pcm;
+            workerRun();
+            int32_t ret = IMDCT(gr, 0);
+            if (ret >= 0) SubbandChannel(pcm, 0);
+            workerJoin();
+            if (ret < 0 || m_workerRet < 0) {
+                MP3ClearBadFrame(outbuf);
+                MP3_LOG_ERROR("MP3, invalid inverse MDCT");
+                return MP3_ERR;
+            }
+            m_SubbandInfo->vindex = (m_SubbandInfo->vindex - BLOCK_SIZE / 2) & 7; /* as after Subband() */
+            continue;
         }
 
         /* alias reduction, inverse MDCT, overlap-add, frequency inversion */
@@ -1165,13 +1020,15 @@ int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf)
             }
         }
         /* subband transform - if stereo, interleaves pcm LRLRLR */
-        if (Subband(outbuf + gr * m_MP3DecInfo->nGranSamps * m_MP3DecInfo->nChans) < 0) {
+        if (Subband(pcm) < 0) {
             MP3ClearBadFrame(outbuf);
             MP3_LOG_ERROR("MP3, invalid subband");
             return MP3_ERR;
         }
     }
     MP3GetLastFrameInfo();
+    m_ConcealInfo->frames = 0;
+    m_stats.decodedFrames++;
     return MP3_NONE;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
@@ -1179,6 +1036,117 @@ int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf)
  * H U F F M A N N
  */
 
+/* bit cache for the Huffman decoder, starts at bitOffset (0 = MSB) of buf[0], bitsLeft bits from there on */
+static inline void huffRefill(HuffBits_t* b) {
+    if (b->bitsLeft >= 64) { /* 8 bytes at once, the bits behind cachedBits are the next ones of the stream anyway */
+        uint64_t v;
+        memcpy(&v, b->buf, 8);
+        b->cache |= __builtin_bswap64(v) >> b->cachedBits;
+        int32_t n = (63 - b->cachedBits) >> 3;
+        b->buf += n;
+        b->cachedBits += n << 3;
+        b->bitsLeft -= n << 3;
+        return;
+    }
+    while (b->cachedBits <= 56 && b->bitsLeft > 0) {
+        b->cache |= (uint64_t)(*b->buf++) << (56 - b->cachedBits);
+        if (b->bitsLeft < 8) { /* last byte, the bits behind the Huffman data are 0 */
+            b->cachedBits += b->bitsLeft;
+            b->bitsLeft = 0;
+            b->cache &= ~0ULL << (64 - b->cachedBits);
+            break;
+        }
+        b->cachedBits += 8;
+        b->bitsLeft -= 8;
+    }
+}
+
+static inline void huffSkip(HuffBits_t* b, int32_t n) {
+    b->cache <<= n;
+    b->cachedBits -= n;
+}
+
+static inline void huffSign(HuffBits_t* b, int32_t* v) { /* sign bit follows every non zero value, sign/magnitude like Helix */
+    if (*v) {
+        *v |= (int32_t)((uint32_t)(b->cache >> 32) & 0x80000000u);
+        b->cache <<= 1;
+        b->cachedBits--;
+    }
+}
+
+static inline void huffBitsInit(HuffBits_t* b, const uint8_t* buf, int32_t bitOffset, int32_t bitsLeft) {
+    b->buf = buf;
+    b->cache = 0;
+    b->cachedBits = 0;
+    b->bitsLeft = bitsLeft + bitOffset;
+    huffRefill(b);
+    b->cache <<= bitOffset;
+    b->cachedBits -= bitOffset;
+}
+
+static inline int32_t huffBitsUsed(const HuffBits_t* b, int32_t bitsLeft) { /* cachedBits < 0: more bits used than available */
+    return bitsLeft - b->bitsLeft - b->cachedBits;
+}
+
+/* Helix pair table: t[0] = bits of this level, then 2^bits codewords, len 0: next level at t + cw. Returns the code length */
+static inline int32_t huffTreeWalk(const uint16_t* t, uint64_t cache, uint16_t* cw) {
+    int32_t used = 0;
+    while (true) {
+        int32_t  maxBits = pgm_read_word(&t[0]) & 0x000f;
+        uint16_t e = pgm_read_word(&t[1 + ((cache << used) >> (64 - maxBits))]);
+        int32_t  len = (e >> 12) & 0x000f;
+        if (len) {
+            *cw = e;
+            return used + len;
+        }
+        used += maxBits;
+        t += e;
+    }
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool MP3Decoder::buildHuffLut() {
+    // one lookup for all codes up to MP3_HUFF_LUT_BITS, longer codes (len 0) are decoded from huffTable
+    // tables 16...23 and 24...31 differ in linbits only and share their first level
+    int32_t size = 0;
+    for (int32_t t = 0; t < HUFF_PAIRTABS; t++) {
+        m_huffLutBits[t] = 0;
+        m_huffLutOffset[t] = 0;
+        int32_t type = huffTabLookup[t].tabType;
+        if (type != oneShot && type != loopNoLinbits && type != loopLinbits) continue;
+        int32_t s = 0;
+        while (s < t && !(m_huffLutBits[s] && huffTabOffset[s] == huffTabOffset[t])) s++;
+        if (s < t) { // shared
+            m_huffLutBits[t] = m_huffLutBits[s];
+            m_huffLutOffset[t] = m_huffLutOffset[s];
+            continue;
+        }
+        int32_t bits = MP3_HUFF_LUT_BITS;
+        if (type == oneShot) bits = std::min<int32_t>(bits, pgm_read_word(&huffTable[huffTabOffset[t]]) & 0x000f); // already flat
+        m_huffLutBits[t] = bits;
+        m_huffLutOffset[t] = size;
+        size += 1 << bits;
+    }
+    if (!m_huffLut.alloc(size * sizeof(uint16_t), "m_huffLut", MP3_HUFF_LUT_PSRAM)) return false;
+
+    for (int32_t t = 0; t < HUFF_PAIRTABS; t++) {
+        if (!m_huffLutBits[t]) continue;
+        int32_t s = 0; // the first table with this slot fills it, not huffTabOffset: table 1 has offset 0 like the empty table 0
+        while (s < t && !(m_huffLutBits[s] && m_huffLutOffset[s] == m_huffLutOffset[t])) s++;
+        if (s < t) continue; // filled already
+        const uint16_t* tBase = huffTable + huffTabOffset[t];
+        uint16_t*       lut = m_huffLut.get() + m_huffLutOffset[t];
+        int32_t         bits = m_huffLutBits[t];
+        for (uint32_t p = 0; p < (1u << bits); p++) {
+            uint16_t cw = 0;
+            int32_t  len = huffTreeWalk(tBase, (uint64_t)p << (64 - bits), &cw); // the bits behind p are 0
+            lut[p] = (len <= bits) ? (len << 12) | (cw & 0x0ff0) : 0;
+        }
+    }
+    return true;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+
+
 /*
  * Function:    DecodeHuffmanPairs
  *
@@ -1202,25 +1170,12 @@ int32_t MP3Decoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf)
 // no improvement with section=data
 
 int32_t MP3Decoder::DecodeHuffmanPairs(int32_t* xy, int32_t nVals, int32_t tabIdx, int32_t bitsLeft, uint8_t* buf, int32_t bitOffset) {
-    int32_t       i, x, y;
-    int32_t       cachedBits, padBits, len, startBits, linBits, maxBits, minBits;
     HuffTabType_t tabType;
-    uint16_t      cw, *tBase, *tCurr;
-    uint32_t      cache;
+    HuffBits_t    b;
 
     if (nVals <= 0) return 0;
 
     if (bitsLeft < 0) return -1;
-    startBits = bitsLeft;
-
-    tBase = (uint16_t*)(huffTable + huffTabOffset[tabIdx]);
-    linBits = huffTabLookup[tabIdx].linBits;
-    tabType = (HuffTabType_t)huffTabLookup[tabIdx].tabType;
-
-    //    assert(!(nVals & 0x01));
-    //    assert(tabIdx < m_HUFF_PAIRTABS);
-    //    assert(tabIdx >= 0);
-    //    assert(tabType != invalidTab);
 
     if ((nVals & 0x01)) {
         MP3_LOG_DEBUG("assert(!(nVals & 0x01))");
@@ -1234,192 +1189,55 @@ int32_t MP3Decoder::DecodeHuffmanPairs(int32_t* xy, int32_t nVals, int32_t tabId
         MP3_LOG_DEBUG("(tabIdx >= 0)");
         return -1;
     }
+    tabType = (HuffTabType_t)huffTabLookup[tabIdx].tabType;
     if (!(tabType != invalidTab)) {
         MP3_LOG_DEBUG("(tabType != invalidTab)");
         return -1;
     }
 
-    /* initially fill cache with any partial byte */
-    cache = 0;
-    cachedBits = (8 - bitOffset) & 0x07;
-    if (cachedBits) cache = (uint32_t)(*buf++) << (32 - cachedBits);
-    bitsLeft -= cachedBits;
-
     if (tabType == noBits) {
         /* table 0, no data, x = y = 0 */
-        for (i = 0; i < nVals; i += 2) {
+        for (int32_t i = 0; i < nVals; i += 2) {
             xy[i + 0] = 0;
             xy[i + 1] = 0;
         }
         return 0;
-    } else if (tabType == oneShot) {
-        /* single lookup, no escapes */
-
-        maxBits = (int32_t)((((uint16_t)(pgm_read_word(&tBase[0])) >> 0) & 0x000f));
-        tBase++;
-        padBits = 0;
-        while (nVals > 0) {
-            /* refill cache - assumes cachedBits <= 16 */
-            if (bitsLeft >= 16) {
-                /* load 2 new bytes into left-justified cache */
-                cache |= (uint32_t)(*buf++) << (24 - cachedBits);
-                cache |= (uint32_t)(*buf++) << (16 - cachedBits);
-                cachedBits += 16;
-                bitsLeft -= 16;
-            } else {
-                /* last time through, pad cache with zeros and drain cache */
-                if (cachedBits + bitsLeft <= 0) { return -1; }
-                if (bitsLeft > 0) cache |= (uint32_t)(*buf++) << (24 - cachedBits);
-                if (bitsLeft > 8) cache |= (uint32_t)(*buf++) << (16 - cachedBits);
-                cachedBits += bitsLeft;
-                bitsLeft = 0;
-
-                cache &= (int32_t)0x80000000 >> (cachedBits - 1);
-                padBits = 11;
-                cachedBits += padBits; /* okay if this is > 32 (0's automatically shifted in from right) */
-            }
-
-            /* largest maxBits = 9, plus 2 for sign bits, so make sure cache has at least 11 bits */
-            while (nVals > 0 && cachedBits >= 11) {
-                cw = pgm_read_word(&tBase[cache >> (32 - maxBits)]);
-
-                len = (int32_t)((((uint16_t)(cw)) >> 12) & 0x000f);
-                cachedBits -= len;
-                cache <<= len;
+    }
 
-                x = (int32_t)((((uint16_t)(cw)) >> 4) & 0x000f);
-                if (x) {
-                    (x) |= ((cache) & 0x80000000);
-                    cache <<= 1;
-                    cachedBits--;
-                }
+    const uint16_t* tBase = huffTable + huffTabOffset[tabIdx];
+    const uint16_t* lut = m_huffLut.get() + m_huffLutOffset[tabIdx];
+    const int32_t   lutBits = m_huffLutBits[tabIdx];
+    const int32_t   linBits = huffTabLookup[tabIdx].linBits; // 0 for the tables without linbits
 
-                y = (int32_t)((((uint16_t)(cw)) >> 8) & 0x000f);
-                if (y) {
-                    (y) |= ((cache) & 0x80000000);
-                    cache <<= 1;
-                    cachedBits--;
-                }
+    huffBitsInit(&b, buf, bitOffset, bitsLeft);
+    while (nVals > 0) {
+        if (b.cachedBits < 48) huffRefill(&b); // codeword (max 19 bits) + 2 * (linbits (max 13) + sign) = 47
+        uint16_t cw = lut[b.cache >> (64 - lutBits)];
+        int32_t  len = (cw >> 12) & 0x000f;
+        if (!len) len = huffTreeWalk(tBase, b.cache, &cw); // codes longer than the first level, rare
+        huffSkip(&b, len);
 
-                /* ran out of bits - should never have consumed padBits */
-                if (cachedBits < padBits) {
-                    break; // https://bestof80s.stream.laut.fm/best_of_80s (after advertising)
-                    //    return -1;
-                }
-
-                *xy++ = x;
-                *xy++ = y;
-                nVals -= 2;
-            }
+        int32_t x = (cw >> 4) & 0x000f;
+        int32_t y = (cw >> 8) & 0x000f;
+        if (linBits && x == 15) {
+            x += (int32_t)(b.cache >> (64 - linBits));
+            huffSkip(&b, linBits);
         }
-        bitsLeft += (cachedBits - padBits);
-        return (startBits - bitsLeft);
-    } else if (tabType == loopLinbits || tabType == loopNoLinbits) {
-        tCurr = tBase;
-        padBits = 0;
-        while (nVals > 0) {
-            /* refill cache - assumes cachedBits <= 16 */
-            if (bitsLeft >= 16) {
-                /* load 2 new bytes into left-justified cache */
-                cache |= (uint32_t)(*buf++) << (24 - cachedBits);
-                cache |= (uint32_t)(*buf++) << (16 - cachedBits);
-                cachedBits += 16;
-                bitsLeft -= 16;
-            } else {
-                /* last time through, pad cache with zeros and drain cache */
-                if (cachedBits + bitsLeft <= 0) { return -1; }
-                if (bitsLeft > 0) cache |= (uint32_t)(*buf++) << (24 - cachedBits);
-                if (bitsLeft > 8) cache |= (uint32_t)(*buf++) << (16 - cachedBits);
-                cachedBits += bitsLeft;
-                bitsLeft = 0;
-
-                cache &= (int32_t)0x80000000 >> (cachedBits - 1);
-                padBits = 11;
-                cachedBits += padBits; /* okay if this is > 32 (0's automatically shifted in from right) */
-            }
-
-            /* largest maxBits = 9, plus 2 for sign bits, so make sure cache has at least 11 bits */
-            while (nVals > 0 && cachedBits >= 11) {
-                maxBits = (int32_t)((((uint16_t)(pgm_read_word(&tCurr[0]))) >> 0) & 0x000f);
-                cw = pgm_read_word(&tCurr[(cache >> (32 - maxBits)) + 1]);
-                len = (int32_t)((((uint16_t)(cw)) >> 12) & 0x000f);
-                if (!len) {
-                    cachedBits -= maxBits;
-                    cache <<= maxBits;
-                    tCurr += cw;
-                    continue;
-                }
-                cachedBits -= len;
-                cache <<= len;
-
-                x = (int32_t)((((uint16_t)(cw)) >> 4) & 0x000f);
-                y = (int32_t)((((uint16_t)(cw)) >> 8) & 0x000f);
-
-                if (x == 15 && tabType == loopLinbits) {
-                    minBits = linBits + 1 + (y ? 1 : 0);
-                    if (cachedBits + bitsLeft < minBits) return -1;
-                    while (cachedBits < minBits) {
-                        cache |= (uint32_t)(*buf++) << (24 - cachedBits);
-                        cachedBits += 8;
-                        bitsLeft -= 8;
-                    }
-                    if (bitsLeft < 0) {
-                        cachedBits += bitsLeft;
-                        bitsLeft = 0;
-                        cache &= (int32_t)0x80000000 >> (cachedBits - 1);
-                    }
-                    x += (int32_t)(cache >> (32 - linBits));
-                    cachedBits -= linBits;
-                    cache <<= linBits;
-                }
-                if (x) {
-                    (x) |= ((cache) & 0x80000000);
-                    cache <<= 1;
-                    cachedBits--;
-                }
-
-                if (y == 15 && tabType == loopLinbits) {
-                    minBits = linBits + 1;
-                    if (cachedBits + bitsLeft < minBits) break; // https://bestof80s.stream.laut.fm/best_of_80s (after advertising)
-                    // return -1;
-                    while (cachedBits < minBits) {
-                        cache |= (uint32_t)(*buf++) << (24 - cachedBits);
-                        cachedBits += 8;
-                        bitsLeft -= 8;
-                    }
-                    if (bitsLeft < 0) {
-                        cachedBits += bitsLeft;
-                        bitsLeft = 0;
-                        cache &= (int32_t)0x80000000 >> (cachedBits - 1);
-                    }
-                    y += (int32_t)(cache >> (32 - linBits));
-                    cachedBits -= linBits;
-                    cache <<= linBits;
-                }
-                if (y) {
-                    (y) |= ((cache) & 0x80000000);
-                    cache <<= 1;
-                    cachedBits--;
-                }
+        huffSign(&b, &x);
+        if (linBits && y == 15) {
+            y += (int32_t)(b.cache >> (64 - linBits));
+            huffSkip(&b, linBits);
+        }
+        huffSign(&b, &y);
 
-                /* ran out of bits - should never have consumed padBits */
-                if (cachedBits < padBits) {
-                    break; // https://bestof80s.stream.laut.fm/best_of_80s (after advertising)
-                    // return -1;
-                }
+        /* ran out of bits - the caller sees bitsUsed > bitsLeft */
+        if (b.cachedBits < 0) break;
 
-                *xy++ = x;
-                *xy++ = y;
-                nVals -= 2;
-                tCurr = tBase;
-            }
-        }
-        bitsLeft += (cachedBits - padBits);
-        return (startBits - bitsLeft);
+        *xy++ = x;
+        *xy++ = y;
+        nVals -= 2;
     }
-
-    /* error in bitstream - trying to access unused Huffman table */
-    return -1;
+    return huffBitsUsed(&b, bitsLeft);
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 /*
@@ -1443,87 +1261,37 @@ int32_t MP3Decoder::DecodeHuffmanPairs(int32_t* xy, int32_t nVals, int32_t tabId
  */
 // no improvement with section=data
 int32_t MP3Decoder::DecodeHuffmanQuads(int32_t* vwxy, int32_t nVals, int32_t tabIdx, int32_t bitsLeft, uint8_t* buf, int32_t bitOffset) {
-    int32_t  i, v, w, x, y;
-    int32_t  len, maxBits, cachedBits, padBits;
-    uint32_t cache;
-    uint8_t  cw, *tBase;
+    int32_t     i = 0;
+    HuffBits_t  b;
 
     if (bitsLeft <= 0) return 0;
 
-    tBase = (uint8_t*)quadTable + quadTabOffset[tabIdx];
-    maxBits = quadTabMaxBits[tabIdx];
+    const uint8_t* tBase = (uint8_t*)quadTable + quadTabOffset[tabIdx];
+    const int32_t  maxBits = quadTabMaxBits[tabIdx];
 
-    /* initially fill cache with any partial byte */
-    cache = 0;
-    cachedBits = (8 - bitOffset) & 0x07;
-    if (cachedBits) cache = (uint32_t)(*buf++) << (32 - cachedBits);
-    bitsLeft -= cachedBits;
-
-    i = padBits = 0;
+    huffBitsInit(&b, buf, bitOffset, bitsLeft);
     while (i < (nVals - 3)) {
-        /* refill cache - assumes cachedBits <= 16 */
-        if (bitsLeft >= 16) {
-            /* load 2 new bytes into left-justified cache */
-            cache |= (uint32_t)(*buf++) << (24 - cachedBits);
-            cache |= (uint32_t)(*buf++) << (16 - cachedBits);
-            cachedBits += 16;
-            bitsLeft -= 16;
-        } else {
-            /* last time through, pad cache with zeros and drain cache */
-            if (cachedBits + bitsLeft <= 0) return i;
-            if (bitsLeft > 0) cache |= (uint32_t)(*buf++) << (24 - cachedBits);
-            if (bitsLeft > 8) cache |= (uint32_t)(*buf++) << (16 - cachedBits);
-            cachedBits += bitsLeft;
-            bitsLeft = 0;
-
-            cache &= (int32_t)0x80000000 >> (cachedBits - 1);
-            padBits = 10;
-            cachedBits += padBits; /* okay if this is > 32 (0's automatically shifted in from right) */
-        }
-
-        /* largest maxBits = 6, plus 4 for sign bits, so make sure cache has at least 10 bits */
-        while (i < (nVals - 3) && cachedBits >= 10) {
-            cw = pgm_read_byte(&tBase[cache >> (32 - maxBits)]);
-            len = (int32_t)((((uint8_t)(cw)) >> 4) & 0x0f);
-            cachedBits -= len;
-            cache <<= len;
-
-            v = (int32_t)((((uint8_t)(cw)) >> 3) & 0x01);
-            if (v) {
-                (v) |= ((cache) & 0x80000000);
-                cache <<= 1;
-                cachedBits--;
-            }
-            w = (int32_t)((((uint8_t)(cw)) >> 2) & 0x01);
-            if (w) {
-                (w) |= ((cache) & 0x80000000);
-                cache <<= 1;
-                cachedBits--;
-            }
+        if (b.cachedBits < 10) huffRefill(&b); // max 6 bits + 4 signs
+        uint8_t cw = pgm_read_byte(&tBase[b.cache >> (64 - maxBits)]);
+        huffSkip(&b, (cw >> 4) & 0x0f);
 
-            x = (int32_t)((((uint8_t)(cw)) >> 1) & 0x01);
-            if (x) {
-                (x) |= ((cache) & 0x80000000);
-                cache <<= 1;
-                cachedBits--;
-            }
-
-            y = (int32_t)((((uint8_t)(cw)) >> 0) & 0x01);
-            if (y) {
-                (y) |= ((cache) & 0x80000000);
-                cache <<= 1;
-                cachedBits--;
-            }
+        int32_t v = (cw >> 3) & 0x01;
+        int32_t w = (cw >> 2) & 0x01;
+        int32_t x = (cw >> 1) & 0x01;
+        int32_t y = (cw >> 0) & 0x01;
+        huffSign(&b, &v);
+        huffSign(&b, &w);
+        huffSign(&b, &x);
+        huffSign(&b, &y);
 
-            /* ran out of bits - okay (means we're done) */
-            if (cachedBits < padBits) return i;
+        /* ran out of bits - okay (means we're done) */
+        if (b.cachedBits < 0) return i;
 
-            *vwxy++ = v;
-            *vwxy++ = w;
-            *vwxy++ = x;
-            *vwxy++ = y;
-            i += 4;
-        }
+        *vwxy++ = v;
+        *vwxy++ = w;
+        *vwxy++ = x;
+        *vwxy++ = y;
+        i += 4;
     }
 
     /* decoded max number of quad values */
@@ -2939,7 +2707,7 @@ int32_t MP3Decoder::IMDCT(int32_t gr, int32_t ch) {
     if (m_SideInfoSub[gr][ch].blockType != 2) {
         /* all long transforms */
         int32_t x = (m_HuffmanInfo->nonZeroBound[ch] + 7) / 18 + 1;
-        bc.nBlocksLong = (x < 32 ? x : 32);
+        bc.nBlocksLong = (x < (NBANDS >> m_halfRate) ? x : (NBANDS >> m_halfRate));
         // bc.nBlocksLong = min((hi->nonZeroBound[ch] + 7) / 18 + 1, 32);
         nBfly = bc.nBlocksLong - 1;
     } else if (m_SideInfoSub[gr][ch].blockType == 2 && m_SideInfoSub[gr][ch].mixedBlock) {
@@ -2956,6 +2724,7 @@ int32_t MP3Decoder::IMDCT(int32_t gr, int32_t ch) {
     int32_t x = m_HuffmanInfo->nonZeroBound[ch];
     int32_t y = nBfly * 18 + 8;
     m_HuffmanInfo->nonZeroBound[ch] = (x > y ? x : y);
+    if (m_halfRate && m_HuffmanInfo->nonZeroBound[ch] > MAX_NSAMP / 2) m_HuffmanInfo->nonZeroBound[ch] = MAX_NSAMP / 2; /* upper 16 subbands not transformed */
 
     assert(m_HuffmanInfo->nonZeroBound[ch] <= MAX_NSAMP);
 
@@ -2997,6 +2766,12 @@ int32_t MP3Decoder::IMDCT(int32_t gr, int32_t ch) {
  */
 int32_t MP3Decoder::Subband(int16_t* pcmBuf) {
     int32_t b;
+    if (m_halfRate) { /* low power, per channel */
+        for (b = 0; b < m_MP3DecInfo->nChans; b++) SubbandChannel(pcmBuf, b);
+        m_SubbandInfo->vindex = (m_SubbandInfo->vindex - BLOCK_SIZE / 2) & 7;
+        return 0;
+    }
+    int16_t* pcm = pcmBuf;
     if (m_MP3DecInfo->nChans == 2) {
         /* stereo */
         for (b = 0; b < BLOCK_SIZE; b++) {
@@ -3015,10 +2790,54 @@ int32_t MP3Decoder::Subband(int16_t* pcmBuf) {
             pcmBuf += NBANDS;
         }
     }
-
+    for (b = 0; b < m_MP3DecInfo->nChans; b++) { /* in case the low power mode is switched on with the next frame */
+        for (int32_t k = 0; k < 3; k++) m_upsHist[b][k] = pcm[(MAX_NSAMP - 5 + 2 * k) * m_MP3DecInfo->nChans + b];
+    }
     return 0;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void MP3Decoder::SubbandChannel(int16_t* pcmBuf, int32_t ch) {
+    /* one channel of a granule, the same as Subband() for this channel: the FDCT32 writes and the polyphase
+     * reads only its half of vbuf, vindex is advanced by the caller when all channels are done */
+    const int32_t nChans = m_MP3DecInfo->nChans;
+    int32_t       vindex = m_SubbandInfo->vindex;
+    int16_t*      pcm = pcmBuf + ch;
+    for (int32_t b = 0; b < BLOCK_SIZE; b++) {
+        FDCT32(m_IMDCTInfo->outBuf[ch][b], m_SubbandInfo->vbuf + ch * 32, vindex, (b & 0x01), m_IMDCTInfo->gb[ch]);
+        if (m_halfRate) {
+            PolyphaseHalf(pcm, m_SubbandInfo->vbuf + ch * 32 + vindex + VBUF_LENGTH * (b & 0x01), polyCoef, nChans);
+            pcm += nChans * NBANDS / 2;
+        } else {
+            PolyphaseMono(pcm, m_SubbandInfo->vbuf + ch * 32 + vindex + VBUF_LENGTH * (b & 0x01), polyCoef, nChans);
+            pcm += nChans * NBANDS;
+        }
+        vindex = (vindex - (b & 0x01)) & 7;
+    }
+    if (m_halfRate) Upsample2x(pcmBuf + ch, MAX_NSAMP / 2, ch);
+    else
+        for (int32_t k = 0; k < 3; k++) m_upsHist[ch][k] = pcmBuf[(MAX_NSAMP - 5 + 2 * k) * nChans + ch];
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void MP3Decoder::Upsample2x(int16_t* pcm, int32_t n, int32_t ch) {
+    /* low power mode: n samples at half rate -> 2n, in place from the end, one channel (step nChans)
+     * even outputs are the input delayed by two, odd outputs the 4 tap midpoint (-1 9 9 -1) / 16 */
+    const int32_t step = m_MP3DecInfo->nChans;
+    int16_t*      h = m_upsHist[ch]; /* x[-3], x[-2], x[-1] */
+    int16_t       last[3] = {pcm[(n - 3) * step], pcm[(n - 2) * step], pcm[(n - 1) * step]};
+    for (int32_t i = n - 1; i >= 0; i--) {
+        int32_t a = i >= 3 ? pcm[(i - 3) * step] : h[i];
+        int32_t b = i >= 2 ? pcm[(i - 2) * step] : h[i + 1];
+        int32_t c = i >= 1 ? pcm[(i - 1) * step] : h[i + 2];
+        int32_t d = pcm[i * step];
+        int32_t y = (9 * (b + c) - a - d + 8) >> 4;
+        if (y > 32767) y = 32767;
+        if (y < -32768) y = -32768;
+        pcm[(2 * i + 1) * step] = (int16_t)y;
+        pcm[2 * i * step] = (int16_t)b;
+    }
+    memcpy(h, last, sizeof(last));
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void MP3Decoder::FDCT32(int32_t* buf, int32_t* dest, int32_t offset, int32_t oddBlock, int32_t gb) {
     int32_t        i, s, tmp, es;
     const int32_t* cptr = (const int32_t*)m_dcttab;
@@ -3283,10 +3102,11 @@ int16_t MP3Decoder::ClipToShort(int32_t x, int32_t fracBits) {
  *                (see additional scaling comments below)
  *
  * Outputs:     32 samples of one channel of decoded PCM data, (i.e. Q16.0)
+ *              step 2: one channel of interleaved stereo (dual core decoding)
  *
  * Return:      none
  */
-void MP3Decoder::PolyphaseMono(int16_t* pcm, int32_t* vbuf, const uint32_t* coefBase) {
+void MP3Decoder::PolyphaseMono(int16_t* pcm, int32_t* vbuf, const uint32_t* coefBase, int32_t step) {
     int32_t         i;
     const uint32_t* coef;
     int32_t*        vb1;
@@ -3321,12 +3141,12 @@ void MP3Decoder::PolyphaseMono(int16_t* pcm, int32_t* vbuf, const uint32_t* coef
         vLo = *(vb1 + (j));
         sum1L = MADD64(sum1L, vLo, c1); // 0...7
     }
-    *(pcm + 16) = ClipToShort((int32_t)SAR64(sum1L, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
+    *(pcm + 16 * step) = ClipToShort((int32_t)SAR64(sum1L, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
 
     /* main convolution loop: sum1L = samples 1, 2, 3, ... 15   sum2L = samples 31, 30, ... 17 */
     coef = coefBase + 16;
     vb1 = vbuf + 64;
-    pcm++;
+    pcm += step;
 
     /* right now, the compiler creates bad asm from this... */
     for (i = 15; i > 0; i--) {
@@ -3345,8 +3165,78 @@ void MP3Decoder::PolyphaseMono(int16_t* pcm, int32_t* vbuf, const uint32_t* coef
         }
         vb1 += 64;
         *(pcm) = ClipToShort((int32_t)SAR64(sum1L, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
-        *(pcm + 2 * i) = ClipToShort((int32_t)SAR64(sum2L, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
-        pcm++;
+        *(pcm + 2 * i * step) = ClipToShort((int32_t)SAR64(sum2L, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
+        pcm += step;
+    }
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+/*
+ * Function:    PolyphaseHalf
+ *
+ * Description: as PolyphaseMono, but only the even output samples 0, 2, ... 30 (low power mode)
+ *              the upper 16 subbands are zero, the result is bandlimited to the half samplerate
+ *
+ * Inputs:      see PolyphaseMono
+ *
+ * Outputs:     16 samples of one channel of decoded PCM data, every step-th int16_t
+ *
+ * Return:      none
+ */
+void MP3Decoder::PolyphaseHalf(int16_t* pcm, int32_t* vbuf, const uint32_t* coefBase, int32_t step) {
+    const uint32_t* coef;
+    int32_t*        vb1;
+    int32_t         vLo, vHi, c1, c2;
+    uint64_t        sum1L, sum2L, rndVal;
+
+    rndVal = (uint64_t)(1ULL << ((DQ_FRACBITS_OUT - 2 - 2 - 15) - 1 + (32 - CSHIFT)));
+
+    /* output sample 0 */
+    coef = coefBase;
+    vb1 = vbuf;
+    sum1L = rndVal;
+    for (int32_t j = 0; j < 8; j++) {
+        c1 = *coef;
+        coef++;
+        c2 = *coef;
+        coef++;
+        vLo = *(vb1 + (j));
+        vHi = *(vb1 + (23 - (j)));
+        sum1L = MADD64(sum1L, vLo, c1);
+        sum1L = MADD64(sum1L, vHi, -c2);
+    }
+    *(pcm + 0) = ClipToShort((int32_t)SAR64(sum1L, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
+
+    /* output sample 16 */
+    coef = coefBase + 256;
+    vb1 = vbuf + 64 * 16;
+    sum1L = rndVal;
+    for (int32_t j = 0; j < 8; j++) {
+        c1 = *coef;
+        coef++;
+        vLo = *(vb1 + (j));
+        sum1L = MADD64(sum1L, vLo, c1);
+    }
+    *(pcm + 8 * step) = ClipToShort((int32_t)SAR64(sum1L, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
+
+    /* sum1L = samples 2, 4, ... 14   sum2L = samples 30, 28, ... 18, the odd rows are skipped */
+    for (int32_t i = 2; i < 16; i += 2) {
+        coef = coefBase + 16 * i;
+        vb1 = vbuf + 64 * i;
+        sum1L = sum2L = rndVal;
+        for (int32_t j = 0; j < 8; j++) {
+            c1 = *coef;
+            coef++;
+            c2 = *coef;
+            coef++;
+            vLo = *(vb1 + (j));
+            vHi = *(vb1 + (23 - (j)));
+            sum1L = MADD64(sum1L, vLo, c1);
+            sum2L = MADD64(sum2L, vLo, c2);
+            sum1L = MADD64(sum1L, vHi, -c2);
+            sum2L = MADD64(sum2L, vHi, c1);
+        }
+        *(pcm + (i / 2) * step) = ClipToShort((int32_t)SAR64(sum1L, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
+        *(pcm + (16 - i / 2) * step) = ClipToShort((int32_t)SAR64(sum2L, (32 - CSHIFT)), DQ_FRACBITS_OUT - 2 - 2 - 15);
     }
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
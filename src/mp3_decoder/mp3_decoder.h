@@ -2,6 +2,7 @@
 #pragma once
 
 #include "../Audio.h"
+#include "../sync_scanner/sync_scanner.h"
 #include "structs.h"
 #include "tables.h"
 
@@ -31,6 +32,9 @@ class MP3Decoder : public Decoder {
     const char*           arg2() override;
     virtual int32_t       val1() override;
     virtual int32_t       val2() override;
+    Audio::decoderStats_t getStats() override { return m_stats; }
+    static int32_t        frameLength(const uint8_t* hdr, uint32_t* sampleRate, uint16_t* samplesPerFrame);
+    static int32_t        syncHeader(const uint8_t* hdr, uint32_t* fixed); // SyncScanner
 
     enum {
         MP3_NONE = 0,
@@ -57,14 +61,28 @@ class MP3Decoder : public Decoder {
     ps_ptr<IMDCTInfo_t>     m_IMDCTInfo;
     ps_ptr<SubbandInfo_t>   m_SubbandInfo;
     ps_ptr<MP3FrameInfo_t>  m_MP3FrameInfo;
+    ps_ptr<ConcealInfo_t>   m_ConcealInfo;
     ps_ptr<char>            m_mpeg_version_str;
+    ps_ptr<uint16_t>        m_huffLut;                      // first level of the pair tables, Helix codeword layout, len 0: longer code
+    uint16_t                m_huffLutOffset[HUFF_PAIRTABS]; // into m_huffLut
+    uint8_t                 m_huffLutBits[HUFF_PAIRTABS];
+    int32_t                 m_workerGr = 0;           // dual core mode: job of the worker, IMDCT and synthesis of channel 1
+    int16_t*                m_workerPcm = nullptr;
+    int32_t                 m_workerRet = 0;
+    SyncScanner             m_sync{syncHeader, 4, SYNCWORDL};
+    Audio::decoderStats_t   m_stats;
+    uint8_t                 m_underflowCounter = 0; // http://macslons-irish-pub-radio.stream.laut.fm/macslons-irish-pub-radio
+    int32_t                 m_halfRate = 0;             // low power mode of the current frame, 16 of 32 subbands
+    int16_t                 m_upsHist[MAX_NCHAN][3] = {}; // the last 3 half rate samples per channel, Upsample2x()
 
     // internally used
     void     MP3GetLastFrameInfo();
     int32_t  MP3GetNextFrameInfo(uint8_t* buf);
     int      MP3_AnalyzeFrame(const uint8_t* frame_data, size_t frame_len);
-    void     PolyphaseMono(int16_t* pcm, int32_t* vbuf, const uint32_t* coefBase);
+    void     PolyphaseMono(int16_t* pcm, int32_t* vbuf, const uint32_t* coefBase, int32_t step = 1);
     void     PolyphaseStereo(int16_t* pcm, int32_t* vbuf, const uint32_t* coefBase);
+    void     PolyphaseHalf(int16_t* pcm, int32_t* vbuf, const uint32_t* coefBase, int32_t step);
+    void     Upsample2x(int16_t* pcm, int32_t n, int32_t ch);
     void     SetBitstreamPointer(BitStreamInfo_t* bsi, int32_t nBytes, uint8_t* buf);
     uint32_t GetBits(BitStreamInfo_t* bsi, int32_t nBits);
     int32_t  CalcBitsUsed(BitStreamInfo_t* bsi, uint8_t* startBuf, int32_t startOffset);
@@ -82,14 +100,18 @@ class MP3Decoder : public Decoder {
     int32_t  IMDCT(int32_t gr, int32_t ch);
     int32_t  UnpackScaleFactors(uint8_t* buf, int32_t* bitOffset, int32_t bitsAvail, int32_t gr, int32_t ch);
     int32_t  Subband(int16_t* pcmBuf);
+    void     SubbandChannel(int16_t* pcmBuf, int32_t ch);
     int16_t  ClipToShort(int32_t x, int32_t fracBits);
     void     RefillBitstreamCache(BitStreamInfo_t* bsi);
     void     UnpackSFMPEG1(BitStreamInfo_t* bsi, SideInfoSub_t* sis, ScaleFactorInfoSub_t* sfis, int32_t* scfsi, int32_t gr, ScaleFactorInfoSub_t* sfisGr0);
     void     UnpackSFMPEG2(BitStreamInfo_t* bsi, SideInfoSub_t* sis, ScaleFactorInfoSub_t* sfis, int32_t gr, int32_t ch, int32_t modeExt, ScaleFactorJS_t* sfjs);
     int32_t  MP3FindFreeSync(uint8_t* buf, uint8_t firstFH[4], int32_t nBytes);
     void     MP3ClearBadFrame(int16_t* outbuf);
+    void     SaveConcealGranule(int32_t gr);
+    int32_t  MP3ConcealBadFrame(int16_t* outbuf, int32_t gr);
     int32_t  DecodeHuffmanPairs(int32_t* xy, int32_t nVals, int32_t tabIdx, int32_t bitsLeft, uint8_t* buf, int32_t bitOffset);
     int32_t  DecodeHuffmanQuads(int32_t* vwxy, int32_t nVals, int32_t tabIdx, int32_t bitsLeft, uint8_t* buf, int32_t bitOffset);
+    bool     buildHuffLut();
     int32_t  DequantBlock(int32_t* inbuf, int32_t* outbuf, int32_t num, int32_t scale);
     void     AntiAlias(int32_t* x, int32_t nBfly);
     void     WinPrevious(int32_t* xPrev, int32_t* xPrevWin, int32_t btPrev);
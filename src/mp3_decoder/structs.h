@@ -32,6 +32,16 @@
 #define MAX_NSAMP            576              // max samples per channel, per granule
 #define CLZ(x)               __builtin_clz(x) // fb
 
+#ifndef MP3_HUFF_LUT_BITS
+#define MP3_HUFF_LUT_BITS    8     // first level of the Huffman pair tables, 8 ... 10, 2^bits entries per table
+#endif
+#ifndef MP3_HUFF_LUT_PSRAM
+#define MP3_HUFF_LUT_PSRAM   false // first level tables in internal RAM
+#endif
+#ifndef MP3_CONCEAL_FRAMES
+#define MP3_CONCEAL_FRAMES   4     // bad frames in a row that are replaced by the faded last good granule, 0: dropped as before
+#endif
+
 #define CLIP_2N(y, n)       \
     {                       \
         int32_t x = 1 << n; \
@@ -153,6 +163,13 @@ typedef struct HuffTabLookup {
     int32_t tabType; /*HuffTabType*/
 } HuffTabLookup_t;
 
+typedef struct HuffBits { /* 64 bit left aligned cache, holds a whole pair incl. linbits and signs */
+    const uint8_t* buf;
+    uint64_t       cache;
+    int32_t        cachedBits; /* valid bits in cache, < 0 after an overrun */
+    int32_t        bitsLeft;   /* not yet loaded */
+} HuffBits_t;
+
 typedef struct IMDCTInfo {
     int32_t outBuf[MAX_NCHAN][BLOCK_SIZE][NBANDS]; /* output of IMDCT */
     int32_t overBuf[MAX_NCHAN][MAX_NSAMP / 2];     /* overlap-add buffer (by symmetry, only need 1/2 size) */
@@ -162,6 +179,17 @@ typedef struct IMDCTInfo {
     int32_t gb[MAX_NCHAN];
 } IMDCTInfo_t;
 
+typedef struct ConcealInfo {
+    int32_t       coef[MAX_NCHAN][MAX_NSAMP]; /* dequantized spectrum of the last good granule, before antialias */
+    int32_t       nonZeroBound[MAX_NCHAN];
+    int32_t       gb[MAX_NCHAN];
+    SideInfoSub_t sis[MAX_NCHAN];
+    int32_t       nChans; /* 0: no good granule yet */
+    int32_t       nGranSamps;
+    int32_t       frames; /* bad frames in a row */
+    uint32_t      seed;   /* sign randomization */
+} ConcealInfo_t;
+
 typedef struct BlockCount {
     int32_t nBlocksLong;
     int32_t nBlocksTotal;
@@ -1063,6 +1063,7 @@ int32_t OpusDecoder::parseOpusComment(uint8_t* inbuf, int32_t nBytes, uint32_t c
             OPUS_LOG_DEBUG("Skipping embedded picture (%d bytes)", val.size());
             return;
         }
+        if (key.starts_with_icase("replaygain_") || key.starts_with_icase("r128_")) { setReplayGainTag(key.c_get(), val.c_get()); }
         if (key.starts_with_icase("artist")) {
             if (!m_comment.stream_title.valid()) {
                 m_comment.stream_title.assign(val.c_get());
@@ -1240,7 +1241,11 @@ int32_t OpusDecoder::parseOpusHead(uint8_t* inbuf, int32_t nBytes) { // referenc
         return OPUS_ERR;
     }
 
-    (void)outputGain;
+    if (outputGain) { // RFC 7845: must be applied by the player
+        char gain[8];
+        snprintf(gain, sizeof(gain), "%i", (int16_t)outputGain);
+        setReplayGainTag("OPUS_OUTPUT_GAIN", gain);
+    }
 
     m_opusError = celtdec->celt_decoder_init(m_opusChannels);
     if (m_opusError < 0) {
@@ -0,0 +1,270 @@
+/*
+ * spectrum.cpp
+ *
+ * Created on: Oct 18,2025
+ *
+ */
+#include "spectrum.h"
+
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool Spectrum::begin(uint16_t fftSize, uint8_t bands, uint8_t maxCpuPercent, uint8_t core, uint16_t maxFreq) {
+    end();
+    if (fftSize != 256 && fftSize != 512 && fftSize != 1024) {
+        SPECTRUM_LOG_ERROR("fft size must be 256, 512 or 1024, is %i", fftSize);
+        return false;
+    }
+    m_fftSize = fftSize;
+    m_numBands = std::clamp<uint8_t>(bands, 1, SPECTRUM_MAX_BANDS);
+    m_maxCpu = std::clamp<uint8_t>(maxCpuPercent, 1, 100);
+    m_maxFreq = std::max<uint16_t>(maxFreq, 1000);
+
+    bool ok = true;
+    ok &= m_ring.alloc_array(2 * m_fftSize, "m_ring");
+    ok &= m_re.alloc_array(m_fftSize / 2, "m_re");
+    ok &= m_im.alloc_array(m_fftSize / 2, "m_im");
+    ok &= m_window.alloc_array(m_fftSize, "m_window");
+    ok &= m_cos.alloc_array(m_fftSize / 2, "m_cos");
+    ok &= m_sin.alloc_array(m_fftSize / 2, "m_sin");
+    ok &= m_bitrev.alloc_array(m_fftSize / 2, "m_bitrev");
+    if (!ok) {
+        SPECTRUM_LOG_ERROR("out of memory");
+        return false;
+    }
+    setupFFT();
+
+    m_ring.clear();
+    for (int i = 0; i < SPECTRUM_MAX_BANDS; i++) { m_bandsBuff[0][i] = m_bandsBuff[1][i] = -100; }
+    m_bandsSeq.store(0);
+    m_writePos.store(0);
+    m_rate.store(0);
+    m_lastNotify = 0;
+    m_sampleRate = 0;
+    m_bandsRate = 0;
+    m_cpuLoad = 0;
+    m_f_stop.store(false);
+
+    m_taskDone = xSemaphoreCreateBinary();
+    if (!m_taskDone) {
+        SPECTRUM_LOG_ERROR("out of memory");
+        return false;
+    }
+    // priority 1, below the audio task (2), runs only if there is time left
+    if (xTaskCreatePinnedToCore(&Spectrum::taskWrapper, "Spectrum", 3072, this, 1, &m_taskHandle, core) != pdPASS) {
+        SPECTRUM_LOG_ERROR("task could not be created");
+        m_taskHandle = nullptr;
+        vSemaphoreDelete(m_taskDone);
+        m_taskDone = nullptr;
+        return false;
+    }
+    return true;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Spectrum::end() {
+    if (m_taskHandle) { // the task may be inside analyze(), let it finish and leave before the buffers are freed
+        m_f_stop.store(true);
+        xTaskNotifyGive(m_taskHandle); // wakes it if it waits for samples
+        xSemaphoreTake(m_taskDone, portMAX_DELAY);
+        vSemaphoreDelete(m_taskDone);
+        m_taskDone = nullptr;
+        m_taskHandle = nullptr;
+    }
+    m_numBands = 0;
+    m_ring.reset();
+    m_re.reset();
+    m_im.reset();
+    m_window.reset();
+    m_cos.reset();
+    m_sin.reset();
+    m_bitrev.reset();
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Spectrum::setupFFT() {
+    // real FFT of N points = complex FFT of N/2 points + split, one twiddle table e^(-2πik/N), k < N/2 serves both
+    const uint16_t N = m_fftSize;
+    const uint16_t M = m_fftSize / 2;
+    uint8_t        bits = 0;
+    while ((1 << bits) < M) bits++;
+
+    for (int k = 0; k < M; k++) {
+        m_cos[k] = cosf(2 * PI * k / N);
+        m_sin[k] = sinf(2 * PI * k / N);
+        uint16_t r = 0;
+        for (int b = 0; b < bits; b++) {
+            if (k & (1 << b)) r |= 1 << (bits - 1 - b);
+        }
+        m_bitrev[k] = r;
+    }
+    for (int n = 0; n < N; n++) { m_window[n] = 0.5f - 0.5f * cosf(2 * PI * n / N); } // Hann
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Spectrum::setupBands(uint32_t sampleRate) {
+    // log spaced bands from ~30Hz (at least bin 1) up to maxFreq or nyquist
+    const uint16_t M = m_fftSize / 2;
+    const float    binWidth = (float)sampleRate / m_fftSize;
+    float          lo = std::max(1.0f, ceilf(30 / binWidth));
+    float          hi = std::min((float)M, floorf(std::min((float)m_maxFreq, sampleRate / 2.0f) / binWidth));
+    if (hi <= lo) hi = lo + 1;
+
+    m_bandEdge[0] = lo;
+    for (int b = 1; b <= m_numBands; b++) {
+        uint16_t e = lroundf(lo * powf(hi / lo, (float)b / m_numBands));
+        if (e <= m_bandEdge[b - 1]) e = m_bandEdge[b - 1] + 1; // at least one bin per band
+        m_bandEdge[b] = std::min(e, M);
+    }
+    m_bandsRate = sampleRate;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Spectrum::fft(float* re, float* im) {
+    // radix-2, decimation in time, in place
+    const uint16_t M = m_fftSize / 2;
+
+    for (int k = 0; k < M; k++) {
+        uint16_t r = m_bitrev[k];
+        if (r > k) {
+            std::swap(re[k], re[r]);
+            std::swap(im[k], im[r]);
+        }
+    }
+    for (int len = 2; len <= M; len <<= 1) {
+        const int half = len >> 1;
+        const int step = m_fftSize / len; // e^(-2πij/len) = e^(-2πi(j*step)/N)
+        for (int i = 0; i < M; i += len) {
+            for (int j = 0; j < half; j++) {
+                float c = m_cos[j * step];
+                float s = m_sin[j * step];
+                int   a = i + j;
+                int   b = a + half;
+                float tr = re[b] * c + im[b] * s;
+                float ti = im[b] * c - re[b] * s;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Spectrum::analyze() {
+    const uint16_t N = m_fftSize;
+    const uint16_t M = m_fftSize / 2;
+    const uint32_t mask = 2 * N - 1;
+
+    uint32_t rate = m_rate.load(std::memory_order_relaxed);
+    uint32_t w = m_writePos.load(std::memory_order_acquire);
+    if (!rate || w < N) return;
+    if (rate != m_bandsRate) setupBands(rate);
+
+    // the newest N samples, the audio task writes behind them, there are N samples time until they are overwritten
+    float* ring = m_ring.get();
+    float* re = m_re.get();
+    float* im = m_im.get();
+    for (int k = 0; k < M; k++) {
+        re[k] = ring[(w - N + 2 * k) & mask] * m_window[2 * k];
+        im[k] = ring[(w - N + 2 * k + 1) & mask] * m_window[2 * k + 1];
+    }
+    fft(re, im);
+
+    // split into the real spectrum, sum up the power per band
+    const float norm = 32.0f / (3.0f * N * N); // full scale sine (Hann, power of all its bins) is 0dB
+    uint32_t    seq = m_bandsSeq.load(std::memory_order_relaxed);
+    uint8_t     back = (seq + 1) & 1;                   // the older half, a slow reader may still copy it
+    std::atomic_thread_fence(std::memory_order_release); // getBands() sees m_bandsSeq changed before these writes
+    for (int b = 0; b < m_numBands; b++) {
+        float pwr = 0;
+        for (int k = m_bandEdge[b]; k < m_bandEdge[b + 1]; k++) {
+            int   kc = (M - k) & (M - 1);
+            float er = (re[k] + re[kc]) * 0.5f; // even part
+            float ei = (im[k] - im[kc]) * 0.5f;
+            float or_ = (im[k] + im[kc]) * 0.5f; // odd part
+            float oi = (re[kc] - re[k]) * 0.5f;
+            float xr = er + or_ * m_cos[k] + oi * m_sin[k];
+            float xi = ei + oi * m_cos[k] - or_ * m_sin[k];
+            pwr += xr * xr + xi * xi;
+        }
+        pwr *= norm;
+        m_bandsBuff[back][b] = (pwr > 1e-10f) ? 10 * log10f(pwr) : -100.0f;
+    }
+    m_bandsSeq.store(seq + 1, std::memory_order_release);
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Spectrum::feed(const audio_pcm_t* samples, int32_t frames, uint32_t sampleRate) {
+    // audio task: mono, decimate (box filter) and into the ring buffer, the FFT task is woken up every N/2 samples
+
+    if (!m_taskHandle || frames <= 0) return;
+
+    constexpr float scale = 1.0f / ((float)std::numeric_limits<audio_pcm_t>::max() + 1);
+    const uint32_t  mask = 2 * m_fftSize - 1;
+
+    if (sampleRate != m_sampleRate) {
+        m_sampleRate = sampleRate;
+        m_decimation = std::clamp<uint32_t>(sampleRate / (2 * m_maxFreq), 1, 8);
+        m_decCnt = 0;
+        m_decSum = 0;
+        m_rate.store(sampleRate / m_decimation, std::memory_order_relaxed);
+    }
+
+    float*   ring = m_ring.get();
+    uint32_t w = m_writePos.load(std::memory_order_relaxed);
+    float    f = scale * 0.5f / m_decimation;
+    for (int32_t i = 0; i < frames; i++) {
+        m_decSum += (float)samples[2 * i] + (float)samples[2 * i + 1];
+        if (++m_decCnt < m_decimation) continue;
+        ring[w & mask] = m_decSum * f;
+        w++;
+        m_decCnt = 0;
+        m_decSum = 0;
+    }
+    m_writePos.store(w, std::memory_order_release);
+
+    if (w - m_lastNotify >= m_fftSize / 2u) {
+        m_lastNotify = w;
+        xTaskNotifyGive(m_taskHandle);
+    }
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+uint8_t Spectrum::getBands(float* dB, uint8_t maxBands) {
+    if (!dB || !m_taskHandle) return 0;
+    uint8_t n = std::min(maxBands, m_numBands);
+    uint32_t seq1, seq2;
+    uint8_t  tries = 0;
+    do { // seqlock, a copy overlapping with the next analyze() is repeated
+        if (++tries > 3) vTaskDelay(1);
+        seq1 = m_bandsSeq.load(std::memory_order_acquire);
+        memcpy(dB, m_bandsBuff[seq1 & 1], n * sizeof(float));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        seq2 = m_bandsSeq.load(std::memory_order_relaxed);
+    } while (seq1 != seq2);
+    return n;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Spectrum::taskWrapper(void* param) {
+    Spectrum* runner = static_cast<Spectrum*>(param);
+    runner->task();
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+void Spectrum::task() {
+    int64_t windowStart = esp_timer_get_time();
+    int64_t busy = 0;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // pending notifications are dropped, always the newest samples
+        if (m_f_stop.load()) break;
+        int64_t t0 = esp_timer_get_time();
+        analyze();
+        int64_t t1 = esp_timer_get_time();
+        busy += t1 - t0;
+
+        if (t1 - windowStart >= 1000000) { // load of the last second
+            m_cpuLoad = busy * 100.0f / (t1 - windowStart);
+            busy = 0;
+            windowStart = t1;
+        }
+
+        // cap: after a run of t µs pause t * (100 - max) / max µs
+        uint32_t pause_ms = (t1 - t0) * (100 - m_maxCpu) / m_maxCpu / 1000;
+        if (pause_ms) vTaskDelay(pdMS_TO_TICKS(pause_ms));
+    }
+    xSemaphoreGive(m_taskDone); // nothing of this object is touched after this
+    vTaskDelete(nullptr);
+}
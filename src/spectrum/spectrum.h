@@ -0,0 +1,71 @@
+/*
+ * spectrum.h
+ *
+ * Created on: Oct 18,2025
+ *
+ * spectrum analyzer for the output stream, bar graph displays
+ * the audio task only decimates into a ring buffer (feed), the FFT runs in a separate low priority task
+ * 256, 512 or 1024 point real FFT (Hann window), log spaced bands in dBFS, published in a double buffer with a sequence counter
+ *
+ */
+#pragma once
+#pragma GCC optimize("Ofast")
+
+#include "../Audio.h"
+
+constexpr uint8_t SPECTRUM_MAX_BANDS = 64;
+
+class Spectrum {
+
+public:
+    Spectrum() {}
+    ~Spectrum() { end(); }
+    bool    begin(uint16_t fftSize, uint8_t bands, uint8_t maxCpuPercent, uint8_t core, uint16_t maxFreq = 16000);
+    void    end();
+    void    feed(const audio_pcm_t* samples, int32_t frames, uint32_t sampleRate); // audio task, interleaved L/R
+    uint8_t getBands(float* dB, uint8_t maxBands);                                  // any task, returns the number of bands
+    float   getCpuLoad() { return m_cpuLoad; }                                      // percent of one core
+
+private:
+    void        setupFFT();
+    void        setupBands(uint32_t sampleRate);
+    void        fft(float* re, float* im);
+    void        analyze();
+    static void taskWrapper(void* param);
+    void        task();
+
+    ps_ptr<float>    m_ring;      // decimated mono samples, 2 * fftSize
+    ps_ptr<float>    m_re;        // fftSize / 2 complex points
+    ps_ptr<float>    m_im;        //
+    ps_ptr<float>    m_window;    // Hann, fftSize
+    ps_ptr<float>    m_cos;       // twiddles, fftSize / 2 (the last half for the real FFT split)
+    ps_ptr<float>    m_sin;       //
+    ps_ptr<uint16_t> m_bitrev;    // fftSize / 2
+    uint16_t         m_bandEdge[SPECTRUM_MAX_BANDS + 1]; // first bin of each band, last entry is the end
+    float            m_bandsBuff[2][SPECTRUM_MAX_BANDS];  // double buffer
+
+    std::atomic<uint32_t> m_bandsSeq{0};    // number of published band sets, m_bandsSeq & 1 is the readable half of m_bandsBuff
+    std::atomic<uint32_t> m_writePos{0};    // total number of samples written into m_ring
+    std::atomic<uint32_t> m_rate{0};        // samplerate after decimation, set by feed()
+    TaskHandle_t          m_taskHandle = nullptr;
+    SemaphoreHandle_t     m_taskDone = nullptr; // given by the task when it leaves its loop, end() waits for it
+    std::atomic<bool>     m_f_stop{false};      // end(): the task exits after the current analyze()
+    uint32_t              m_lastNotify = 0; // m_writePos of the last notification
+    uint32_t              m_sampleRate = 0; // input samplerate
+    uint32_t              m_bandsRate = 0;  // samplerate the bands are calculated for
+    uint16_t              m_fftSize = 0;
+    uint16_t              m_maxFreq = 16000;
+    uint8_t               m_numBands = 0;
+    uint8_t               m_maxCpu = 10;    // percent
+    uint8_t               m_decimation = 1;
+    uint8_t               m_decCnt = 0;
+    float                 m_decSum = 0;
+    float                 m_cpuLoad = 0;
+
+    // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+    // Macro for comfortable calls
+    #define SPECTRUM_LOG_ERROR(fmt, ...)   Audio::AUDIO_LOG_IMPL(1, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+    #define SPECTRUM_LOG_WARN(fmt, ...)    Audio::AUDIO_LOG_IMPL(2, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+    #define SPECTRUM_LOG_INFO(fmt, ...)    Audio::AUDIO_LOG_IMPL(3, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+    #define SPECTRUM_LOG_DEBUG(fmt, ...)   Audio::AUDIO_LOG_IMPL(4, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+};
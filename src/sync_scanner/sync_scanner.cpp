@@ -0,0 +1,65 @@
+/*
+ * sync_scanner.cpp
+ *
+ * Created on: Oct 18,2025
+ *
+ */
+#include "sync_scanner.h"
+
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int32_t SyncScanner::candidate(const uint8_t* buf, int32_t nBytes, uint8_t syncMask) {
+    const uint8_t* p = buf;
+    const uint8_t* end = buf + nBytes - 1; // the second byte must be in the buffer
+    while (p < end) {
+        p = (const uint8_t*)memchr(p, 0xFF, end - p);
+        if (!p) return -1;
+        if ((p[1] & syncMask) == syncMask) return p - buf;
+        p++;
+    }
+    return -1;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int32_t SyncScanner::find(const uint8_t* buf, int32_t nBytes) {
+    int32_t pos = scan(buf, nBytes);
+    if (pos < 0 && m_locked) { // the stream has changed (other samplerate, channels), lock again
+        m_locked = false;
+        pos = scan(buf, nBytes);
+    }
+    return pos;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int32_t SyncScanner::scan(const uint8_t* buf, int32_t nBytes) {
+    int32_t pos = 0;
+    while (true) {
+        int32_t c = candidate(buf + pos, nBytes - pos, m_syncMask);
+        if (c < 0) return -1;
+        pos += c;
+        if (nBytes - pos < m_hdrSize) return -1;
+
+        uint32_t fixed = 0;
+        int32_t  len = m_parse(buf + pos, &fixed);
+        if (len > 0 && (!m_locked || fixed == m_fixed)) {
+            // follow the chain of frames, the buffer may end before lockFrames are seen
+            uint8_t n = 1;
+            int32_t next = pos + len;
+            bool    broken = false;
+            while (n < m_lockFrames && next + m_hdrSize <= nBytes) {
+                uint32_t f = 0;
+                int32_t  l = m_parse(buf + next, &f);
+                if (l <= 0 || f != fixed) {
+                    broken = true;
+                    break;
+                }
+                n++;
+                next += l;
+            }
+            // without a lock at least one following header is needed, a locked stream knows its parameters
+            if (!broken && (n >= 2 || m_locked)) {
+                m_fixed = fixed;
+                m_locked = true;
+                return pos;
+            }
+        }
+        pos++; // false sync (ID3 tag, cover art, junk), next candidate
+    }
+}
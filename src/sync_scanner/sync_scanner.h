@@ -0,0 +1,38 @@
+/*
+ * sync_scanner.h
+ *
+ * Created on: Oct 18,2025
+ *
+ * frame sync for MP3 and AAC (ADTS) streams
+ * candidates 0xFF + mask are found with memchr (word at a time in newlib), a candidate is only accepted if the
+ * following frames (computed frame lengths) have valid headers with the same fixed bits (version, layer,
+ * samplerate, channels ...), once locked the fixed bits of the stream are kept until reset()
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+class SyncScanner {
+
+public:
+    typedef int32_t (*parse_t)(const uint8_t* hdr, uint32_t* fixed); // frame length or -1, fixed: header bits that don't change within a stream
+
+    SyncScanner(parse_t parse, uint8_t hdrSize, uint8_t syncMask, uint8_t lockFrames = 3)
+        : m_parse(parse), m_hdrSize(hdrSize), m_syncMask(syncMask), m_lockFrames(lockFrames) {}
+    int32_t        find(const uint8_t* buf, int32_t nBytes); // offset of the first of lockFrames consecutive frames, -1: not found
+    void           reset() { m_locked = false; }             // new stream
+    bool           isLocked() { return m_locked; }
+    static int32_t candidate(const uint8_t* buf, int32_t nBytes, uint8_t syncMask); // next 0xFF followed by a byte with all syncMask bits set
+
+private:
+    int32_t scan(const uint8_t* buf, int32_t nBytes);
+
+    parse_t  m_parse;
+    uint8_t  m_hdrSize;
+    uint8_t  m_syncMask;   // second byte: 0xE0 MP3, 0xF0 ADTS
+    uint8_t  m_lockFrames; // frames that must follow each other
+    bool     m_locked = false;
+    uint32_t m_fixed = 0;  // of the locked stream
+};
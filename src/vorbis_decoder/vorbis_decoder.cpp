@@ -27,6 +27,7 @@
 bool VorbisDecoder::init() {
     setDefaults();
     m_ogg_items.lastSegmentTable.alloc(4096, "m_lastSegmentTable");
+    m_downmix = downmix();
     m_f_isValid = true;
     return true;
 }
@@ -40,6 +41,7 @@ void VorbisDecoder::reset() {
     if (m_map_param.valid()) m_map_param.reset();
     if (m_mode_param.valid()) m_mode_param.reset();
     if (m_dsp_state.valid()) m_dsp_state.reset();
+    m_dmxBuff.reset();
     m_ogg_items.segment_table.clear();
     m_f_isValid = false;
 }
@@ -277,7 +279,7 @@ int32_t VorbisDecoder::vorbisDecodePage4(uint8_t* inbuf, int32_t* bytesLeft, uin
 
             bitReader_setData(inbuf, segmentLength);
             ret = vorbis_dsp_synthesis(inbuf, segmentLength, outbuf);
-            m_vorbisValidSamples += vorbis_dsp_pcmout(outbuf + (m_vorbisValidSamples * m_vorbisChannels), outBuffSize);
+            m_vorbisValidSamples += vorbis_dsp_pcmout(outbuf + (m_vorbisValidSamples * getChannels()), outBuffSize);
             m_ogg_items.lastSegmentTableLen = false;
             goto exit;
         } else {
@@ -310,7 +312,7 @@ exit:
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 uint8_t VorbisDecoder::getChannels() {
-    return m_vorbisChannels;
+    return std::min<uint8_t>(m_vorbisChannels, 2); // more are mixed down
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 uint32_t VorbisDecoder::getSampleRate() {
@@ -420,11 +422,25 @@ int32_t VorbisDecoder::parseVorbisFirstPacket(uint8_t* inbuf, int16_t nBytes) {
         return -1;
     }
 
-    if (channels < 1 || channels > 2) {
+    if (channels < 1 || channels > Downmix::DMX_MAX_CHANNELS) {
         VORBIS_LOG_ERROR("Vorbis, nr of channels is not valid ch=%i", channels);
         return -1;
     }
     m_vorbisChannels = channels;
+    if (channels > 2) { // Vorbis channel order, the rear pair of 4.0 ... 5.1 are the surrounds
+        static const uint8_t layout[6][Downmix::DMX_MAX_CHANNELS] = {
+            {Downmix::DMX_L, Downmix::DMX_C, Downmix::DMX_R},
+            {Downmix::DMX_L, Downmix::DMX_R, Downmix::DMX_LS, Downmix::DMX_RS},
+            {Downmix::DMX_L, Downmix::DMX_C, Downmix::DMX_R, Downmix::DMX_LS, Downmix::DMX_RS},
+            {Downmix::DMX_L, Downmix::DMX_C, Downmix::DMX_R, Downmix::DMX_LS, Downmix::DMX_RS, Downmix::DMX_LFE},
+            {Downmix::DMX_L, Downmix::DMX_C, Downmix::DMX_R, Downmix::DMX_LS, Downmix::DMX_RS, Downmix::DMX_CB, Downmix::DMX_LFE},
+            {Downmix::DMX_L, Downmix::DMX_C, Downmix::DMX_R, Downmix::DMX_LS, Downmix::DMX_RS, Downmix::DMX_LB, Downmix::DMX_RB, Downmix::DMX_LFE}};
+        m_downmix.setLayout(channels, layout[channels - 3]);
+        if (!m_dmxBuff.alloc_array(channels * (m_blocksizes[1] >> 1), "m_dmxBuff")) {
+            VORBIS_LOG_ERROR("Vorbis, not enough memory for %i channels", channels);
+            return -1;
+        }
+    }
 
     if (sampleRate < 4096 || sampleRate > 64000) {
         VORBIS_LOG_ERROR("Vorbis, sampleRate is not valid sr=%i", sampleRate);
@@ -461,6 +477,7 @@ int32_t VorbisDecoder::parseVorbisComment(uint8_t* inbuf, int16_t nBytes, uint32
             VORBIS_LOG_DEBUG("Skipping embedded picture (%d bytes)", val.size());
             return;
         }
+        if (key.starts_with_icase("replaygain_") || key.starts_with_icase("r128_")) { setReplayGainTag(key.c_get(), val.c_get()); }
         if (key.starts_with_icase("artist")) {
 
             if (!m_comment.stream_title.valid()) {
@@ -3104,6 +3121,19 @@ int32_t VorbisDecoder::vorbis_dsp_pcmout(int16_t* outBuff, int32_t outBuffSize)
                 n = outBuffSize;
                 VORBIS_LOG_ERROR("outBufferSize too small, must be min %i (int16_t) words", n);
             }
+            if (m_vorbisChannels > 2) { // every channel into its own block, the matrix writes interleaved stereo
+                const int32_t   len = m_blocksizes[1] >> 1;
+                const int16_t* in[Downmix::DMX_MAX_CHANNELS];
+                n = std::min(n, len);
+                for (i = 0; i < m_vorbisChannels; i++) {
+                    int16_t* chBuff = m_dmxBuff.get() + i * len;
+                    mdct_unroll_lap(m_blocksizes[0], m_blocksizes[1], m_dsp_state->lW, m_dsp_state->W, m_dsp_state->work[i].get(), m_dsp_state->mdctright[i].get(), _vorbis_window(m_blocksizes[0] >> 1),
+                                    _vorbis_window(m_blocksizes[1] >> 1), chBuff, 1, m_dsp_state->out_begin, m_dsp_state->out_begin + n);
+                    in[i] = chBuff;
+                }
+                m_downmix.process(in, n, outBuff, outBuff + 1, 2);
+                return (n);
+            }
             for (i = 0; i < m_vorbisChannels; i++) {
                 mdct_unroll_lap(m_blocksizes[0], m_blocksizes[1], m_dsp_state->lW, m_dsp_state->W, m_dsp_state->work[i].get(), m_dsp_state->mdctright[i].get(), _vorbis_window(m_blocksizes[0] >> 1),
                                 _vorbis_window(m_blocksizes[1] >> 1), outBuff + i, m_vorbisChannels, m_dsp_state->out_begin, m_dsp_state->out_begin + n);
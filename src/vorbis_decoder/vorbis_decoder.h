@@ -276,7 +276,9 @@ class VorbisDecoder : public Decoder {
     uint16_t m_vorbisCommentHeaderLength = 0;
     uint8_t  m_pageNr = 0;
     uint16_t m_oggHeaderSize = 0;
-    uint8_t  m_vorbisChannels = 0;
+    uint8_t  m_vorbisChannels = 0;       // decoded, more than 2 are mixed down in vorbis_dsp_pcmout()
+    Downmix  m_downmix;                  // per stream
+    ps_ptr<int16_t> m_dmxBuff;           // channels * blocksize / 2, deinterleaved
     uint16_t m_vorbisSamplerate = 0;
     uint32_t m_vorbisBitRate = 0;
     uint32_t m_vorbis_segment_length = 0;
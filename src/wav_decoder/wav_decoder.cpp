@@ -60,6 +60,13 @@ const char* WavDecoder::whoIsIt() {
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 int32_t WavDecoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf) {
 
+    if (m_bps == 24) { // keep the upper 16 bits, consume whole frames only
+        int32_t samples = (*bytesLeft / (3 * getChannels())) * getChannels();
+        for (int i = 0; i < samples; i++) { outbuf[i] = (int16_t)(inbuf[i * 3 + 1] | (inbuf[i * 3 + 2] << 8)); }
+        m_validSamples = samples / getChannels();
+        *bytesLeft -= samples * 3;
+        return 0;
+    }
     if (m_bps == 16) {
         memmove(outbuf, inbuf, *bytesLeft); // copy len data in outbuff and set validsamples and bytesdecoded=len
         m_validSamples = *bytesLeft / (2 * getChannels());
@@ -77,6 +84,27 @@ int32_t WavDecoder::decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf)
     return 0;
 }
 // —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+bool WavDecoder::hasPCM32Output() {
+    return true;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
+int32_t WavDecoder::decode32(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf) { // left justified 32 bit samples
+
+    const uint8_t bytesPerSample = m_bps / 8;
+    int32_t       samples = (*bytesLeft / (bytesPerSample * getChannels())) * getChannels(); // whole frames only
+
+    if (m_bps == 24) {
+        for (int i = 0; i < samples; i++) { outbuf[i] = (inbuf[i * 3] << 8) | (inbuf[i * 3 + 1] << 16) | (inbuf[i * 3 + 2] << 24); }
+    } else if (m_bps == 16) {
+        for (int i = 0; i < samples; i++) { outbuf[i] = (inbuf[i * 2] << 16) | (inbuf[i * 2 + 1] << 24); }
+    } else {
+        for (int i = 0; i < samples; i++) { outbuf[i] = (int32_t)(inbuf[i] - 128) << 24; } // 8 bit wav is unsigned
+    }
+    m_validSamples = samples / getChannels();
+    *bytesLeft -= samples * bytesPerSample;
+    return 0;
+}
+// —————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————————
 void WavDecoder::setRawBlockParams(uint8_t channels, uint32_t sampleRate, uint8_t BPS, uint32_t tsis, uint32_t AuDaLength) {
     m_channels = channels;
     m_sampleRate = sampleRate;
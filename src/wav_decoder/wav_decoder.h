@@ -21,6 +21,8 @@ public:
     const char*      getStreamTitle() override;
     const char*      whoIsIt() override;
     int32_t          decode(uint8_t* inbuf, int32_t* bytesLeft, int16_t* outbuf) override;
+    bool             hasPCM32Output() override;
+    int32_t          decode32(uint8_t* inbuf, int32_t* bytesLeft, int32_t* outbuf) override;
     void             setRawBlockParams(uint8_t channels, uint32_t sampleRate, uint8_t BPS, uint32_t tsis, uint32_t AuDaLength) override;
     std::vector<uint32_t> getMetadataBlockPicture() override;
     const char*      arg1() override;